@@ -72,6 +72,7 @@ typedef struct {
 	NABoxedClass;
 
 GType         na_boxed_get_type       ( void );
+void          na_boxed_set_interning  ( gboolean interning );
 void          na_boxed_set_type       ( NABoxed *boxed, guint type );
 
 gboolean      na_boxed_are_equal      ( const NABoxed *a, const NABoxed *b );
@@ -382,6 +382,43 @@ typedef struct {
 }
 	NAIExporterBufferParmsv2;
 
+/**
+ * NAIExporterItemsParmsv2:
+ * @version:  [in] version of this structure;
+ *                 equals to 2;
+ *                 since structure version 2.
+ * @content:  [in] version of the content of this structure;
+ *                 equals to 1;
+ *                 since structure version 2.
+ * @exported: [in] a #GList of the exported NAObjectItem-derived objects;
+ *                 since structure version 2.
+ * @folder:   [in] URI of the target folder;
+ *                 since structure version 2.
+ * @format:   [in] export format string identifier;
+ *                 since structure version 2.
+ * @basename: [out] basename of the exported file;
+ *                 since structure version 2.
+ * @messages: [in/out] a #GSList list of localized strings;
+ *                 the provider may append messages to this list,
+ *                 but shouldn't reinitialize it;
+ *                 since structure version 2.
+ *
+ * The structure that the plugin receives as a parameter of
+ * #NAIExporterInterface.items_to_file () interface method.
+ *
+ * Since: 3.2
+ */
+typedef struct {
+	guint         version;
+	guint         content;
+	GList        *exported;
+	gchar        *folder;
+	gchar        *format;
+	gchar        *basename;
+	GSList       *messages;
+}
+	NAIExporterItemsParmsv2;
+
 /**
  * NAIExporterInterface:
  * @get_version:  [should] returns the version of this interface the plugin implements.
@@ -390,6 +427,7 @@ typedef struct {
  * @free_formats: [should] free a list of formats
  * @to_file:      [should] exports an item to a file.
  * @to_buffer:    [should] exports an item to a buffer.
+ * @items_to_file: [may] exports several items to a single file.
  *
  * This defines the interface that a #NAIExporter should implement.
  */
@@ -511,6 +549,24 @@ typedef struct {
 	 * Since: 2.30
 	 */
 	guint   ( *to_buffer )  ( const NAIExporter *instance, NAIExporterBufferParmsv2 *parms );
+
+	/**
+	 * items_to_file:
+	 * @instance: this NAIExporter instance.
+	 * @parms: a NAIExporterItemsParmsv2 structure.
+	 *
+	 * Exports all the specified 'exported' items to a single file in
+	 * the target 'folder' in the required 'format'. The file is
+	 * expected to be importable back in one pass.
+	 *
+	 * If this method is not implemented by the plugin, Nautilus-Actions
+	 * exports each item to its own file with to_file() method.
+	 *
+	 * Return value: the NAIExporterExportStatus status of the operation.
+	 *
+	 * Since: 3.2
+	 */
+	guint   ( *items_to_file )( const NAIExporter *instance, NAIExporterItemsParmsv2 *parms );
 }
 	NAIExporterInterface;
 
@@ -114,6 +114,8 @@ typedef struct _NAIImporterInterfacePrivate    NAIImporterInterfacePrivate;
  * @get_version:     [should] returns the version of this interface that the
  *                            plugin implements.
  * @import_from_uri: [should] imports an item.
+ * @probe:           [may] says whether the provider is willing to import
+ *                         a content.
  *
  * This defines the interface that a #NAIImporter should implement.
  */
@@ -162,6 +164,30 @@ typedef struct {
 	 * Since: 2.30
 	 */
 	guint ( *import_from_uri )( const NAIImporter *instance, void *parms );
+
+	/**
+	 * probe:
+	 * @instance: the NAIImporter provider.
+	 * @uri: the URI of the file to be imported.
+	 * @data: the first bytes of the file.
+	 * @length: the length of @data.
+	 *
+	 * Nautilus-Actions calls this method before trying to import an URI,
+	 * so that the provider may cheaply refuse a content it will not be
+	 * able to import, without having to fully parse it.
+	 *
+	 * @data is at most the first #NA_IIMPORTER_PROBE_SIZE bytes of the
+	 * file, and may so be truncated anywhere.
+	 *
+	 * If this method is not implemented by the plugin, Nautilus-Actions
+	 * considers that the plugin is willing to try to import any content.
+	 *
+	 * Return value: %FALSE if the provider will not import this content,
+	 * %TRUE if it wants to try.
+	 *
+	 * Since: 3.2
+	 */
+	gboolean ( *probe )       ( const NAIImporter *instance, const gchar *uri, const gchar *data, gsize length );
 }
 	NAIImporterInterface;
 
@@ -376,6 +402,16 @@ typedef enum {
 }
 	NAIImporterImportStatus;
 
+/**
+ * NA_IIMPORTER_PROBE_SIZE:
+ *
+ * The maximal count of bytes provided to the #NAIImporterInterface.probe()
+ * method.
+ *
+ * Since: 3.2
+ */
+#define NA_IIMPORTER_PROBE_SIZE		4096
+
 /**
  * NAIImporterImportFromUriParmsv2:
  * @version:       [in] the version of the structure, equals to 2;
@@ -390,6 +426,17 @@ typedef enum {
  *                      the provider may append messages to this list, but
  *                      shouldn't reinitialize it;
  *                      since structure version 1.
+ * @others:        [out] a #GList of the #NAObjectItem -derived objects
+ *                      imported from the same URI after @imported, or %NULL;
+ *                      a provider which is only able to import one item
+ *                      per URI just leaves it unset;
+ *                      since structure version 2.
+ * @data:          [in] the content of the file, or %NULL;
+ *                      when set, the provider should import from this
+ *                      buffer rather than reading again the @uri;
+ *                      since structure version 2.
+ * @length:        [in] the length of @data;
+ *                      since structure version 2.
  *
  * This structure allows all used parameters when importing from an URI
  * to be passed and received through a single structure.
@@ -402,12 +449,16 @@ typedef struct {
 	const gchar  *uri;
 	NAObjectItem *imported;
 	GSList       *messages;
+	GList        *others;
+	const gchar  *data;
+	gsize         length;
 }
 	NAIImporterImportFromUriParmsv2;
 
-GType na_iimporter_get_type       ( void );
+GType    na_iimporter_get_type       ( void );
 
-guint na_iimporter_import_from_uri( const NAIImporter *importer, NAIImporterImportFromUriParmsv2 *parms );
+guint    na_iimporter_import_from_uri( const NAIImporter *importer, NAIImporterImportFromUriParmsv2 *parms );
+gboolean na_iimporter_probe          ( const NAIImporter *importer, const gchar *uri, const gchar *data, gsize length );
 
 G_END_DECLS
 
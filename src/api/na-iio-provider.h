@@ -217,6 +217,10 @@ typedef struct _NAIIOProviderInterfacePrivate     NAIIOProviderInterfacePrivate;
  * @write_item:          [should] writes an item.
  * @delete_item:         [should] deletes an item.
  * @duplicate_data:      [may]    let the I/O provider duplicates its specific data.
+ * @read_item:           [may]    reads a single item.
+ * @is_item_writable:    [may]    evaluates again the writability of an item.
+ * @begin_batch:         [may]    opens a batch of writes.
+ * @commit_batch:        [may]    commits a batch of writes.
  *
  * This defines the methods that a #NAIIOProvider may, should, or must
  * implement.
@@ -424,6 +428,88 @@ typedef struct {
 	 * Since: 2.30
 	 */
 	guint    ( *duplicate_data )     ( const NAIIOProvider *instance, NAObjectItem *dest, const NAObjectItem *source, GSList **messages );
+
+	/**
+	 * read_item:
+	 * @instance: the NAIIOProvider provider.
+	 * @id: the identifier of the item to be read.
+	 * @messages: a pointer to a GSList list of strings; the provider
+	 *  may append messages to this list, but shouldn't reinitialize it.
+	 *
+	 * Reads again a single item from the specified I/O provider.
+	 *
+	 * Nautilus-Actions calls this method after the I/O provider has
+	 * signaled, through na_iio_provider_items_delta(), that some of its
+	 * items have been added, modified or removed. If the I/O provider
+	 * does not implement this method, the whole items list is read again.
+	 *
+	 * Return value: if implemented, this method must return a newly
+	 * allocated NAObjectItem-derived object (menu or action), or %NULL
+	 * if the item does not exist anymore in the I/O provider.
+	 *
+	 * Defaults to NULL.
+	 *
+	 * Since: 3.2
+	 */
+	NAObjectItem * ( *read_item )    ( const NAIIOProvider *instance, const gchar *id, GSList **messages );
+
+	/**
+	 * is_item_writable:
+	 * @instance: the NAIIOProvider provider.
+	 * @item: a NAObjectItem-derived object (menu or action) which has
+	 *  been read from this I/O provider.
+	 *
+	 * The writability status of an item is first determined when the
+	 * item is read. Nautilus-Actions calls this method when it needs
+	 * to know the current status, e.g. before trying to write the item.
+	 * The I/O provider is expected to answer quickly, typically from
+	 * a cache it maintains itself.
+	 *
+	 * If the I/O provider does not implement this method, the status
+	 * determined at load time is used.
+	 *
+	 * Return value: %TRUE if the @item is writable, %FALSE else.
+	 *
+	 * Defaults to NULL.
+	 *
+	 * Since: 3.2
+	 */
+	gboolean ( *is_item_writable )   ( const NAIIOProvider *instance, const NAObjectItem *item );
+
+	/**
+	 * begin_batch:
+	 * @instance: the NAIIOProvider provider.
+	 *
+	 * Nautilus-Actions calls this method before writing or deleting a
+	 * set of items at once, e.g. when the user saves the whole tree
+	 * from &nact;.
+	 *
+	 * Until commit_batch() be called, the I/O provider may defer the
+	 * actual writes to its storage subsystem, and should not report
+	 * its own modifications as external changes.
+	 *
+	 * Calls may be nested.
+	 *
+	 * Since: 3.2
+	 */
+	void     ( *begin_batch )        ( const NAIIOProvider *instance );
+
+	/**
+	 * commit_batch:
+	 * @instance: the NAIIOProvider provider.
+	 * @messages: a pointer to a GSList list of strings; the provider
+	 *  may append messages to this list, but shouldn't reinitialize it.
+	 *
+	 * Closes a batch previously opened with begin_batch(). When the
+	 * outermost batch is closed, the I/O provider must have flushed all
+	 * deferred writes to its storage subsystem.
+	 *
+	 * Return value: NA_IIO_PROVIDER_CODE_OK if all the deferred writes
+	 * were successful, or another code depending of the detected error.
+	 *
+	 * Since: 3.2
+	 */
+	guint    ( *commit_batch )       ( const NAIIOProvider *instance, GSList **messages );
 }
 	NAIIOProviderInterface;
 
@@ -498,6 +584,7 @@ GType na_iio_provider_get_type    ( void );
 /* -- to be called by the I/O provider when an item has changed
  */
 void  na_iio_provider_item_changed( const NAIIOProvider *instance );
+void  na_iio_provider_items_delta ( const NAIIOProvider *instance, GSList *ids );
 
 G_END_DECLS
 
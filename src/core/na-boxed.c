@@ -67,12 +67,18 @@ typedef struct {
 }
 	BoxedDef;
 
+/* ListItemFn:
+ * The callback which receives each item found by string_list_parse().
+ */
+typedef void ( *ListItemFn )( NABoxed *boxed, const gchar *item, gsize len );
+
 /* private instance data
  */
 struct _NABoxedPrivate {
 	gboolean        dispose_has_run;
 	const BoxedDef *def;
 	gboolean        is_set;
+	gboolean        interned;
 	union {
 		gboolean    boolean;
 		void       *pointer;
@@ -83,9 +89,23 @@ struct _NABoxedPrivate {
 	} u;
 };
 
+/* Atom:
+ * An interned string, shared between all NABoxed which hold the same
+ * value while interning is enabled.
+ */
+typedef struct {
+	gchar *string;
+	guint  refcount;
+}
+	Atom;
+
 #define LIST_SEPARATOR						";"
 
 static GObjectClass *st_parent_class   = NULL;
+static gboolean      st_interning      = FALSE;
+static GHashTable   *st_atoms          = NULL;
+
+G_LOCK_DEFINE_STATIC( st_atoms );
 
 static GType           register_type( void );
 static void            class_init( NABoxedClass *klass );
@@ -95,7 +115,13 @@ static void            instance_finalize( GObject *object );
 
 static NABoxed        *boxed_new( const BoxedDef *def );
 static const BoxedDef *get_boxed_def( guint type );
-static gchar         **string_to_array( const gchar *string );
+static void            string_list_parse( const gchar *string, NABoxed *boxed, ListItemFn fn );
+static gchar          *atom_ref( const gchar *string );
+static void            atom_unref( gchar *string );
+static void            atom_free( Atom *atom );
+static gchar          *boxed_strdup( const NABoxed *boxed, const gchar *string );
+static gchar          *boxed_strndup( const NABoxed *boxed, const gchar *string, gsize len );
+static void            boxed_strfree( const NABoxed *boxed, gchar *string );
 
 static gboolean        bool_are_equal( const NABoxed *a, const NABoxed *b );
 static void            bool_copy( NABoxed *dest, const NABoxed *src );
@@ -136,6 +162,7 @@ static gboolean        string_list_are_equal( const NABoxed *a, const NABoxed *b
 static void            string_list_copy( NABoxed *dest, const NABoxed *src );
 static void            string_list_free( NABoxed *boxed );
 static void            string_list_from_string( NABoxed *boxed, const gchar *string );
+static void            string_list_from_string_item( NABoxed *boxed, const gchar *item, gsize len );
 static void            string_list_from_value( NABoxed *boxed, const GValue *value );
 static void            string_list_from_void( NABoxed *boxed, const void *value );
 static gconstpointer   string_list_to_pointer( const NABoxed *boxed );
@@ -162,6 +189,7 @@ static gboolean        uint_list_are_equal( const NABoxed *a, const NABoxed *b )
 static void            uint_list_copy( NABoxed *dest, const NABoxed *src );
 static void            uint_list_free( NABoxed *boxed );
 static void            uint_list_from_string( NABoxed *boxed, const gchar *string );
+static void            uint_list_from_string_item( NABoxed *boxed, const gchar *item, gsize len );
 static void            uint_list_from_value( NABoxed *boxed, const GValue *value );
 static void            uint_list_from_void( NABoxed *boxed, const void *value );
 static gconstpointer   uint_list_to_pointer( const NABoxed *boxed );
@@ -360,11 +388,16 @@ instance_init( GTypeInstance *instance, gpointer klass )
 
 	self = NA_BOXED( instance );
 
-	self->private = g_new0( NABoxedPrivate, 1 );
+	/* a pivot load creates many boxed values, so the private data comes
+	 * from GSlice; it is still released with each NABoxed, and not with
+	 * the whole pivot generation
+	 */
+	self->private = g_slice_new0( NABoxedPrivate );
 
 	self->private->dispose_has_run = FALSE;
 	self->private->def = NULL;
 	self->private->is_set = FALSE;
+	self->private->interned = st_interning;
 }
 
 static void
@@ -405,7 +438,7 @@ instance_finalize( GObject *object )
 		}
 	}
 
-	g_free( self->private );
+	g_slice_free( NABoxedPrivate, self->private );
 
 	/* chain call to parent class */
 	if( G_OBJECT_CLASS( st_parent_class )->finalize ){
@@ -424,16 +457,17 @@ boxed_new( const BoxedDef *def )
 	return( boxed );
 }
 
+/*
+ * st_boxed_def[] is ordered by NADataType, so that the definition of a
+ * type is directly addressed by its index
+ */
 static const BoxedDef *
 get_boxed_def( guint type )
 {
 	static const gchar *thisfn = "na_boxed_get_boxed_def";
-	BoxedDef *def;
 
-	for( def = st_boxed_def ; def->type ; ++def ){
-		if( def->type == type ){
-			return(( const BoxedDef * ) def );
-		}
+	if( type > 0 && type < NA_DATA_TYPE_N && st_boxed_def[type-1].type == type ){
+		return(( const BoxedDef * ) st_boxed_def+type-1 );
 	}
 
 	g_warning( "%s: unmanaged data type: %d", thisfn, type );
@@ -441,44 +475,196 @@ get_boxed_def( guint type )
 }
 
 /*
- * converts a string to an array of strings
+ * parses a string list, calling @fn for each found item
  * accepts both:
  * - a semi-comma-separated list of strings (the last separator, if any, is not counted)
  * - a comma-separated list of strings between square brackets (à la GConf)
  *
+ * items are provided as (pointer, length) slices of the input @string,
+ * so that no intermediate array nor string has to be allocated
  */
-static gchar **
-string_to_array( const gchar *string )
+static void
+string_list_parse( const gchar *string, NABoxed *boxed, ListItemFn fn )
 {
-	gchar *sdup;
-	gchar **array;
+	const gchar *begin, *end, *it;
+	gchar sep;
 
-	array = NULL;
+	if( !string || !*string ){
+		return;
+	}
 
-	if( string && strlen( string )){
-		sdup = g_strstrip( g_strdup( string ));
+	begin = string;
+	end = string + strlen( string );
+	while( begin < end && g_ascii_isspace( *begin )){
+		begin++;
+	}
+	while( end > begin && g_ascii_isspace( end[-1] )){
+		end--;
+	}
 
-		/* GConf-style string list [value,value]
-		 */
-		if( sdup[0] == '[' && sdup[strlen(sdup)-1] == ']' ){
-			sdup[0] = ' ';
-			sdup[strlen(sdup)-1] = ' ';
-			sdup = g_strstrip( sdup );
-			array = g_strsplit( sdup, ",", -1 );
+	/* GConf-style string list [value,value]
+	 */
+	if( end-begin >= 2 && begin[0] == '[' && end[-1] == ']' ){
+		begin++;
+		end--;
+		sep = ',';
 
-		/* semi-comma-separated list of strings
-		 */
-		} else {
-			if( g_str_has_suffix( string, LIST_SEPARATOR )){
-				sdup[strlen(sdup)-1] = ' ';
-				sdup = g_strstrip( sdup );
+	/* semi-comma-separated list of strings
+	 */
+	} else {
+		if( g_str_has_suffix( string, LIST_SEPARATOR )){
+			end--;
+		}
+		sep = LIST_SEPARATOR[0];
+	}
+
+	while( begin < end && g_ascii_isspace( *begin )){
+		begin++;
+	}
+	while( end > begin && g_ascii_isspace( end[-1] )){
+		end--;
+	}
+
+	if( begin < end ){
+		for( it = begin ; it <= end ; ++it ){
+			if( it == end || *it == sep ){
+				( *fn )( boxed, begin, it-begin );
+				begin = it+1;
 			}
-			array = g_strsplit( sdup, LIST_SEPARATOR, -1 );
 		}
-		g_free( sdup );
+	}
+}
+
+/*
+ * returns the shared copy of @string, allocating it on first use
+ */
+static gchar *
+atom_ref( const gchar *string )
+{
+	Atom *atom;
+	gchar *interned;
+
+	G_LOCK( st_atoms );
+
+	if( !st_atoms ){
+		st_atoms = g_hash_table_new_full( g_str_hash, g_str_equal, NULL, ( GDestroyNotify ) atom_free );
+	}
+
+	atom = ( Atom * ) g_hash_table_lookup( st_atoms, string );
+	if( atom ){
+		atom->refcount += 1;
+
+	} else {
+		atom = g_slice_new0( Atom );
+		atom->string = g_strdup( string );
+		atom->refcount = 1;
+		g_hash_table_insert( st_atoms, atom->string, atom );
+	}
+	interned = atom->string;
+
+	G_UNLOCK( st_atoms );
+
+	return( interned );
+}
+
+static void
+atom_unref( gchar *string )
+{
+	static const gchar *thisfn = "na_boxed_atom_unref";
+	Atom *atom;
+
+	G_LOCK( st_atoms );
+
+	atom = st_atoms ? ( Atom * ) g_hash_table_lookup( st_atoms, string ) : NULL;
+	if( atom && atom->string == string ){
+		atom->refcount -= 1;
+		if( !atom->refcount ){
+			g_hash_table_remove( st_atoms, string );
+		}
+
+	} else {
+		g_warning( "%s: string=%p is not an interned string", thisfn, ( void * ) string );
 	}
 
-	return( array );
+	G_UNLOCK( st_atoms );
+}
+
+static void
+atom_free( Atom *atom )
+{
+	g_free( atom->string );
+	g_slice_free( Atom, atom );
+}
+
+/*
+ * allocates a new copy of @string for @boxed: this is either a standard
+ * g_strdup() or a new reference on the interned string
+ */
+static gchar *
+boxed_strdup( const NABoxed *boxed, const gchar *string )
+{
+	if( !string ){
+		return( NULL );
+	}
+
+	return( boxed->private->interned ? atom_ref( string ) : g_strdup( string ));
+}
+
+/*
+ * same than boxed_strdup(), for a slice of @len bytes of @string
+ */
+static gchar *
+boxed_strndup( const NABoxed *boxed, const gchar *string, gsize len )
+{
+	gchar *tmp, *dup;
+
+	if( !boxed->private->interned ){
+		return( g_strndup( string, len ));
+	}
+
+	tmp = g_strndup( string, len );
+	dup = atom_ref( tmp );
+	g_free( tmp );
+
+	return( dup );
+}
+
+static void
+boxed_strfree( const NABoxed *boxed, gchar *string )
+{
+	if( string ){
+		if( boxed->private->interned ){
+			atom_unref( string );
+		} else {
+			g_free( string );
+		}
+	}
+}
+
+/**
+ * na_boxed_set_interning:
+ * @interning: whether string values should be interned.
+ *
+ * When interning is enabled, the #NABoxed objects which are allocated
+ * from now on share a single refcounted copy of each distinct string
+ * value (e.g. "*", "file", "inode/directory"), instead of each keeping
+ * its own copy. This both saves memory on large read-only catalogs, and
+ * lets the equality tests shortcut on pointer comparison.
+ *
+ * The setting only applies to #NABoxed objects allocated after the call;
+ * each object keeps the mode it has been created with until it is
+ * finalized.
+ *
+ * Since: 3.2
+ */
+void
+na_boxed_set_interning( gboolean interning )
+{
+	static const gchar *thisfn = "na_boxed_set_interning";
+
+	g_debug( "%s: interning=%s", thisfn, interning ? "True":"False" );
+
+	st_interning = interning;
 }
 
 /**
@@ -1043,6 +1229,9 @@ pointer_to_void( const NABoxed *boxed )
 static gboolean
 string_are_equal( const NABoxed *a, const NABoxed *b )
 {
+	if( a->private->u.string == b->private->u.string ){
+		return( TRUE );
+	}
 	if( a->private->u.string && b->private->u.string ){
 		return( strcmp( a->private->u.string, b->private->u.string ) == 0 );
 	}
@@ -1055,13 +1244,13 @@ string_are_equal( const NABoxed *a, const NABoxed *b )
 static void
 string_copy( NABoxed *dest, const NABoxed *src )
 {
-	dest->private->u.string = g_strdup( src->private->u.string );
+	dest->private->u.string = boxed_strdup( dest, src->private->u.string );
 }
 
 static void
 string_free( NABoxed *boxed )
 {
-	g_free( boxed->private->u.string );
+	boxed_strfree( boxed, boxed->private->u.string );
 	boxed->private->u.string = NULL;
 	boxed->private->is_set = FALSE;
 }
@@ -1069,23 +1258,23 @@ string_free( NABoxed *boxed )
 static void
 string_from_string( NABoxed *boxed, const gchar *string )
 {
-	boxed->private->u.string = g_strdup( string ? string : "" );
+	boxed->private->u.string = boxed_strdup( boxed, string ? string : "" );
 }
 
 static void
 string_from_value( NABoxed *boxed, const GValue *value )
 {
 	if( g_value_get_string( value )){
-		boxed->private->u.string = g_value_dup_string( value );
+		boxed->private->u.string = boxed_strdup( boxed, g_value_get_string( value ));
 	} else {
-		boxed->private->u.string = g_strdup( "" );
+		boxed->private->u.string = boxed_strdup( boxed, "" );
 	}
 }
 
 static void
 string_from_void( NABoxed *boxed, const void *value )
 {
-	boxed->private->u.string = g_strdup( value ? ( const gchar * ) value : "" );
+	boxed->private->u.string = boxed_strdup( boxed, value ? ( const gchar * ) value : "" );
 }
 
 static gconstpointer
@@ -1131,7 +1320,7 @@ string_list_are_equal( const NABoxed *a, const NABoxed *b )
 	if( na != nb ) return( FALSE );
 
 	for( ia=a->private->u.string_list, ib=b->private->u.string_list ; ia && ib && !diff ; ia=ia->next, ib=ib->next ){
-		if( strcmp( ia->data, ib->data ) != 0 ){
+		if( ia->data != ib->data && strcmp( ia->data, ib->data ) != 0 ){
 			diff = TRUE;
 		}
 	}
@@ -1142,17 +1331,27 @@ string_list_are_equal( const NABoxed *a, const NABoxed *b )
 static void
 string_list_copy( NABoxed *dest, const NABoxed *src )
 {
+	GSList *it;
+
 	if( dest->private->is_set ){
 		string_list_free( dest );
 	}
-	dest->private->u.string_list = na_core_utils_slist_duplicate( src->private->u.string_list );
+	for( it = src->private->u.string_list ; it ; it = it->next ){
+		dest->private->u.string_list = g_slist_prepend( dest->private->u.string_list, boxed_strdup( dest, ( const gchar * ) it->data ));
+	}
+	dest->private->u.string_list = g_slist_reverse( dest->private->u.string_list );
 	dest->private->is_set = TRUE;
 }
 
 static void
 string_list_free( NABoxed *boxed )
 {
-	na_core_utils_slist_free( boxed->private->u.string_list );
+	GSList *it;
+
+	for( it = boxed->private->u.string_list ; it ; it = it->next ){
+		boxed_strfree( boxed, ( gchar * ) it->data );
+	}
+	g_slist_free( boxed->private->u.string_list );
 	boxed->private->u.string_list = NULL;
 	boxed->private->is_set = FALSE;
 }
@@ -1165,23 +1364,31 @@ string_list_free( NABoxed *boxed )
 static void
 string_list_from_string( NABoxed *boxed, const gchar *string )
 {
-	gchar **array;
-	gchar **i;
+	string_list_parse( string, boxed, string_list_from_string_item );
+	boxed->private->u.string_list = g_slist_reverse( boxed->private->u.string_list );
+}
+
+/*
+ * items are prepended to the list, which is reversed at the end of the
+ * parse; an item which is already in the list is ignored
+ *
+ * duplicates are detected with na_core_utils_slist_count(), as in
+ * string_list_from_void(), so that a list is deduplicated the same way
+ * whether it is set from a string or from a GSList
+ */
+static void
+string_list_from_string_item( NABoxed *boxed, const gchar *item, gsize len )
+{
+	gchar *str;
 
-	array = string_to_array( string );
+	str = boxed_strndup( boxed, item, len );
 
-	if( array ){
-		i = ( gchar ** ) array;
-		while( *i ){
-			if( !na_core_utils_slist_count( boxed->private->u.string_list, ( const gchar * )( *i ))){
-				boxed->private->u.string_list = g_slist_prepend( boxed->private->u.string_list, g_strdup( *i ));
-			}
-			i++;
-		}
-		boxed->private->u.string_list = g_slist_reverse( boxed->private->u.string_list );
-	}
+	if( na_core_utils_slist_count( boxed->private->u.string_list, str )){
+		boxed_strfree( boxed, str );
 
-	g_strfreev( array );
+	} else {
+		boxed->private->u.string_list = g_slist_prepend( boxed->private->u.string_list, str );
+	}
 }
 
 static void
@@ -1199,7 +1406,7 @@ string_list_from_void( NABoxed *boxed, const void *value )
 	value_slist = ( GSList * ) value;
 	for( it = value_slist ; it ; it = it->next ){
 		if( !na_core_utils_slist_count( boxed->private->u.string_list, ( const gchar * ) it->data )){
-			boxed->private->u.string_list = g_slist_prepend( boxed->private->u.string_list, g_strdup(( const gchar * ) it->data ));
+			boxed->private->u.string_list = g_slist_prepend( boxed->private->u.string_list, boxed_strdup( boxed, ( const gchar * ) it->data ));
 		}
 	}
 	boxed->private->u.string_list = g_slist_reverse( boxed->private->u.string_list );
@@ -1382,23 +1589,20 @@ uint_list_free( NABoxed *boxed )
 static void
 uint_list_from_string( NABoxed *boxed, const gchar *string )
 {
-	gchar **array;
-	gchar **i;
+	string_list_parse( string, boxed, uint_list_from_string_item );
+	boxed->private->u.uint_list = g_list_reverse( boxed->private->u.uint_list );
+}
 
-	array = string_to_array( string );
+static void
+uint_list_from_string_item( NABoxed *boxed, const gchar *item, gsize len )
+{
+	gchar buffer[32];
 
-	if( array ){
-		i = ( gchar ** ) array;
-		while( *i ){
-			boxed->private->u.uint_list = g_list_prepend( boxed->private->u.uint_list, GINT_TO_POINTER( atoi( *i )));
-			i++;
-		}
-		boxed->private->u.uint_list = g_list_reverse( boxed->private->u.uint_list );
-	} else {
-		boxed->private->u.uint_list = NULL;
-	}
+	len = MIN( len, sizeof( buffer )-1 );
+	memcpy( buffer, item, len );
+	buffer[len] = '\0';
 
-	g_strfreev( array );
+	boxed->private->u.uint_list = g_list_prepend( boxed->private->u.uint_list, GINT_TO_POINTER( atoi( buffer )));
 }
 
 static void
@@ -52,7 +52,7 @@
 static GSList  *text_to_string_list( const gchar *text, const gchar *separator, const gchar *default_value );
 #endif
 static gboolean info_dir_is_writable( GFile *file, const gchar *path );
-static gboolean file_is_loadable( GFile *file );
+static gboolean file_is_loadable( GFile *file, guint64 max_size );
 static void     list_perms( const gchar *path, const gchar *message, const gchar *command );
 
 /**
@@ -1053,7 +1053,41 @@ na_core_utils_file_is_loadable( const gchar *uri )
 	isok = FALSE;
 	file = g_file_new_for_uri( uri );
 
-	isok = file_is_loadable( file );
+	isok = file_is_loadable( file, SIZE_MAX );
+
+	g_object_unref( file );
+
+	return( isok );
+}
+
+/**
+ * na_core_utils_file_is_streamable:
+ * @uri: the URI to be checked.
+ *
+ * Checks that the file is suitable to be read as a stream, i.e. that
+ * it is a regular file (or a symlink to a regular file) and that it is
+ * not empty.
+ *
+ * Contrarily to na_core_utils_file_is_loadable(), there is no upper
+ * limit on the size of the file, as it is not expected to be loaded
+ * at once in memory.
+ *
+ * Returns: whether the file is suitable to be read as a stream.
+ *
+ * Since: 3.2
+ */
+gboolean
+na_core_utils_file_is_streamable( const gchar *uri )
+{
+	static const gchar *thisfn = "na_core_utils_file_is_streamable";
+	GFile *file;
+	gboolean isok;
+
+	g_debug( "%s: uri=%s", thisfn, uri );
+
+	file = g_file_new_for_uri( uri );
+
+	isok = file_is_loadable( file, G_MAXUINT64 );
 
 	g_object_unref( file );
 
@@ -1061,7 +1095,7 @@ na_core_utils_file_is_loadable( const gchar *uri )
 }
 
 static gboolean
-file_is_loadable( GFile *file )
+file_is_loadable( GFile *file, guint64 max_size )
 {
 	static const gchar *thisfn = "na_core_utils_file_is_loadable";
 	GError *error;
@@ -1086,7 +1120,7 @@ file_is_loadable( GFile *file )
 	} else {
 		size = g_file_info_get_attribute_uint64( info, G_FILE_ATTRIBUTE_STANDARD_SIZE );
 		g_debug( "%s: size=%lu", thisfn, ( unsigned long ) size );
-		isok = ( size >= SIZE_MIN && size <= SIZE_MAX );
+		isok = ( size >= SIZE_MIN && size <= max_size );
 	}
 
 	if( isok ){
@@ -1101,7 +1135,7 @@ file_is_loadable( GFile *file )
 				if( target && strlen( target )){
 					target_file = g_file_resolve_relative_path( file, target );
 					if( target_file ){
-						isok = file_is_loadable( target_file );
+						isok = file_is_loadable( target_file, max_size );
 						g_object_unref( target_file );
 					}
 				}
@@ -205,7 +205,7 @@ instance_init( GTypeInstance *instance, gpointer klass )
 
 	self = NA_DATA_BOXED( instance );
 
-	self->private = g_new0( NADataBoxedPrivate, 1 );
+	self->private = g_slice_new0( NADataBoxedPrivate );
 
 	self->private->dispose_has_run = FALSE;
 	self->private->data_def = NULL;
@@ -241,7 +241,7 @@ instance_finalize( GObject *object )
 
 	self = NA_DATA_BOXED( object );
 
-	g_free( self->private );
+	g_slice_free( NADataBoxedPrivate, self->private );
 
 	/* chain call to parent class */
 	if( G_OBJECT_CLASS( st_parent_class )->finalize ){
@@ -249,16 +249,16 @@ instance_finalize( GObject *object )
 	}
 }
 
+/*
+ * st_data_boxed_def[] is ordered by NADataType, as is NABoxed own table
+ */
 static const DataBoxedDef *
 get_data_boxed_def( guint type )
 {
 	static const gchar *thisfn = "na_data_boxed_get_data_boxed_def";
-	int i;
 
-	for( i = 0 ; st_data_boxed_def[i].type ; ++i ){
-		if( st_data_boxed_def[i].type == type ){
-			return(( const DataBoxedDef * ) st_data_boxed_def+i );
-		}
+	if( type > 0 && type < NA_DATA_TYPE_N && st_data_boxed_def[type-1].type == type ){
+		return(( const DataBoxedDef * ) st_data_boxed_def+type-1 );
 	}
 
 	g_warning( "%s: unmanaged data type=%d", thisfn, type );
@@ -389,6 +389,107 @@ na_exporter_to_file( const NAPivot *pivot,
 	return( export_uri );
 }
 
+/*
+ * na_exporter_can_export_items:
+ * @pivot: the #NAPivot pivot for the running application.
+ * @format: the target format identifier.
+ *
+ * Returns: %TRUE if the #NAIExporter which provides the @format is able
+ * to export several items to a single file, %FALSE else.
+ */
+gboolean
+na_exporter_can_export_items( const NAPivot *pivot, const gchar *format )
+{
+	NAIExporter *exporter;
+
+	g_return_val_if_fail( NA_IS_PIVOT( pivot ), FALSE );
+
+	exporter = na_exporter_find_for_format( pivot, format );
+
+	return( exporter && NA_IEXPORTER_GET_INTERFACE( exporter )->items_to_file );
+}
+
+/*
+ * na_exporter_items_to_file:
+ * @pivot: the #NAPivot pivot for the running application.
+ * @items: a #GList of #NAObjectItem-derived objects.
+ * @folder_uri: the URI of the target folder.
+ * @format: the target format identifier.
+ * @messages: a pointer to a #GSList list of strings; the provider
+ *  may append messages to this list, but shouldn't reinitialize it.
+ *
+ * Exports all the specified @items to a single file in the target
+ * @folder_uri in the required @format, through only one #NAIExporter
+ * call.
+ *
+ * Returns: the URI of the exported file, as a newly allocated string which
+ * should be g_free() by the caller, or %NULL if an error has been detected.
+ */
+gchar *
+na_exporter_items_to_file( const NAPivot *pivot,
+		GList *items, const gchar *folder_uri, const gchar *format, GSList **messages )
+{
+	static const gchar *thisfn = "na_exporter_items_to_file";
+	gchar *export_uri;
+	NAIExporterItemsParmsv2 parms;
+	NAIExporter *exporter;
+	gchar *msg;
+	gchar *name;
+
+	g_return_val_if_fail( NA_IS_PIVOT( pivot ), NULL );
+	g_return_val_if_fail( items, NULL );
+
+	export_uri = NULL;
+
+	g_debug( "%s: pivot=%p, items=%p (count=%d), folder_uri=%s, format=%s, messages=%p",
+			thisfn,
+			( void * ) pivot,
+			( void * ) items, g_list_length( items ),
+			folder_uri,
+			format,
+			( void * ) messages );
+
+	exporter = na_exporter_find_for_format( pivot, format );
+
+	if( exporter ){
+		parms.version = 2;
+		parms.content = 1;
+		parms.exported = items;
+		parms.folder = ( gchar * ) folder_uri;
+		parms.format = g_strdup( format );
+		parms.basename = NULL;
+		parms.messages = messages ? *messages : NULL;
+
+		if( NA_IEXPORTER_GET_INTERFACE( exporter )->items_to_file ){
+			NA_IEXPORTER_GET_INTERFACE( exporter )->items_to_file( exporter, &parms );
+
+			if( messages ){
+				*messages = parms.messages;
+			}
+
+			if( parms.basename ){
+				export_uri = g_strdup_printf( "%s%s%s", folder_uri, G_DIR_SEPARATOR_S, parms.basename );
+				g_free( parms.basename );
+			}
+
+		} else {
+			name = exporter_get_name( exporter );
+			/* i18n: NAIExporter is an interface name, do not even try to translate */
+			msg = g_strdup_printf( _( "%s NAIExporter doesn't implement 'items_to_file' interface." ), name );
+			*messages = g_slist_append( *messages, msg );
+			g_free( name );
+		}
+
+		g_free( parms.format );
+
+	} else {
+		msg = g_strdup_printf( NO_IMPLEMENTATION_MSG, format );
+		*messages = g_slist_append( *messages, msg );
+	}
+
+	return( export_uri );
+}
+
 static gchar *
 exporter_get_name( const NAIExporter *exporter )
 {
@@ -61,6 +61,15 @@ gchar       *na_exporter_to_file        ( const NAPivot *pivot,
                                           const gchar *format,
                                           GSList **messages );
 
+gboolean     na_exporter_can_export_items( const NAPivot *pivot,
+                                          const gchar *format );
+
+gchar       *na_exporter_items_to_file  ( const NAPivot *pivot,
+                                          GList *items,
+                                          const gchar *folder_uri,
+                                          const gchar *format,
+                                          GSList **messages );
+
 NAIExporter *na_exporter_find_for_format( const NAPivot *pivot,
 		                                  const gchar *format );
 
@@ -31,10 +31,29 @@
 #include <config.h>
 #endif
 
+#include <sys/wait.h>
+
 #include "na-gconf-migration.h"
+#include "na-settings.h"
 
 #define MIGRATION_COMMAND				PKGLIBEXECDIR "/na-gconf2key.sh -delete -nodummy -verbose"
 
+#ifdef HAVE_GCONF
+/* the structure which describes a running asynchronous migration
+ */
+typedef struct {
+	NAGConfMigrationDoneFn done;
+	gpointer               user_data;
+}
+	MigrationRun;
+
+static gboolean st_running = FALSE;
+
+static gboolean migration_is_needed( void );
+static void     migration_done( gint status );
+static void     on_migration_exited( GPid pid, gint status, MigrationRun *run );
+#endif
+
 /**
  * na_gconf_migration_run:
  *
@@ -42,6 +61,10 @@
  * Disable GConf I/O provider both for reading and writing.
  * Migrate users preferences to NASettings.
  *
+ * The migration is only run once per version of the package: the
+ * version is recorded in the user configuration after a successful
+ * migration.
+ *
  * Since: 3.1
  */
 void
@@ -51,11 +74,16 @@ na_gconf_migration_run( void )
 #ifdef HAVE_GCONF
 	gchar *out, *err;
 	GError *error;
+	gint status;
+
+	if( !migration_is_needed()){
+		return;
+	}
 
 	g_debug( "%s: running %s", thisfn, MIGRATION_COMMAND );
 
 	error = NULL;
-	if( !g_spawn_command_line_sync( MIGRATION_COMMAND, &out, &err, NULL, &error )){
+	if( !g_spawn_command_line_sync( MIGRATION_COMMAND, &out, &err, &status, &error )){
 		g_warning( "%s: %s", thisfn, error->message );
 		g_error_free( error );
 		error = NULL;
@@ -65,8 +93,147 @@ na_gconf_migration_run( void )
 		g_debug( "%s: err=%s", thisfn, err );
 		g_free( out );
 		g_free( err );
+		migration_done( status );
+	}
+#else
+	g_debug( "%s: GConf support is disabled, no migration", thisfn );
+#endif /* HAVE_GCONF */
+}
+
+/**
+ * na_gconf_migration_run_async:
+ * @done: a function to be called when the migration has terminated;
+ *  may be %NULL.
+ * @user_data: data to be passed to @done.
+ *
+ * Same than na_gconf_migration_run(), but does not wait for the end of
+ * the migration: the migration command is run as a child process, and
+ * the version is recorded from the main loop when it terminates.
+ *
+ * While the migration is running, the GConf tree and the I/O provider
+ * flags are being rewritten: the GConf I/O provider is so considered as
+ * not readable (see na_gconf_migration_is_running()), and the caller is
+ * expected to reload its items when @done is called.
+ *
+ * Returns: %TRUE if the migration has been started, and so @done will be
+ * called, %FALSE if the migration does not need to be run or cannot be
+ * started.
+ *
+ * Since: 3.2
+ */
+gboolean
+na_gconf_migration_run_async( NAGConfMigrationDoneFn done, gpointer user_data )
+{
+	static const gchar *thisfn = "na_gconf_migration_run_async";
+#ifdef HAVE_GCONF
+	gchar **argv;
+	GError *error;
+	GPid pid;
+	MigrationRun *run;
+	gboolean started;
+
+	if( st_running || !migration_is_needed()){
+		return( FALSE );
+	}
+
+	g_debug( "%s: running %s", thisfn, MIGRATION_COMMAND );
+
+	error = NULL;
+	argv = NULL;
+	started = FALSE;
+
+	if( !g_shell_parse_argv( MIGRATION_COMMAND, NULL, &argv, &error ) ||
+		!g_spawn_async( NULL, argv, NULL,
+				G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL,
+				NULL, NULL, &pid, &error )){
+
+		g_warning( "%s: %s", thisfn, error->message );
+		g_error_free( error );
+
+	} else {
+		run = g_new0( MigrationRun, 1 );
+		run->done = done;
+		run->user_data = user_data;
+		st_running = TRUE;
+		started = TRUE;
+		g_child_watch_add( pid, ( GChildWatchFunc ) on_migration_exited, run );
 	}
+
+	g_strfreev( argv );
+
+	return( started );
 #else
 	g_debug( "%s: GConf support is disabled, no migration", thisfn );
+
+	return( FALSE );
 #endif /* HAVE_GCONF */
 }
+
+/**
+ * na_gconf_migration_is_running:
+ *
+ * Returns: %TRUE while an asynchronous migration is running, %FALSE else.
+ *
+ * Since: 3.2
+ */
+gboolean
+na_gconf_migration_is_running( void )
+{
+#ifdef HAVE_GCONF
+	return( st_running );
+#else
+	return( FALSE );
+#endif /* HAVE_GCONF */
+}
+
+#ifdef HAVE_GCONF
+/*
+ * the migration has to be run if it has not yet been successfully run
+ * for this version of the package
+ */
+static gboolean
+migration_is_needed( void )
+{
+	static const gchar *thisfn = "na_gconf_migration_is_needed";
+	gchar *version;
+	gboolean needed;
+
+	version = na_settings_get_string( NA_IPREFS_GCONF_MIGRATION_VERSION, NULL, NULL );
+	needed = ( g_strcmp0( version, PACKAGE_VERSION ) != 0 );
+	g_debug( "%s: version=%s, needed=%s", thisfn, version, needed ? "True":"False" );
+	g_free( version );
+
+	return( needed );
+}
+
+/*
+ * record the version after a successful migration
+ * the user configuration is reloaded by NASettings before the stamp be
+ * written, so that the keys written by the migration script are kept
+ */
+static void
+migration_done( gint status )
+{
+	static const gchar *thisfn = "na_gconf_migration_done";
+
+	g_debug( "%s: status=%d", thisfn, status );
+
+	if( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 ){
+		na_settings_set_string( NA_IPREFS_GCONF_MIGRATION_VERSION, PACKAGE_VERSION );
+	}
+}
+
+static void
+on_migration_exited( GPid pid, gint status, MigrationRun *run )
+{
+	g_spawn_close_pid( pid );
+	migration_done( status );
+	st_running = FALSE;
+
+	if( run->done ){
+		( *run->done )( run->user_data );
+	}
+
+	g_free( run );
+}
+#endif /* HAVE_GCONF */
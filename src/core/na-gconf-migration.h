@@ -34,7 +34,20 @@
 
 G_BEGIN_DECLS
 
-void  na_gconf_migration_run( void );
+/**
+ * NAGConfMigrationDoneFn:
+ * @user_data: the data provided to na_gconf_migration_run_async().
+ *
+ * The function called when an asynchronous migration has terminated,
+ * whether it has been successful or not.
+ */
+typedef void ( *NAGConfMigrationDoneFn )( gpointer user_data );
+
+#define NA_GCONF_MIGRATION_PROVIDER_ID	"na-gconf"
+
+void     na_gconf_migration_run       ( void );
+gboolean na_gconf_migration_run_async ( NAGConfMigrationDoneFn done, gpointer user_data );
+gboolean na_gconf_migration_is_running( void );
 
 G_END_DECLS
 
@@ -112,6 +112,7 @@ interface_base_init( NAIExporterInterface *klass )
 		klass->get_formats = NULL;
 		klass->to_file = NULL;
 		klass->to_buffer = NULL;
+		klass->items_to_file = NULL;
 	}
 
 	st_initializations += 1;
@@ -116,6 +116,7 @@ interface_base_init( NAIImporterInterface *klass )
 
 		klass->get_version = iimporter_get_version;
 		klass->import_from_uri = NULL;
+		klass->probe = NULL;
 	}
 
 	st_initializations += 1;
@@ -150,6 +151,10 @@ iimporter_get_version( const NAIImporter *instance )
  * Tries to import a #NAObjectItem from the URI specified in @parms, returning
  * the result in <structfield>@parms->imported</structfield>.
  *
+ * Providers which are able to import several items from a single URI
+ * return the first one in <structfield>@parms->imported</structfield>,
+ * and the following ones in <structfield>@parms->others</structfield>.
+ *
  * Note that, starting with &prodname; 3.2, the @parms argument is no more a
  * #NAIImporterImportFromUriParms pointer, but a #NAIImporterImportFromUriParmsv2
  * one.
@@ -180,6 +185,41 @@ na_iimporter_import_from_uri( const NAIImporter *importer, NAIImporterImportFrom
 	return( code );
 }
 
+/**
+ * na_iimporter_probe:
+ * @importer: this #NAIImporter instance.
+ * @uri: the URI of the file to be imported.
+ * @data: the first bytes of the file.
+ * @length: the length of @data, which should not be greater than
+ *  #NA_IIMPORTER_PROBE_SIZE.
+ *
+ * Asks the @importer whether it is willing to import this content.
+ *
+ * Returns: %FALSE if the @importer is known to not be able to import
+ * the file, %TRUE if it should be tried.
+ *
+ * Since: 3.2
+ */
+gboolean
+na_iimporter_probe( const NAIImporter *importer, const gchar *uri, const gchar *data, gsize length )
+{
+	static const gchar *thisfn = "na_iimporter_probe";
+	gboolean willing_to;
+
+	g_return_val_if_fail( NA_IS_IIMPORTER( importer ), FALSE );
+
+	willing_to = TRUE;
+
+	if( NA_IIMPORTER_GET_INTERFACE( importer )->probe ){
+		willing_to = NA_IIMPORTER_GET_INTERFACE( importer )->probe( importer, uri, data, length );
+	}
+
+	g_debug( "%s: importer=%p (%s), uri=%s, willing_to=%s", thisfn,
+			( void * ) importer, G_OBJECT_TYPE_NAME( importer ), uri, willing_to ? "True":"False" );
+
+	return( willing_to );
+}
+
 #ifdef NA_ENABLE_DEPRECATED
 /**
  * na_iimporter_manage_import_mode:
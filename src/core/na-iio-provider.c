@@ -45,6 +45,7 @@ struct _NAIIOProviderInterfacePrivate {
  */
 enum {
 	ITEM_CHANGED,
+	ITEMS_DELTA,
 	LAST_SIGNAL
 };
 
@@ -126,6 +127,7 @@ interface_base_init( NAIIOProviderInterface *klass )
 		klass->write_item = NULL;
 		klass->delete_item = NULL;
 		klass->duplicate_data = NULL;
+		klass->read_item = NULL;
 
 		/**
 		 * NAIIOProvider::io-provider-item-changed:
@@ -150,6 +152,32 @@ interface_base_init( NAIIOProviderInterface *klass )
 					g_cclosure_marshal_VOID__VOID,
 					G_TYPE_NONE,
 					0 );
+
+		/**
+		 * NAIIOProvider::io-provider-items-delta:
+		 * @provider: the #NAIIOProvider which has called the
+		 *  na_iio_provider_items_delta() function.
+		 * @ids: the list of the identifiers of the modified items.
+		 *
+		 * This signal is registered without any default handler.
+		 *
+		 * This signal is not meant to be directly sent by a plugin.
+		 * Instead, the plugin should call the na_iio_provider_items_delta()
+		 * function.
+		 *
+		 * See also na_iio_provider_items_delta().
+		 */
+		st_signals[ ITEMS_DELTA ] = g_signal_new(
+					IO_PROVIDER_SIGNAL_ITEMS_DELTA,
+					NA_TYPE_IIO_PROVIDER,
+					G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+					0,									/* class offset */
+					NULL,								/* accumulator */
+					NULL,								/* accumulator data */
+					g_cclosure_marshal_VOID__POINTER,
+					G_TYPE_NONE,
+					1,
+					G_TYPE_POINTER );
 	}
 
 	st_initializations += 1;
@@ -216,3 +244,36 @@ na_iio_provider_item_changed( const NAIIOProvider *instance )
 
 	g_signal_emit_by_name(( gpointer ) instance, IO_PROVIDER_SIGNAL_ITEM_CHANGED );
 }
+
+/**
+ * na_iio_provider_items_delta:
+ * @instance: the calling #NAIIOProvider.
+ * @ids: a #GSList of the identifiers of the items which have been
+ *  added, modified or removed.
+ *
+ * Informs &prodname; that this #NAIIOProvider @instance has detected
+ * a modification in the listed items (menus or actions), and only in
+ * these ones.
+ *
+ * The I/O provider should itself have summarized its burst of
+ * notifications before calling this function. The @ids list is owned
+ * by the caller.
+ *
+ * A running program which only displays the items (this is for example
+ * what &nautilus; plugin does) may so read again only the listed items,
+ * through the read_item() method of the #NAIIOProvider interface.
+ * Other programs should handle this function as if
+ * na_iio_provider_item_changed() had been called.
+ *
+ * Since: 3.2
+ */
+void
+na_iio_provider_items_delta( const NAIIOProvider *instance, GSList *ids )
+{
+	static const gchar *thisfn = "na_iio_provider_items_delta";
+
+	g_debug( "%s: instance=%p, ids=%p (count=%u)",
+			thisfn, ( void * ) instance, ( void * ) ids, g_slist_length( ids ));
+
+	g_signal_emit_by_name(( gpointer ) instance, IO_PROVIDER_SIGNAL_ITEMS_DELTA, ids );
+}
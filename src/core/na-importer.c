@@ -31,10 +31,13 @@
 #include <config.h>
 #endif
 
+#include <gio/gio.h>
 #include <glib/gi18n.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <api/na-core-utils.h>
+#include <api/na-data-boxed.h>
 #include <api/na-iimporter.h>
 #include <api/na-object-api.h>
 
@@ -51,6 +54,22 @@ typedef struct {
 }
 	NAImportModeStr;
 
+/* the data shared by all the workers which import the uris
+ */
+typedef struct {
+	GList      *modules;			/* the list of NAIImporter providers */
+	GHashTable *sniffed;			/* content type -> the NAIImporter which last imported it */
+}
+	NAImporterShared;
+
+/* the structure filled by a worker thread when importing an uri
+ */
+typedef struct {
+	const gchar *uri;
+	GList       *results;			/* the NAImporterResult's of this uri, in reverse order */
+}
+	NAImporterSlot;
+
 static NAImportModeStr st_import_modes[] = {
 
 	{ IMPORTER_MODE_NO_IMPORT,
@@ -89,9 +108,13 @@ static NAImportModeStr st_import_ask_mode = {
 			"import-mode-ask.png"
 };
 
-static NAImporterResult *import_from_uri( const NAPivot *pivot, GList *modules, const gchar *uri );
-static void              manage_import_mode( NAImporterParms *parms, GList *results, NAImporterAskUserParms *ask_parms, NAImporterResult *result );
-static NAObjectItem     *is_importing_already_exists( NAImporterParms *parms, GList *results, NAImporterResult *result );
+static GList            *import_uris( GList *modules, GSList *uris );
+static guint             get_import_threads( guint count );
+static void              import_slot( NAImporterSlot *slot, NAImporterShared *shared );
+static GList            *import_from_uri( NAImporterShared *shared, const gchar *uri, GList *results );
+static gchar            *load_head( const gchar *uri, gsize *length, gboolean *complete );
+static void              manage_import_mode( NAImporterParms *parms, GHashTable *imported, NAImporterAskUserParms *ask_parms, NAImporterResult *result );
+static NAObjectItem     *is_importing_already_exists( NAImporterParms *parms, GHashTable *imported, NAImporterResult *result );
 static void              renumber_label_item( NAObjectItem *item );
 static guint             ask_user_for_mode( const NAObjectItem *importing, const NAObjectItem *existing, NAImporterAskUserParms *parms );
 static guint             get_id_from_string( const gchar *str );
@@ -99,6 +122,16 @@ static NAIOption        *get_mode_from_struct( const NAImportModeStr *str );
 
 /* i18n: '%s' stands for the file URI */
 #define ERR_NOT_LOADABLE	_( "%s is not loadable (empty or too big or not a regular file)" )
+/* i18n: '%s' stands for the file URI */
+#define ERR_NOT_PROBED		_( "%s is not recognized by any import provider" )
+
+/* the uris are imported by a pool of worker threads when there are
+ * enough of them
+ */
+#define IMPORT_THREADS_MIN_URIS		16
+#define IMPORT_THREADS_MAX			8
+
+G_LOCK_DEFINE_STATIC( st_sniffed );
 
 /*
  * na_importer_import_from_uris:
@@ -111,15 +144,31 @@ static NAIOption        *get_mode_from_struct( const NAImportModeStr *str );
  * providers until the first which returns with something different from
  * "not_willing_to" code.
  *
+ * Each URI is read only once, and its content is shared by all the
+ * providers. Each provider is first asked whether it is willing to
+ * import this content, by probing its first bytes, so that only the
+ * providers which have recognized the content actually parse it. The
+ * content type of the URI is also guessed from its name and its first
+ * bytes, and the provider which has last imported this same content
+ * type is tried first.
+ *
+ * When there are enough URIs, they are imported by a pool of worker
+ * threads; the results are nonetheless returned in the order of the URIs.
+ *
  * #parms.uris contains a list of URIs to import.
  *
- * Each import operation will have its corresponding newly allocated
+ * Each imported item will have its corresponding newly allocated
  * #NAImporterResult structure which will contain:
  * - the imported URI
  * - the #NAIImporter provider if one has been found, or %NULL
  * - a #NAObjectItem item if import was successful, or %NULL
  * - a list of error messages, or %NULL.
  *
+ * An URI which fails to be imported has one result structure, with a
+ * %NULL item. Contrarily, an URI from which the provider has been able
+ * to import several items has one result structure per item, the error
+ * messages being attached to the first one.
+ *
  * Returns: a #GList of #NAImporterResult structures
  * (was the last import operation code up to 3.2).
  *
@@ -131,10 +180,10 @@ na_importer_import_from_uris( const NAPivot *pivot, NAImporterParms *parms )
 	static const gchar *thisfn = "na_importer_import_from_uris";
 	GList *results, *ires;
 	GList *modules;
-	GSList *uri;
 	NAImporterResult *import_result;
 	NAImporterAskUserParms ask_parms;
-	gchar *mode_str;
+	gchar *mode_str, *id;
+	GHashTable *imported;
 
 	g_return_val_if_fail( NA_IS_PIVOT( pivot ), NULL );
 	g_return_val_if_fail( parms != NULL, NULL );
@@ -146,16 +195,9 @@ na_importer_import_from_uris( const NAPivot *pivot, NAImporterParms *parms )
 	/* first phase: just try to import the uris into memory
 	 */
 	modules = na_pivot_get_providers( pivot, NA_TYPE_IIMPORTER );
-
-	for( uri = parms->uris ; uri ; uri = uri->next ){
-		import_result = import_from_uri( pivot, modules, ( const gchar * ) uri->data );
-		results = g_list_prepend( results, import_result );
-	}
-
+	results = import_uris( modules, parms->uris );
 	na_pivot_free_providers( modules );
 
-	results = g_list_reverse( results );
-
 	memset( &ask_parms, '\0', sizeof( NAImporterAskUserParms ));
 	ask_parms.parent = parms->parent_toplevel;
 	ask_parms.count = 0;
@@ -171,7 +213,10 @@ na_importer_import_from_uris( const NAPivot *pivot, NAImporterParms *parms )
 	}
 
 	/* second phase: check for their pre-existence
+	 * the identifiers of the items already imported are hashed as we go
 	 */
+	imported = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+
 	for( ires = results ; ires ; ires = ires->next ){
 		import_result = ( NAImporterResult * ) ires->data;
 
@@ -180,10 +225,21 @@ na_importer_import_from_uris( const NAPivot *pivot, NAImporterParms *parms )
 			g_return_val_if_fail( NA_IS_IIMPORTER( import_result->importer ), NULL );
 
 			ask_parms.uri = import_result->uri;
-			manage_import_mode( parms, results, &ask_parms, import_result );
+			manage_import_mode( parms, imported, &ask_parms, import_result );
+
+			if( import_result->imported ){
+				id = na_object_get_id( import_result->imported );
+				if( !g_hash_table_lookup( imported, id )){
+					g_hash_table_insert( imported, id, import_result->imported );
+				} else {
+					g_free( id );
+				}
+			}
 		}
 	}
 
+	g_hash_table_destroy( imported );
+
 	return( results );
 }
 
@@ -202,6 +258,114 @@ na_importer_free_result( NAImporterResult *result )
 	g_free( result );
 }
 
+/*
+ * Returns the list of NAImporterResult's of the uris, in the order of
+ * the uris
+ *
+ * Each uri has its own slot, so that the worker threads do not share
+ * anything but the content type cache.
+ */
+static GList *
+import_uris( GList *modules, GSList *uris )
+{
+	static const gchar *thisfn = "na_importer_import_uris";
+	NAImporterShared shared;
+	NAImporterSlot *slots;
+	GList *results;
+	GSList *iu;
+	guint count, threads, i;
+	GThreadPool *pool;
+	GError *error;
+
+	results = NULL;
+	shared.modules = modules;
+	shared.sniffed = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+
+	count = g_slist_length( uris );
+	slots = g_new0( NAImporterSlot, count );
+
+	for( i = 0, iu = uris ; iu ; ++i, iu = iu->next ){
+		slots[i].uri = ( const gchar * ) iu->data;
+	}
+
+	pool = NULL;
+	threads = get_import_threads( count );
+	g_debug( "%s: count=%u, threads=%u", thisfn, count, threads );
+
+	if( threads > 1 ){
+		/* make sure the classes are registered before the workers run */
+		g_type_class_unref( g_type_class_ref( NA_TYPE_OBJECT_ACTION ));
+		g_type_class_unref( g_type_class_ref( NA_TYPE_OBJECT_MENU ));
+		g_type_class_unref( g_type_class_ref( NA_TYPE_OBJECT_PROFILE ));
+		g_type_class_unref( g_type_class_ref( NA_TYPE_DATA_BOXED ));
+
+		error = NULL;
+		pool = g_thread_pool_new(( GFunc ) import_slot, &shared, threads, TRUE, &error );
+		if( error ){
+			g_warning( "%s: %s", thisfn, error->message );
+			g_error_free( error );
+			pool = NULL;
+		}
+	}
+
+	for( i = 0 ; i < count ; ++i ){
+		if( pool ){
+			g_thread_pool_push( pool, &slots[i], NULL );
+		} else {
+			import_slot( &slots[i], &shared );
+		}
+	}
+
+	if( pool ){
+		g_thread_pool_free( pool, FALSE, TRUE );
+	}
+
+	for( i = 0 ; i < count ; ++i ){
+		results = g_list_concat( slots[i].results, results );
+	}
+
+	g_free( slots );
+	g_hash_table_destroy( shared.sniffed );
+
+	return( g_list_reverse( results ));
+}
+
+/*
+ * the count of worker threads depends of the count of uris to be
+ * imported, and of the count of available processors
+ */
+static guint
+get_import_threads( guint count )
+{
+	glong cpus;
+
+	if( count < IMPORT_THREADS_MIN_URIS ){
+		return( 1 );
+	}
+
+	/* threads have to be explicitly initialized before GLib 2.32 */
+#if !GLIB_CHECK_VERSION( 2,32,0 )
+	if( !g_thread_supported()){
+		return( 1 );
+	}
+#endif
+
+	cpus = sysconf( _SC_NPROCESSORS_ONLN );
+
+	return(( guint ) CLAMP( cpus, 1, IMPORT_THREADS_MAX ));
+}
+
+/*
+ * imports one uri
+ *
+ * this may be run in a worker thread
+ */
+static void
+import_slot( NAImporterSlot *slot, NAImporterShared *shared )
+{
+	slot->results = import_from_uri( shared, slot->uri, NULL );
+}
+
 /*
  * Each NAIImporter interface may return some messages, specially if it
  * recognized but is not able to import the provided URI. But as long
@@ -211,31 +375,73 @@ na_importer_free_result( NAImporterResult *result )
  * We so let each interface push its messages in the list, but be ready to
  * only keep the messages provided by the interface which has successfully
  * imported the item.
+ *
+ * Only the first bytes of the URI are read, in order to guess its
+ * content type and to probe the interfaces; an interface which does not
+ * recognize them is not even tried. The whole content is only handed to
+ * the interfaces when these first bytes are actually the whole file;
+ * else the interface reads the URI by itself, and may so stream it.
+ *
+ * The result(s) are prepended to the @results list, which is returned.
  */
-static NAImporterResult *
-import_from_uri( const NAPivot *pivot, GList *modules, const gchar *uri )
+static GList *
+import_from_uri( NAImporterShared *shared, const gchar *uri, GList *results )
 {
 	NAImporterResult *result;
 	NAIImporterImportFromUriParmsv2 provider_parms;
-	GList *im;
+	GList *modules, *im, *io;
 	guint code;
 	GSList *all_messages;
 	NAIImporter *provider;
+	gchar *content_type, *data;
+	gsize length;
+	gboolean complete;
 
 	result = NULL;
 	all_messages = NULL;
 	provider = NULL;
 	code = IMPORTER_CODE_NOT_WILLING_TO;
 
+	data = NULL;
+	length = 0;
+	complete = FALSE;
+	if( na_core_utils_file_is_streamable( uri )){
+		data = load_head( uri, &length, &complete );
+	}
+	if( !data ){
+		code = IMPORTER_CODE_NOT_LOADABLE;
+		na_core_utils_slist_add_message( &all_messages, ERR_NOT_LOADABLE, ( const gchar * ) uri );
+	}
+
+	/* first try the provider which has last imported the same content type
+	 */
+	content_type = g_content_type_guess( uri, ( const guchar * ) data, length, NULL );
+
+	G_LOCK( st_sniffed );
+	provider = g_hash_table_lookup( shared->sniffed, content_type );
+	G_UNLOCK( st_sniffed );
+
+	modules = g_list_copy( shared->modules );
+	if( provider ){
+		modules = g_list_prepend( g_list_remove( modules, provider ), provider );
+		provider = NULL;
+	}
+
 	memset( &provider_parms, '\0', sizeof( NAIImporterImportFromUriParmsv2 ));
 	provider_parms.version = 2;
 	provider_parms.content = 1;
 	provider_parms.uri = uri;
+	provider_parms.data = complete ? data : NULL;
+	provider_parms.length = complete ? length : 0;
 
 	for( im = modules ;
-			im && ( code == IMPORTER_CODE_NOT_WILLING_TO || code == IMPORTER_CODE_NOT_LOADABLE ) ;
+			data && ( code == IMPORTER_CODE_NOT_WILLING_TO || code == IMPORTER_CODE_NOT_LOADABLE ) && im ;
 			im = im->next ){
 
+		if( !na_iimporter_probe( NA_IIMPORTER( im->data ), uri, data, length )){
+			continue;
+		}
+
 		code = na_iimporter_import_from_uri( NA_IIMPORTER( im->data ), &provider_parms );
 
 		if( code == IMPORTER_CODE_NOT_WILLING_TO ){
@@ -256,13 +462,91 @@ import_from_uri( const NAPivot *pivot, GList *modules, const gchar *uri )
 		}
 	}
 
+	if( provider ){
+		G_LOCK( st_sniffed );
+		g_hash_table_insert( shared->sniffed, g_strdup( content_type ), provider );
+		G_UNLOCK( st_sniffed );
+	}
+
+	if( data && !provider && !all_messages ){
+		na_core_utils_slist_add_message( &all_messages, ERR_NOT_PROBED, ( const gchar * ) uri );
+	}
+
+	g_list_free( modules );
+	g_free( content_type );
+	g_free( data );
+
 	result = g_new0( NAImporterResult, 1 );
 	result->uri = g_strdup( uri );
 	result->imported = provider_parms.imported;
 	result->importer = provider;
 	result->messages = all_messages;
+	results = g_list_prepend( results, result );
+
+	/* other items imported from the same uri
+	 */
+	for( io = provider_parms.others ; io ; io = io->next ){
+		result = g_new0( NAImporterResult, 1 );
+		result->uri = g_strdup( uri );
+		result->imported = NA_OBJECT_ITEM( io->data );
+		result->importer = provider;
+		results = g_list_prepend( results, result );
+	}
+
+	g_list_free( provider_parms.others );
 
-	return( result );
+	return( results );
+}
+
+/*
+ * read at most the first NA_IIMPORTER_PROBE_SIZE bytes of the uri
+ *
+ * @complete is set to %TRUE if these bytes are the whole content of the
+ * file.
+ *
+ * Returns: a newly allocated buffer which should be g_free() by the
+ * caller, or %NULL if the file is empty or cannot be read.
+ */
+static gchar *
+load_head( const gchar *uri, gsize *length, gboolean *complete )
+{
+	static const gchar *thisfn = "na_importer_load_head";
+	GFile *file;
+	GFileInputStream *stream;
+	GError *error;
+	gchar *data;
+
+	data = NULL;
+	*length = 0;
+	*complete = FALSE;
+	error = NULL;
+
+	file = g_file_new_for_uri( uri );
+	stream = g_file_read( file, NULL, &error );
+
+	if( stream ){
+		data = g_new0( gchar, NA_IIMPORTER_PROBE_SIZE+1 );
+
+		if( g_input_stream_read_all( G_INPUT_STREAM( stream ), data, NA_IIMPORTER_PROBE_SIZE, length, NULL, &error ) && *length ){
+			*complete = ( *length < NA_IIMPORTER_PROBE_SIZE );
+
+		} else {
+			g_free( data );
+			data = NULL;
+			*length = 0;
+		}
+
+		g_object_unref( stream );
+	}
+
+	if( error ){
+		g_debug( "%s: %s: %s", thisfn, uri, error->message );
+		g_error_free( error );
+	}
+
+	g_object_unref( file );
+
+	return( data );
 }
 
 /*
@@ -270,7 +554,7 @@ import_from_uri( const NAPivot *pivot, GList *modules, const gchar *uri )
  * ask for the user if needed
  */
 static void
-manage_import_mode( NAImporterParms *parms, GList *results, NAImporterAskUserParms *ask_parms, NAImporterResult *result )
+manage_import_mode( NAImporterParms *parms, GHashTable *imported, NAImporterAskUserParms *ask_parms, NAImporterResult *result )
 {
 	static const gchar *thisfn = "na_importer_manage_import_mode";
 	NAObjectItem *exists;
@@ -294,7 +578,7 @@ manage_import_mode( NAImporterParms *parms, GList *results, NAImporterAskUserPar
 		result->mode = IMPORTER_MODE_RENUMBER;
 
 	} else {
-		exists = is_importing_already_exists( parms, results, result );
+		exists = is_importing_already_exists( parms, imported, result );
 	}
 
 	g_debug( "%s: exists=%p", thisfn, exists );
@@ -359,35 +643,23 @@ manage_import_mode( NAImporterParms *parms, GList *results, NAImporterAskUserPar
 /*
  * First check here for duplicates inside of imported population,
  * then delegates to the caller-provided check function the rest of work...
+ *
+ * @imported: a hash table of the items already imported (i.e. the
+ *  previous items of the list), keyed by their identifier.
  */
 static NAObjectItem *
-is_importing_already_exists( NAImporterParms *parms, GList *results, NAImporterResult *result )
+is_importing_already_exists( NAImporterParms *parms, GHashTable *imported, NAImporterResult *result )
 {
 	static const gchar *thisfn = "na_importer_is_importing_already_exists";
 	NAObjectItem *exists;
-	GList *ip;
+	gchar *importing_id;
 
-	exists = NULL;
-
-	gchar *importing_id = na_object_get_id( result->imported );
+	importing_id = na_object_get_id( result->imported );
 	g_debug( "%s: importing=%p, id=%s", thisfn, ( void * ) result->imported, importing_id );
 
 	/* is the importing item already in the current importation list ?
-	 * (only tries previous items of the list)
 	 */
-	for( ip = results ; ip && !exists && ip->data != result ; ip = ip->next ){
-		NAImporterResult *try_result = ( NAImporterResult * ) ip->data;
-
-		if( try_result->imported ){
-			g_return_val_if_fail( NA_IS_OBJECT_ITEM( try_result->imported ), NULL );
-
-			gchar *id = na_object_get_id( try_result->imported );
-			if( !strcmp( importing_id, id )){
-				exists = NA_OBJECT_ITEM( try_result->imported );
-			}
-			g_free( id );
-		}
-	}
+	exists = ( NAObjectItem * ) g_hash_table_lookup( imported, importing_id );
 
 	g_free( importing_id );
 
@@ -38,6 +38,7 @@
 #include <api/na-object-api.h>
 #include <api/na-core-utils.h>
 
+#include "na-gconf-migration.h"
 #include "na-iprefs.h"
 #include "na-io-provider.h"
 
@@ -54,6 +55,7 @@ struct _NAIOProviderPrivate {
 	gchar         *id;
 	NAIIOProvider *provider;
 	gulong         item_changed_handler;
+	gulong         items_delta_handler;
 	gboolean       writable;
 	guint          reason;
 };
@@ -98,8 +100,9 @@ static GList        *load_items_filter_unwanted_items( const NAPivot *pivot, GLi
 static GList        *load_items_filter_unwanted_items_rec( GList *merged, guint loadable_set );
 static GList        *load_items_get_merged_list( const NAPivot *pivot, guint loadable_set, GSList **messages );
 static GList        *load_items_hierarchy_build( GList **tree, GSList *level_zero, gboolean list_if_empty, NAObjectItem *parent );
+static GList        *load_items_hierarchy_build_rec( GHashTable *index, GHashTable *placed, GSList *ids, NAObjectItem *parent );
+static GHashTable   *load_items_hierarchy_index( GList *tree );
 static GList        *load_items_hierarchy_sort( const NAPivot *pivot, GList *tree, GCompareFunc fn );
-static gint          peek_item_by_id_compare( const NAObject *obj, const gchar *id );
 static NAIOProvider *peek_provider_by_id( const GList *providers, const gchar *id );
 
 GType
@@ -186,6 +189,7 @@ instance_init( GTypeInstance *instance, gpointer klass )
 	self->private->id = NULL;
 	self->private->provider = NULL;
 	self->private->item_changed_handler = 0;
+	self->private->items_delta_handler = 0;
 	self->private->writable = FALSE;
 	self->private->reason = NA_IIO_PROVIDER_STATUS_UNAVAILABLE;
 }
@@ -275,6 +279,9 @@ instance_dispose( GObject *object )
 			if( g_signal_handler_is_connected( self->private->provider, self->private->item_changed_handler )){
 				g_signal_handler_disconnect( self->private->provider, self->private->item_changed_handler );
 			}
+			if( g_signal_handler_is_connected( self->private->provider, self->private->items_delta_handler )){
+				g_signal_handler_disconnect( self->private->provider, self->private->items_delta_handler );
+			}
 			g_object_unref( self->private->provider );
 		}
 
@@ -366,6 +373,37 @@ na_io_provider_find_io_provider_by_id( const NAPivot *pivot, const gchar *id )
 	return( found );
 }
 
+/*
+ * na_io_provider_find_io_provider_by_module:
+ * @pivot: the #NAPivot instance.
+ * @module: the #NAIIOProvider plugin.
+ *
+ * Returns: the I/O provider which encapsulates the @module, or NULL.
+ *
+ * The returned provider is owned by NAIOProvider class, and should not
+ * be released by the caller.
+ */
+NAIOProvider *
+na_io_provider_find_io_provider_by_module( const NAPivot *pivot, const NAIIOProvider *module )
+{
+	const GList *providers;
+	const GList *ip;
+	NAIOProvider *provider;
+	NAIOProvider *found;
+
+	providers = na_io_provider_get_io_providers_list( pivot );
+	found = NULL;
+
+	for( ip = providers ; ip && !found ; ip = ip->next ){
+		provider = NA_IO_PROVIDER( ip->data );
+		if( provider->private->provider == module ){
+			found = provider;
+		}
+	}
+
+	return( found );
+}
+
 /*
  * na_io_provider_get_io_providers_list:
  * @pivot: the current #NAPivot instance.
@@ -601,7 +639,8 @@ io_provider_new( const NAPivot *pivot, NAIIOProvider *module, const gchar *id )
 
 /*
  * when a IIOProvider plugin is associated with the NAIOProvider object,
- * we connect the NAPivot callback to the 'item-changed' signal
+ * we connect the NAPivot callbacks to the 'item-changed' and
+ * 'items-delta' signals
  */
 static void
 io_providers_list_set_module( const NAPivot *pivot, NAIOProvider *provider_object, NAIIOProvider *provider_module )
@@ -613,6 +652,11 @@ io_providers_list_set_module( const NAPivot *pivot, NAIOProvider *provider_objec
 					provider_module, IO_PROVIDER_SIGNAL_ITEM_CHANGED,
 					( GCallback ) na_pivot_on_item_changed_handler, ( gpointer ) pivot );
 
+	provider_object->private->items_delta_handler =
+			g_signal_connect(
+					provider_module, IO_PROVIDER_SIGNAL_ITEMS_DELTA,
+					( GCallback ) na_pivot_on_items_delta_handler, ( gpointer ) pivot );
+
 	provider_object->private->writable =
 			is_finally_writable( provider_object, pivot, &provider_object->private->reason );
 
@@ -742,6 +786,9 @@ na_io_provider_is_available( const NAIOProvider *provider )
  * Whether it is editable by the user or not depends on:
  * - whether the whole configuration has been locked down by an admin;
  * - whether this flag has been set as mandatory by an admin.
+ *
+ * The GConf I/O provider is not readable while its items are being
+ * migrated, as it may be left in any intermediate state.
  */
 gboolean
 na_io_provider_is_conf_readable( const NAIOProvider *provider, const NAPivot *pivot, gboolean *mandatory )
@@ -759,6 +806,12 @@ na_io_provider_is_conf_readable( const NAIOProvider *provider, const NAPivot *pi
 		group = g_strdup_printf( "%s %s", NA_IPREFS_IO_PROVIDER_GROUP, provider->private->id );
 		readable = na_settings_get_boolean_ex( group, NA_IPREFS_IO_PROVIDER_READABLE, NULL, mandatory );
 		g_free( group );
+
+		if( readable &&
+			na_gconf_migration_is_running() &&
+			!strcmp( provider->private->id, NA_GCONF_MIGRATION_PROVIDER_ID )){
+				readable = FALSE;
+		}
 	}
 
 	return( readable );
@@ -830,6 +883,40 @@ na_io_provider_is_finally_writable( const NAIOProvider *provider, guint *reason
 	return( is_writable );
 }
 
+/**
+ * na_io_provider_is_item_writable:
+ * @provider: this #NAIOProvider.
+ * @item: a #NAObjectItem which has been read from this @provider.
+ *
+ * Returns: the current writability status of the @item, as evaluated
+ * by the I/O provider if it is able to, or as determined at load time.
+ */
+gboolean
+na_io_provider_is_item_writable( const NAIOProvider *provider, const NAObjectItem *item )
+{
+	gboolean is_writable;
+
+	g_return_val_if_fail( NA_IS_IO_PROVIDER( provider ), FALSE );
+	g_return_val_if_fail( NA_IS_OBJECT_ITEM( item ), FALSE );
+
+	is_writable = FALSE;
+
+	if( !provider->private->dispose_has_run ){
+
+		if( provider->private->provider &&
+			NA_IS_IIO_PROVIDER( provider->private->provider ) &&
+			NA_IIO_PROVIDER_GET_INTERFACE( provider->private->provider )->is_item_writable ){
+
+				is_writable = NA_IIO_PROVIDER_GET_INTERFACE( provider->private->provider )->is_item_writable( provider->private->provider, item );
+
+		} else {
+			is_writable = !na_object_is_readonly( item );
+		}
+	}
+
+	return( is_writable );
+}
+
 /*
  * na_io_provider_load_items:
  * @pivot: the #NAPivot object which owns the list of registered I/O
@@ -916,6 +1003,64 @@ na_io_provider_load_items( const NAPivot *pivot, guint loadable_set, GSList **me
 	return( filtered );
 }
 
+/*
+ * na_io_provider_load_item:
+ * @provider: the #NAIOProvider which is to read the item.
+ * @pivot: the #NAPivot object which owns the list of registered I/O providers.
+ * @id: the identifier of the item.
+ * @loadable_set: the set of loadable items.
+ * @item: [out] set to the newly read item, or to %NULL if the item does
+ *  not exist anymore or is not loadable.
+ * @messages: error messages.
+ *
+ * Reads again a single item, applying the same checks and filters than
+ * na_io_provider_load_items() does.
+ *
+ * Returns: %TRUE if the I/O provider has been able to read the single
+ * item, %FALSE if the whole items list has to be read again.
+ */
+gboolean
+na_io_provider_load_item( const NAIOProvider *provider, const NAPivot *pivot, const gchar *id, guint loadable_set, NAObjectItem **item, GSList **messages )
+{
+	static const gchar *thisfn = "na_io_provider_load_item";
+	NAIIOProvider *module;
+	NAObjectItem *read;
+	GList *list, *filtered;
+
+	g_return_val_if_fail( NA_IS_IO_PROVIDER( provider ), FALSE );
+	g_return_val_if_fail( NA_IS_PIVOT( pivot ), FALSE );
+
+	g_debug( "%s: provider=%p, pivot=%p, id=%s, loadable_set=%d",
+			thisfn, ( void * ) provider, ( void * ) pivot, id, loadable_set );
+
+	*item = NULL;
+	module = provider->private->provider;
+
+	if( !module ||
+		!NA_IIO_PROVIDER_GET_INTERFACE( module )->read_item ||
+		!na_io_provider_is_conf_readable( provider, pivot, NULL )){
+			return( FALSE );
+	}
+
+	read = NA_IIO_PROVIDER_GET_INTERFACE( module )->read_item( module, id, messages );
+
+	if( read ){
+		na_object_set_provider( read, provider );
+		na_object_dump( read );
+
+		list = g_list_prepend( NULL, read );
+		filtered = load_items_filter_unwanted_items( pivot, list, loadable_set );
+		g_list_free( list );
+
+		if( filtered ){
+			*item = NA_OBJECT_ITEM( filtered->data );
+			g_list_free( filtered );
+		}
+	}
+
+	return( TRUE );
+}
+
 #if 0
 static void
 dump( const NAIOProvider *provider )
@@ -1060,7 +1205,7 @@ load_items_filter_unwanted_items_rec( GList *hierarchy, guint loadable_set )
 
 		if( NA_IS_OBJECT_PROFILE( it->data )){
 			if( na_object_is_valid( it->data ) || load_invalid ){
-				filtered = g_list_append( filtered, it->data );
+				filtered = g_list_prepend( filtered, it->data );
 				selected = TRUE;
 			}
 		}
@@ -1072,7 +1217,7 @@ load_items_filter_unwanted_items_rec( GList *hierarchy, guint loadable_set )
 				subitems = na_object_get_items( it->data );
 				subitems_f = load_items_filter_unwanted_items_rec( subitems, loadable_set );
 				na_object_set_items( it->data, subitems_f );
-				filtered = g_list_append( filtered, it->data );
+				filtered = g_list_prepend( filtered, it->data );
 				selected = TRUE;
 			}
 		}
@@ -1085,7 +1230,7 @@ load_items_filter_unwanted_items_rec( GList *hierarchy, guint loadable_set )
 		}
 	}
 
-	return( filtered );
+	return( g_list_reverse( filtered ));
 }
 
 /*
@@ -1132,41 +1277,38 @@ load_items_get_merged_list( const NAPivot *pivot, guint loadable_set, GSList **m
 /*
  * builds the hierarchy
  *
- * this is a recursive function which _moves_ items from input 'tree' to
- * output list.
+ * this function _moves_ items from input 'tree' to output list; items
+ * which are not found in the hierarchy are left in 'tree', in their
+ * original order.
+ *
+ * the flat list is first indexed by id, so that each id of the level
+ * zero and of the menus is found in constant time
  */
 static GList *
 load_items_hierarchy_build( GList **tree, GSList *level_zero, gboolean list_if_empty, NAObjectItem *parent )
 {
-	static const gchar *thisfn = "na_io_provider_load_items_hierarchy_build";
-	GList *hierarchy, *it;
-	GSList *ilevel;
-	GSList *subitems_ids;
-	GList *subitems;
+	GList *hierarchy, *it, *left;
+	GHashTable *index, *placed;
 
 	hierarchy = NULL;
 
-	if( g_slist_length( level_zero )){
-		for( ilevel = level_zero ; ilevel ; ilevel = ilevel->next ){
-			/*g_debug( "%s: id=%s", thisfn, ( gchar * ) ilevel->data );*/
-			it = g_list_find_custom( *tree, ilevel->data, ( GCompareFunc ) peek_item_by_id_compare );
-			if( it ){
-				hierarchy = g_list_append( hierarchy, it->data );
-				na_object_set_parent( it->data, parent );
-
-				g_debug( "%s: id=%s: %s (%p) appended to hierarchy %p",
-						thisfn, ( gchar * ) ilevel->data, G_OBJECT_TYPE_NAME( it->data ), ( void * ) it->data, ( void * ) hierarchy );
+	if( level_zero ){
+		index = load_items_hierarchy_index( *tree );
+		placed = g_hash_table_new( g_direct_hash, g_direct_equal );
 
-				*tree = g_list_remove_link( *tree, it );
+		hierarchy = load_items_hierarchy_build_rec( index, placed, level_zero, parent );
 
-				if( NA_IS_OBJECT_MENU( it->data )){
-					subitems_ids = na_object_get_items_slist( it->data );
-					subitems = load_items_hierarchy_build( tree, subitems_ids, FALSE, NA_OBJECT_ITEM( it->data ));
-					na_object_set_items( it->data, subitems );
-					na_core_utils_slist_free( subitems_ids );
-				}
+		left = NULL;
+		for( it = *tree ; it ; it = it->next ){
+			if( !g_hash_table_lookup( placed, it->data )){
+				left = g_list_prepend( left, it->data );
 			}
 		}
+		g_list_free( *tree );
+		*tree = g_list_reverse( left );
+
+		g_hash_table_destroy( placed );
+		g_hash_table_destroy( index );
 	}
 
 	/* if level-zero list is empty,
@@ -1174,16 +1316,89 @@ load_items_hierarchy_build( GList **tree, GSList *level_zero, gboolean list_if_e
 	 */
 	else if( list_if_empty ){
 		for( it = *tree ; it ; it = it->next ){
-			hierarchy = g_list_append( hierarchy, it->data );
 			na_object_set_parent( it->data, parent );
 		}
-		g_list_free( *tree );
+		hierarchy = *tree;
 		*tree = NULL;
 	}
 
 	return( hierarchy );
 }
 
+/*
+ * recursively builds the hierarchy from the list of ids,
+ * taking the items from the index
+ */
+static GList *
+load_items_hierarchy_build_rec( GHashTable *index, GHashTable *placed, GSList *ids, NAObjectItem *parent )
+{
+	static const gchar *thisfn = "na_io_provider_load_items_hierarchy_build";
+	GList *hierarchy;
+	GSList *iid;
+	GSList *subitems_ids;
+	GList *subitems;
+	GQueue *queue;
+	NAObjectItem *item;
+
+	hierarchy = NULL;
+
+	for( iid = ids ; iid ; iid = iid->next ){
+		queue = ( GQueue * ) g_hash_table_lookup( index, iid->data );
+		item = queue ? ( NAObjectItem * ) g_queue_pop_head( queue ) : NULL;
+
+		if( item ){
+			hierarchy = g_list_prepend( hierarchy, item );
+			g_hash_table_insert( placed, item, item );
+			na_object_set_parent( item, parent );
+
+			g_debug( "%s: id=%s: %s (%p) appended to hierarchy",
+					thisfn, ( gchar * ) iid->data, G_OBJECT_TYPE_NAME( item ), ( void * ) item );
+
+			if( NA_IS_OBJECT_MENU( item )){
+				subitems_ids = na_object_get_items_slist( item );
+				subitems = load_items_hierarchy_build_rec( index, placed, subitems_ids, item );
+				na_object_set_items( item, subitems );
+				na_core_utils_slist_free( subitems_ids );
+			}
+		}
+	}
+
+	return( g_list_reverse( hierarchy ));
+}
+
+/*
+ * returns a hash table which maps each id to the queue of the items
+ * which have this id, in the order of the @tree list
+ */
+static GHashTable *
+load_items_hierarchy_index( GList *tree )
+{
+	GHashTable *index;
+	GList *it;
+	GQueue *queue;
+	gchar *id;
+
+	index = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, ( GDestroyNotify ) g_queue_free );
+
+	for( it = tree ; it ; it = it->next ){
+		if( NA_IS_OBJECT_ITEM( it->data )){
+			id = na_object_get_id( it->data );
+			queue = ( GQueue * ) g_hash_table_lookup( index, id );
+
+			if( queue ){
+				g_free( id );
+			} else {
+				queue = g_queue_new();
+				g_hash_table_insert( index, id, queue );
+			}
+
+			g_queue_push_tail( queue, it->data );
+		}
+	}
+
+	return( index );
+}
+
 static GList *
 load_items_hierarchy_sort( const NAPivot *pivot, GList *tree, GCompareFunc fn )
 {
@@ -1205,24 +1420,6 @@ load_items_hierarchy_sort( const NAPivot *pivot, GList *tree, GCompareFunc fn )
 	return( sorted );
 }
 
-/*
- * returns zero when @obj has the required @id
- */
-static gint
-peek_item_by_id_compare( const NAObject *obj, const gchar *id )
-{
-	gchar *obj_id;
-	gint ret = 1;
-
-	if( NA_IS_OBJECT_ITEM( obj )){
-		obj_id = na_object_get_id( obj );
-		ret = strcmp( obj_id, id );
-		g_free( obj_id );
-	}
-
-	return( ret );
-}
-
 /*
  * na_io_provider_write_item:
  * @provider: this #NAIOProvider object.
@@ -1340,6 +1537,60 @@ na_io_provider_duplicate_data( const NAIOProvider *provider, NAObjectItem *dest,
 	return( ret );
 }
 
+/*
+ * na_io_provider_begin_batch:
+ * @provider: this #NAIOProvider object.
+ *
+ * Opens a batch of writes, if the I/O provider supports it.
+ */
+void
+na_io_provider_begin_batch( const NAIOProvider *provider )
+{
+	g_return_if_fail( NA_IS_IO_PROVIDER( provider ));
+
+	if( !provider->private->dispose_has_run &&
+		provider->private->provider &&
+		NA_IS_IIO_PROVIDER( provider->private->provider ) &&
+		NA_IIO_PROVIDER_GET_INTERFACE( provider->private->provider )->begin_batch ){
+
+			NA_IIO_PROVIDER_GET_INTERFACE( provider->private->provider )->begin_batch( provider->private->provider );
+	}
+}
+
+/*
+ * na_io_provider_commit_batch:
+ * @provider: this #NAIOProvider object.
+ * @messages: error messages.
+ *
+ * Commits a batch of writes previously opened with
+ * na_io_provider_begin_batch().
+ *
+ * Returns: the NAIIOProvider return code.
+ */
+guint
+na_io_provider_commit_batch( const NAIOProvider *provider, GSList **messages )
+{
+	static const gchar *thisfn = "na_io_provider_commit_batch";
+	guint ret;
+
+	ret = NA_IIO_PROVIDER_CODE_PROGRAM_ERROR;
+
+	g_return_val_if_fail( NA_IS_IO_PROVIDER( provider ), ret );
+
+	ret = NA_IIO_PROVIDER_CODE_OK;
+
+	if( !provider->private->dispose_has_run &&
+		provider->private->provider &&
+		NA_IS_IIO_PROVIDER( provider->private->provider ) &&
+		NA_IIO_PROVIDER_GET_INTERFACE( provider->private->provider )->commit_batch ){
+
+			ret = NA_IIO_PROVIDER_GET_INTERFACE( provider->private->provider )->commit_batch( provider->private->provider, messages );
+			g_debug( "%s: provider=%p (%s), ret=%u", thisfn, ( void * ) provider, provider->private->id, ret );
+	}
+
+	return( ret );
+}
+
 /*
  * na_io_provider_get_readonly_tooltip:
  * @reason: the reason for why an item is not writable.
@@ -93,10 +93,16 @@ typedef struct {
  */
 #define IO_PROVIDER_SIGNAL_ITEM_CHANGED		"io-provider-item-changed"
 
+/* signal sent from a NAIIOProvider
+ * via the na_iio_provider_items_delta() function
+ */
+#define IO_PROVIDER_SIGNAL_ITEMS_DELTA		"io-provider-items-delta"
+
 GType         na_io_provider_get_type ( void );
 
 NAIOProvider *na_io_provider_find_writable_io_provider( const NAPivot *pivot );
 NAIOProvider *na_io_provider_find_io_provider_by_id   ( const NAPivot *pivot, const gchar *id );
+NAIOProvider *na_io_provider_find_io_provider_by_module( const NAPivot *pivot, const NAIIOProvider *module );
 const GList  *na_io_provider_get_io_providers_list    ( const NAPivot *pivot );
 void          na_io_provider_unref_io_providers_list  ( void );
 
@@ -106,12 +112,16 @@ gboolean      na_io_provider_is_available       ( const NAIOProvider *provider )
 gboolean      na_io_provider_is_conf_readable   ( const NAIOProvider *provider, const NAPivot *pivot, gboolean *mandatory );
 gboolean      na_io_provider_is_conf_writable   ( const NAIOProvider *provider, const NAPivot *pivot, gboolean *mandatory );
 gboolean      na_io_provider_is_finally_writable( const NAIOProvider *provider, guint *reason );
+gboolean      na_io_provider_is_item_writable   ( const NAIOProvider *provider, const NAObjectItem *item );
 
 GList        *na_io_provider_load_items( const NAPivot *pivot, guint loadable_set, GSList **messages );
+gboolean      na_io_provider_load_item ( const NAIOProvider *provider, const NAPivot *pivot, const gchar *id, guint loadable_set, NAObjectItem **item, GSList **messages );
 
 guint         na_io_provider_write_item    ( const NAIOProvider *provider, const NAObjectItem *item, GSList **messages );
 guint         na_io_provider_delete_item   ( const NAIOProvider *provider, const NAObjectItem *item, GSList **messages );
 guint         na_io_provider_duplicate_data( const NAIOProvider *provider, NAObjectItem *dest, const NAObjectItem *source, GSList **messages );
+void          na_io_provider_begin_batch   ( const NAIOProvider *provider );
+guint         na_io_provider_commit_batch  ( const NAIOProvider *provider, GSList **messages );
 
 gchar        *na_io_provider_get_readonly_tooltip ( guint reason );
 gchar        *na_io_provider_get_return_code_label( guint code );
@@ -52,6 +52,13 @@ struct _NAModulePrivate {
 	GModule  *library;
 	GList    *objects;
 
+	/* manifest
+	 */
+	gchar    *id;						/* the identifier advertised by the manifest */
+	gchar   **interfaces;				/* the names of the implemented interfaces */
+	gboolean  loaded;					/* whether the library has been loaded */
+	gboolean  failed;					/* whether the load has failed */
+
 	/* api
 	 */
 	gboolean ( *startup )    ( GTypeModule *module );
@@ -60,6 +67,11 @@ struct _NAModulePrivate {
 	void     ( *shutdown )   ( void );
 };
 
+#define MANIFEST_SUFFIX					".manifest"
+#define MANIFEST_GROUP					"Nautilus-Actions Module"
+#define MANIFEST_KEY_ID					"Id"
+#define MANIFEST_KEY_INTERFACES			"Interfaces"
+
 static GTypeModuleClass *st_parent_class = NULL;
 
 static GType     register_type( void );
@@ -69,6 +81,9 @@ static void      instance_dispose( GObject *object );
 static void      instance_finalize( GObject *object );
 
 static NAModule *module_new( const gchar *filename );
+static gboolean  module_read_manifest( NAModule *module );
+static gboolean  module_load( NAModule *module );
+static gboolean  module_implements( const NAModule *module, GType type );
 static gboolean  on_module_load( GTypeModule *gmodule );
 static gboolean  is_a_na_plugin( NAModule *module );
 static gboolean  plugin_check( NAModule *module, const gchar *symbol, gpointer *pfn );
@@ -191,6 +206,8 @@ instance_finalize( GObject *object )
 
 	g_free( self->private->path );
 	g_free( self->private->name );
+	g_free( self->private->id );
+	g_strfreev( self->private->interfaces );
 
 	g_free( self->private );
 
@@ -214,6 +231,8 @@ na_module_dump( const NAModule *module )
 
 	g_debug( "%s:    path=%s", thisfn, module->private->path );
 	g_debug( "%s:    name=%s", thisfn, module->private->name );
+	g_debug( "%s:      id=%s", thisfn, module->private->id );
+	g_debug( "%s:  loaded=%s", thisfn, module->private->loaded ? "True":"False" );
 	g_debug( "%s: library=%p", thisfn, ( void * ) module->private->library );
 	g_debug( "%s: objects=%p (count=%d)", thisfn, ( void * ) module->private->objects, g_list_length( module->private->objects ));
 	for( iobj = module->private->objects ; iobj ; iobj = iobj->next ){
@@ -226,8 +245,14 @@ na_module_dump( const NAModule *module )
  *
  * Load availables dynamically loadable extension libraries (plugins).
  *
+ * A plugin which comes with a manifest (a key file with the same basename
+ * and a '.manifest' suffix) is not loaded here: the manifest is read
+ * instead, and the library will only be loaded when one of the
+ * interfaces it advertises is requested (see
+ * na_module_get_extensions_for_type()). Other plugins are loaded at once.
+ *
  * Returns: a #GList of #NAModule, each object representing a dynamically
- * loaded library. The list should be na_module_release_modules() by the
+ * loadable library. The list should be na_module_release_modules() by the
  * caller after use.
  */
 GList *
@@ -262,7 +287,7 @@ na_module_load_modules( void )
 				if( module ){
 					module->private->name = na_core_utils_str_remove_suffix( entry, suffix );
 					modules = g_list_prepend( modules, module );
-					g_debug( "%s: module %s successfully loaded", thisfn, entry );
+					g_debug( "%s: module %s successfully %s", thisfn, entry, module->private->loaded ? "loaded" : "registered" );
 				}
 				g_free( fname );
 			}
@@ -284,16 +309,110 @@ module_new( const gchar *fname )
 	module = g_object_new( NA_TYPE_MODULE, NULL );
 	module->private->path = g_strdup( fname );
 
-	if( !g_type_module_use( G_TYPE_MODULE( module )) || !is_a_na_plugin( module )){
+	if( !module_read_manifest( module ) && !module_load( module )){
 		g_object_unref( module );
 		return( NULL );
 	}
 
-	register_module_types( module );
-
 	return( module );
 }
 
+/*
+ * read the manifest which may be installed besides the library
+ *
+ * Returns: %TRUE if a valid manifest has been found, %FALSE else.
+ */
+static gboolean
+module_read_manifest( NAModule *module )
+{
+	static const gchar *thisfn = "na_module_read_manifest";
+	gchar *base, *manifest;
+	GKeyFile *key_file;
+	GError *error;
+	gboolean ok;
+
+	ok = FALSE;
+	base = na_core_utils_str_remove_suffix( module->private->path, ".so" );
+	manifest = g_strdup_printf( "%s%s", base, MANIFEST_SUFFIX );
+	g_free( base );
+
+	if( g_file_test( manifest, G_FILE_TEST_IS_REGULAR )){
+		key_file = g_key_file_new();
+		error = NULL;
+
+		if( !g_key_file_load_from_file( key_file, manifest, G_KEY_FILE_NONE, &error )){
+			g_warning( "%s: %s: %s", thisfn, manifest, error->message );
+			g_error_free( error );
+
+		} else {
+			module->private->id = g_key_file_get_string( key_file, MANIFEST_GROUP, MANIFEST_KEY_ID, NULL );
+			module->private->interfaces = g_key_file_get_string_list( key_file, MANIFEST_GROUP, MANIFEST_KEY_INTERFACES, NULL, NULL );
+			ok = ( module->private->interfaces != NULL );
+
+			if( !ok ){
+				g_warning( "%s: %s: no interface found", thisfn, manifest );
+			}
+		}
+
+		g_key_file_free( key_file );
+	}
+
+	g_free( manifest );
+
+	return( ok );
+}
+
+/*
+ * actually loads the library, and instanciates the objects it provides
+ *
+ * Returns: %TRUE if the module has been successfully loaded.
+ */
+static gboolean
+module_load( NAModule *module )
+{
+	static const gchar *thisfn = "na_module_load";
+
+	if( !module->private->loaded && !module->private->failed ){
+
+		g_debug( "%s: path=%s", thisfn, module->private->path );
+
+		if( !g_type_module_use( G_TYPE_MODULE( module ))){
+			module->private->failed = TRUE;
+
+		} else if( !is_a_na_plugin( module )){
+			g_type_module_unuse( G_TYPE_MODULE( module ));
+			module->private->failed = TRUE;
+
+		} else {
+			register_module_types( module );
+			module->private->loaded = TRUE;
+		}
+	}
+
+	return( module->private->loaded );
+}
+
+/*
+ * Returns: %TRUE if the manifest of the module advertises the @type
+ * interface.
+ */
+static gboolean
+module_implements( const NAModule *module, GType type )
+{
+	const gchar *name;
+	guint i;
+
+	name = g_type_name( type );
+
+	for( i = 0 ; module->private->interfaces && module->private->interfaces[i] ; ++i ){
+		if( !g_strcmp0( module->private->interfaces[i], name )){
+			return( TRUE );
+		}
+	}
+
+	return( FALSE );
+}
+
 /*
  * triggered by GTypeModule base class when first loading the library,
  * which is itself triggered by module_new:g_type_module_use()
@@ -456,6 +575,9 @@ on_module_unload( GTypeModule *gmodule )
  *
  * Returns: a list of loaded modules willing to deal with requested @type.
  *
+ * The modules which are not loaded yet, and whose manifest advertises
+ * the @type interface, are loaded here.
+ *
  * The returned list should be na_module_free_extensions_list() by the caller.
  */
 GList *
@@ -468,6 +590,11 @@ na_module_get_extensions_for_type( GList *modules, GType type )
 
 	for( im = modules; im ; im = im->next ){
 		a_modul = NA_MODULE( im->data );
+
+		if( !a_modul->private->loaded && module_implements( a_modul, type )){
+			module_load( a_modul );
+		}
+
 		for( io = a_modul->private->objects ; io ; io = io->next ){
 			if( G_TYPE_CHECK_INSTANCE_TYPE( G_OBJECT( io->data ), type )){
 				willing_to = g_list_prepend( willing_to, g_object_ref( io->data ));
@@ -496,8 +623,8 @@ na_module_free_extensions_list( GList *extensions )
  * @module: this #NAModule object.
  * @id: the searched id.
  *
- * Returns: %TRUE if one of the interfaces advertised by the module has
- * the given id, %FALSE else.
+ * Returns: %TRUE if the manifest of the module, or one of the interfaces
+ * advertised by the module, has the given id, %FALSE else.
  */
 gboolean
 na_module_has_id( NAModule *module, const gchar *id )
@@ -505,7 +632,8 @@ na_module_has_id( NAModule *module, const gchar *id )
 	gboolean id_ok;
 	GList *iobj;
 
-	id_ok = FALSE;
+	id_ok = ( g_strcmp0( module->private->id, id ) == 0 );
+
 	for( iobj = module->private->objects ; iobj && !id_ok ; iobj = iobj->next ){
 		g_debug( "na_module_has_id: object=%s", G_OBJECT_TYPE_NAME( iobj->data ));
 	}
@@ -532,11 +660,18 @@ na_module_release_modules( GList *modules )
 	for( imod = modules ; imod ; imod = imod->next ){
 		module = NA_MODULE( imod->data );
 
-		for( iobj = module->private->objects ; iobj ; iobj = iobj->next ){
-			g_object_unref( iobj->data );
-		}
+		if( module->private->loaded ){
+			for( iobj = module->private->objects ; iobj ; iobj = iobj->next ){
+				g_object_unref( iobj->data );
+			}
+
+			g_type_module_unuse( G_TYPE_MODULE( module ));
 
-		g_type_module_unuse( G_TYPE_MODULE( module ));
+		/* a module which has never been used may be safely finalized
+		 */
+		} else if( !module->private->failed ){
+			g_object_unref( module );
+		}
 	}
 
 	g_list_free( modules );
@@ -50,7 +50,9 @@
  *
  * So the dynamic is as follows:
  * - NAPivot scans for the PKGLIBDIR directory, trying to dynamically
- *   load all found libraries
+ *   load all found libraries; a library which comes with a manifest
+ *   is not loaded at this time, but only when one of the interfaces
+ *   advertised by its manifest is first requested
  * - to be considered as a N-A plugin, a library must implement some
  *   functions (see api/na-api.h)
  * - for each found plugin, NAPivot calls na_api_list_types() which
@@ -33,10 +33,12 @@
 
 #include <string.h>
 
+#include <api/na-boxed.h>
 #include <api/na-core-utils.h>
 #include <api/na-timeout.h>
 
 #include "na-io-provider.h"
+#include "na-iprefs.h"
 #include "na-module.h"
 #include "na-pivot.h"
 
@@ -52,6 +54,7 @@ struct _NAPivotPrivate {
 	gboolean    dispose_has_run;
 
 	guint       loadable_set;
+	gboolean    read_only;
 
 	/* dynamically loaded modules (extension plugins)
 	 */
@@ -61,9 +64,20 @@ struct _NAPivotPrivate {
 	 */
 	GList      *tree;
 
+	/* case-insensitive id -> NAObjectItem index of the tree
+	 */
+	GHashTable *index;
+
 	/* timeout to manage i/o providers 'item-changed' burst
 	 */
 	NATimeout   change_timeout;
+
+	/* case-insensitive id -> NAIIOProvider of the items signaled as
+	 * modified since the last timeout, and whether a full reload has
+	 * been required
+	 */
+	GHashTable *delta;
+	gboolean    full_reload;
 };
 
 /* NAPivot properties
@@ -98,10 +112,16 @@ static void          instance_set_property( GObject *object, guint property_id,
 static void          instance_dispose( GObject *object );
 static void          instance_finalize( GObject *object );
 
-static NAObjectItem *get_item_from_tree( const NAPivot *pivot, GList *tree, const gchar *id );
+static guint         index_id_hash( gconstpointer id );
+static gboolean      index_id_equal( gconstpointer a, gconstpointer b );
+static void          index_rebuild( NAPivot *pivot );
+static void          index_add_tree( NAPivot *pivot, GList *tree );
+static void          index_remove_tree( NAPivot *pivot, GList *tree );
 
 /* NAIIOProvider management */
 static void          on_items_changed_timeout( NAPivot *pivot );
+static gboolean      delta_apply( NAPivot *pivot );
+static gboolean      delta_apply_item( NAPivot *pivot, const gchar *id, NAIIOProvider *module );
 
 GType
 na_pivot_get_type( void )
@@ -211,8 +231,12 @@ instance_init( GTypeInstance *instance, gpointer klass )
 
 	self->private->dispose_has_run = FALSE;
 	self->private->loadable_set = PIVOT_LOAD_NONE;
+	self->private->read_only = FALSE;
 	self->private->modules = NULL;
 	self->private->tree = NULL;
+	self->private->index = g_hash_table_new_full( index_id_hash, index_id_equal, g_free, NULL );
+	self->private->delta = g_hash_table_new_full( index_id_hash, index_id_equal, g_free, NULL );
+	self->private->full_reload = FALSE;
 
 	/* initialize timeout parameters for 'item-changed' handler
 	 */
@@ -293,6 +317,7 @@ instance_set_property( GObject *object, guint property_id, const GValue *value,
 
 			case PIVOT_PROP_TREE_ID:
 				self->private->tree = g_value_get_pointer( value );
+				index_rebuild( self );
 				break;
 
 			default:
@@ -326,6 +351,10 @@ instance_dispose( GObject *object )
 		g_debug( "%s: tree=%p (count=%u)", thisfn,
 				( void * ) self->private->tree, g_list_length( self->private->tree ));
 		na_object_dump_tree( self->private->tree );
+		g_hash_table_destroy( self->private->index );
+		self->private->index = NULL;
+		g_hash_table_destroy( self->private->delta );
+		self->private->delta = NULL;
 		self->private->tree = na_object_free_items( self->private->tree );
 
 		/* release the settings */
@@ -411,6 +440,7 @@ na_pivot_dump( const NAPivot *pivot )
 	if( !pivot->private->dispose_has_run ){
 
 		g_debug( "%s: loadable_set=%d", thisfn, pivot->private->loadable_set );
+		g_debug( "%s:    read_only=%s", thisfn, pivot->private->read_only ? "True":"False" );
 		g_debug( "%s:      modules=%p (%d elts)", thisfn, ( void * ) pivot->private->modules, g_list_length( pivot->private->modules ));
 		g_debug( "%s:         tree=%p (%d elts)", thisfn, ( void * ) pivot->private->tree, g_list_length( pivot->private->tree ));
 		/*g_debug( "%s:     monitors=%p (%d elts)", thisfn, ( void * ) pivot->private->monitors, g_list_length( pivot->private->monitors ));*/
@@ -495,33 +525,138 @@ na_pivot_get_item( const NAPivot *pivot, const gchar *id )
 			return( NULL );
 		}
 
-		object = get_item_from_tree( pivot, pivot->private->tree, id );
+		object = ( NAObjectItem * ) g_hash_table_lookup( pivot->private->index, id );
 	}
 
 	return( object );
 }
 
-static NAObjectItem *
-get_item_from_tree( const NAPivot *pivot, GList *tree, const gchar *id )
+/*
+ * na_pivot_index_item:
+ * @pivot: this #NAPivot instance.
+ * @item: a #NAObjectItem which has just been inserted in the tree.
+ *
+ * Registers @item and its subitems in the index of the tree, so that
+ * they are found by na_pivot_get_item().
+ *
+ * There is no need to call this function when the whole tree is set,
+ * either by loading items or by setting the tree property.
+ */
+void
+na_pivot_index_item( NAPivot *pivot, NAObjectItem *item )
 {
-	GList *subitems, *ia;
-	NAObjectItem *found = NULL;
+	GList *list;
 
-	for( ia = tree ; ia && !found ; ia = ia->next ){
+	g_return_if_fail( NA_IS_PIVOT( pivot ));
+	g_return_if_fail( NA_IS_OBJECT_ITEM( item ));
 
-		gchar *i_id = na_object_get_id( NA_OBJECT( ia->data ));
+	if( !pivot->private->dispose_has_run ){
 
-		if( !g_ascii_strcasecmp( id, i_id )){
-			found = NA_OBJECT_ITEM( ia->data );
-		}
+		list = g_list_prepend( NULL, item );
+		index_add_tree( pivot, list );
+		g_list_free( list );
+	}
+}
 
-		if( !found && NA_IS_OBJECT_ITEM( ia->data )){
-			subitems = na_object_get_items( ia->data );
-			found = get_item_from_tree( pivot, subitems, id );
+/*
+ * na_pivot_unindex_item:
+ * @pivot: this #NAPivot instance.
+ * @item: a #NAObjectItem which is about to be removed from the tree.
+ *
+ * Removes @item and its subitems from the index of the tree.
+ */
+void
+na_pivot_unindex_item( NAPivot *pivot, NAObjectItem *item )
+{
+	GList *list;
+
+	g_return_if_fail( NA_IS_PIVOT( pivot ));
+	g_return_if_fail( NA_IS_OBJECT_ITEM( item ));
+
+	if( !pivot->private->dispose_has_run ){
+
+		list = g_list_prepend( NULL, item );
+		index_remove_tree( pivot, list );
+		g_list_free( list );
+	}
+}
+
+/*
+ * ids are compared case-insensitively: hash them the same way
+ */
+static guint
+index_id_hash( gconstpointer id )
+{
+	const gchar *p;
+	guint hash;
+
+	hash = 5381;
+	for( p = ( const gchar * ) id ; *p ; ++p ){
+		hash = ( hash << 5 ) + hash + g_ascii_tolower( *p );
+	}
+
+	return( hash );
+}
+
+static gboolean
+index_id_equal( gconstpointer a, gconstpointer b )
+{
+	return( g_ascii_strcasecmp(( const gchar * ) a, ( const gchar * ) b ) == 0 );
+}
+
+static void
+index_rebuild( NAPivot *pivot )
+{
+	g_hash_table_remove_all( pivot->private->index );
+	index_add_tree( pivot, pivot->private->tree );
+}
+
+/*
+ * the tree is walked depth-first, and an already indexed id is not
+ * replaced, so that the found item is the same than the one a walk
+ * of the tree would have found first
+ */
+static void
+index_add_tree( NAPivot *pivot, GList *tree )
+{
+	GList *it;
+	gchar *id;
+
+	for( it = tree ; it ; it = it->next ){
+
+		if( NA_IS_OBJECT_ITEM( it->data )){
+			id = na_object_get_id( it->data );
+
+			if( id && !g_hash_table_lookup( pivot->private->index, id )){
+				g_hash_table_insert( pivot->private->index, id, it->data );
+			} else {
+				g_free( id );
+			}
+
+			index_add_tree( pivot, na_object_get_items( it->data ));
 		}
 	}
+}
+
+static void
+index_remove_tree( NAPivot *pivot, GList *tree )
+{
+	GList *it;
+	gchar *id;
+
+	for( it = tree ; it ; it = it->next ){
+
+		if( NA_IS_OBJECT_ITEM( it->data )){
+			id = na_object_get_id( it->data );
+
+			if( id && g_hash_table_lookup( pivot->private->index, id ) == it->data ){
+				g_hash_table_remove( pivot->private->index, id );
+			}
+			g_free( id );
 
-	return( found );
+			index_remove_tree( pivot, na_object_get_items( it->data ));
+		}
+	}
 }
 
 /*
@@ -570,8 +705,21 @@ na_pivot_load_items( NAPivot *pivot )
 
 		messages = NULL;
 		na_object_free_items( pivot->private->tree );
+
+		/* items which are not going to be edited share their string values
+		 */
+		if( pivot->private->read_only ){
+			na_boxed_set_interning( TRUE );
+		}
+
 		pivot->private->tree = na_io_provider_load_items( pivot, pivot->private->loadable_set, &messages );
 
+		if( pivot->private->read_only ){
+			na_boxed_set_interning( FALSE );
+		}
+
+		index_rebuild( pivot );
+
 		for( im = messages ; im ; im = im->next ){
 			g_warning( "%s: %s", thisfn, ( const gchar * ) im->data );
 		}
@@ -602,6 +750,7 @@ na_pivot_set_new_items( NAPivot *pivot, GList *items )
 
 		na_object_free_items( pivot->private->tree );
 		pivot->private->tree = items;
+		index_rebuild( pivot );
 	}
 }
 
@@ -631,6 +780,48 @@ na_pivot_on_item_changed_handler( NAIIOProvider *provider, NAPivot *pivot  )
 	if( !pivot->private->dispose_has_run ){
 		g_debug( "%s: provider=%p, pivot=%p", thisfn, ( void * ) provider, ( void * ) pivot );
 
+		pivot->private->full_reload = TRUE;
+		na_timeout_event( &pivot->private->change_timeout );
+	}
+}
+
+/*
+ * na_pivot_on_items_delta_handler:
+ * @provider: the #NAIIOProvider which has emitted the signal.
+ * @ids: the list of the identifiers of the modified items.
+ * @pivot: this #NAPivot instance.
+ *
+ * This handler is trigerred by #NAIIOProvider providers which are able
+ * to say which items have been added, modified or removed.
+ *
+ * The identifiers are accumulated until the end of the notifications
+ * serie; an identifier signaled by two different providers requires
+ * a full reload.
+ */
+void
+na_pivot_on_items_delta_handler( NAIIOProvider *provider, GSList *ids, NAPivot *pivot )
+{
+	static const gchar *thisfn = "na_pivot_on_items_delta_handler";
+	GSList *it;
+	NAIIOProvider *previous;
+
+	g_return_if_fail( NA_IS_IIO_PROVIDER( provider ));
+	g_return_if_fail( NA_IS_PIVOT( pivot ));
+
+	if( !pivot->private->dispose_has_run ){
+		g_debug( "%s: provider=%p, ids=%p (count=%u), pivot=%p",
+				thisfn, ( void * ) provider, ( void * ) ids, g_slist_length( ids ), ( void * ) pivot );
+
+		for( it = ids ; it ; it = it->next ){
+			previous = ( NAIIOProvider * ) g_hash_table_lookup( pivot->private->delta, it->data );
+
+			if( previous && previous != provider ){
+				pivot->private->full_reload = TRUE;
+			} else {
+				g_hash_table_insert( pivot->private->delta, g_strdup(( const gchar * ) it->data ), provider );
+			}
+		}
+
 		na_timeout_event( &pivot->private->change_timeout );
 	}
 }
@@ -640,6 +831,10 @@ na_pivot_on_item_changed_handler( NAIIOProvider *provider, NAPivot *pivot  )
  * and having received no more event during a 'st_burst_timeout' period; we can
  * so suppose that the burst if modification events is terminated
  * this is up to NAPivot to send now its summarized signal
+ *
+ * a read-only pivot is not edited by its consumer, and so keeps itself
+ * up to date before sending the signal: it patches its tree in place
+ * when the modified items are known, and reloads it else
  */
 static void
 on_items_changed_timeout( NAPivot *pivot )
@@ -648,10 +843,163 @@ on_items_changed_timeout( NAPivot *pivot )
 
 	g_return_if_fail( NA_IS_PIVOT( pivot ));
 
+	if( pivot->private->read_only ){
+		if( pivot->private->full_reload || !delta_apply( pivot )){
+			g_debug( "%s: reloading the items", thisfn );
+			na_pivot_load_items( pivot );
+		}
+	}
+
+	g_hash_table_remove_all( pivot->private->delta );
+	pivot->private->full_reload = FALSE;
+
 	g_debug( "%s: emitting %s signal", thisfn, PIVOT_SIGNAL_ITEMS_CHANGED );
 	g_signal_emit_by_name(( gpointer ) pivot, PIVOT_SIGNAL_ITEMS_CHANGED );
 }
 
+/*
+ * patches the tree with each modified item
+ *
+ * returns FALSE as soon as an item cannot be patched, in which case
+ * the tree has to be fully reloaded
+ */
+static gboolean
+delta_apply( NAPivot *pivot )
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	gboolean ok;
+
+	ok = TRUE;
+	g_hash_table_iter_init( &iter, pivot->private->delta );
+
+	while( ok && g_hash_table_iter_next( &iter, &key, &value )){
+		ok = delta_apply_item( pivot, ( const gchar * ) key, NA_IIO_PROVIDER( value ));
+	}
+
+	return( ok );
+}
+
+/*
+ * only an existing action is patched in place, as it keeps its position
+ * in the hierarchy; menus hold the hierarchy, and a new item has to be
+ * positioned according to the level-zero order and to the menus which
+ * may reference it: all these cases require a full reload
+ *
+ * when the items are alphabetically ordered, the label of the action may
+ * have changed: its level is so sorted again, the same way the hierarchy
+ * is sorted when loading it
+ */
+static gboolean
+delta_apply_item( NAPivot *pivot, const gchar *id, NAIIOProvider *module )
+{
+	static const gchar *thisfn = "na_pivot_delta_apply_item";
+	NAIOProvider *provider;
+	NAObjectItem *existing, *item, *parent;
+	gchar *existing_id;
+	gboolean same_id, was_valid, ok;
+	GSList *messages, *im;
+	GList *link;
+	GCompareFunc sort_fn;
+
+	existing = ( NAObjectItem * ) g_hash_table_lookup( pivot->private->index, id );
+	if( !existing || !NA_IS_OBJECT_ACTION( existing )){
+		return( FALSE );
+	}
+
+	provider = na_io_provider_find_io_provider_by_module( pivot, module );
+	if( !provider || na_object_get_provider( existing ) != provider ){
+		return( FALSE );
+	}
+
+	existing_id = na_object_get_id( existing );
+	same_id = !strcmp( existing_id, id );
+	g_free( existing_id );
+	if( !same_id ){
+		return( FALSE );
+	}
+
+	messages = NULL;
+	item = NULL;
+	ok = na_io_provider_load_item( provider, pivot, id, pivot->private->loadable_set, &item, &messages );
+
+	for( im = messages ; im ; im = im->next ){
+		g_warning( "%s: %s", thisfn, ( const gchar * ) im->data );
+	}
+	na_core_utils_slist_free( messages );
+
+	if( !ok ){
+		return( FALSE );
+	}
+
+	if( item && !NA_IS_OBJECT_ACTION( item )){
+		na_object_unref( item );
+		return( FALSE );
+	}
+
+	g_debug( "%s: id=%s, existing=%p, item=%p", thisfn, id, ( void * ) existing, ( void * ) item );
+
+	na_pivot_unindex_item( pivot, existing );
+	parent = na_object_get_parent( existing );
+
+	if( parent ){
+		if( item ){
+			na_object_insert_item( parent, item, existing );
+			na_object_set_parent( item, parent );
+		}
+		na_object_remove_item( parent, existing );
+
+	} else {
+		link = g_list_find( pivot->private->tree, existing );
+		if( item ){
+			link->data = item;
+		} else {
+			pivot->private->tree = g_list_delete_link( pivot->private->tree, link );
+		}
+	}
+
+	if( item ){
+		na_pivot_index_item( pivot, item );
+
+		switch( na_iprefs_get_order_mode( NULL )){
+			case IPREFS_ORDER_ALPHA_ASCENDING:
+				sort_fn = ( GCompareFunc ) na_object_id_sort_alpha_asc;
+				break;
+
+			case IPREFS_ORDER_ALPHA_DESCENDING:
+				sort_fn = ( GCompareFunc ) na_object_id_sort_alpha_desc;
+				break;
+
+			case IPREFS_ORDER_MANUAL:
+			default:
+				sort_fn = NULL;
+				break;
+		}
+
+		if( sort_fn ){
+			if( parent ){
+				na_object_set_items( parent, g_list_sort( na_object_get_items( parent ), sort_fn ));
+			} else {
+				pivot->private->tree = g_list_sort( pivot->private->tree, sort_fn );
+			}
+		}
+	}
+	na_object_unref( existing );
+
+	/* the status of a menu depends of the status of its subitems
+	 */
+	ok = TRUE;
+	for( ; parent ; parent = na_object_get_parent( parent )){
+		was_valid = na_object_is_valid( parent );
+		na_object_check_status( parent );
+		if( na_object_is_valid( parent ) != was_valid ){
+			ok = FALSE;
+		}
+	}
+
+	return( ok );
+}
+
 /*
  * na_pivot_set_loadable:
  * @pivot: this #NAPivot instance.
@@ -669,3 +1017,23 @@ na_pivot_set_loadable( NAPivot *pivot, guint loadable )
 		pivot->private->loadable_set = loadable;
 	}
 }
+
+/*
+ * na_pivot_set_read_only:
+ * @pivot: this #NAPivot instance.
+ * @read_only: whether the loaded items are only to be read.
+ *
+ * Let the caller (e.g. the Nautilus plugin or the command-line runner)
+ * say that the loaded items will never be edited, so that they may be
+ * loaded in a more memory-efficient way.
+ */
+void
+na_pivot_set_read_only( NAPivot *pivot, gboolean read_only )
+{
+	g_return_if_fail( NA_IS_PIVOT( pivot ));
+
+	if( !pivot->private->dispose_has_run ){
+
+		pivot->private->read_only = read_only;
+	}
+}
@@ -64,10 +64,19 @@
  *   which was connected when the I/O provider plugin was associated with
  *   the NAIOProvider object.
  *
+ * - An I/O provider which knows which items have been modified may rather
+ *   call the na_iio_provider_items_delta() function; the emitted
+ *   "io-provider-items-delta" signal is catched by
+ *   na_pivot_on_items_delta_handler().
+ *
  * - The NAPivot object receives these notifications originating from all
  *   loaded I/O providers, itself summarizes them, and only then notify its
  *   consumers with only one message for a whole set of modifications.
  *
+ * - A read-only NAPivot keeps itself up to date before notifying its
+ *   consumers: it reads again only the modified items when they are
+ *   known, patching its tree in place, and reloads the whole tree else.
+ *
  * It is eventually up to the consumer to connect to this signal, and
  * choose itself whether to reload items or not.
  */
@@ -149,12 +158,16 @@ NAObjectItem *na_pivot_get_item     ( const NAPivot *pivot, const gchar *id );
 GList        *na_pivot_get_items    ( const NAPivot *pivot );
 void          na_pivot_load_items   ( NAPivot *pivot );
 void          na_pivot_set_new_items( NAPivot *pivot, GList *tree );
+void          na_pivot_index_item   ( NAPivot *pivot, NAObjectItem *item );
+void          na_pivot_unindex_item ( NAPivot *pivot, NAObjectItem *item );
 
 void          na_pivot_on_item_changed_handler( NAIIOProvider *provider, NAPivot *pivot  );
+void          na_pivot_on_items_delta_handler ( NAIIOProvider *provider, GSList *ids, NAPivot *pivot );
 
 /* NAPivot properties and configuration
  */
 void          na_pivot_set_loadable     ( NAPivot *pivot, guint loadable );
+void          na_pivot_set_read_only    ( NAPivot *pivot, gboolean read_only );
 
 G_END_DECLS
 
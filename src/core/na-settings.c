@@ -107,15 +107,18 @@ typedef struct {
 }
 	Consumer;
 
+typedef struct _KeySlot                 KeySlot;
+
 /* private instance data
  */
 struct _NASettingsPrivate {
-	gboolean  dispose_has_run;
-	KeyFile  *mandatory;
-	KeyFile  *user;
-	GList    *content;
-	GList    *consumers;
-	NATimeout timeout;
+	gboolean    dispose_has_run;
+	KeyFile    *mandatory;
+	KeyFile    *user;
+	GList      *content;
+	GHashTable *consumers;				/* monitored key -> GList of Consumers */
+	KeySlot    *slots;
+	NATimeout   timeout;
 };
 
 #define GROUP_NACT						"nact"
@@ -155,6 +158,7 @@ static const KeyDef st_def_keys[] = {
 	{ NA_IPREFS_EXPORT_PREFERRED_FORMAT,          GROUP_NACT,    NA_DATA_TYPE_STRING,      "Ask" },
 	{ NA_IPREFS_FOLDER_CHOOSER_WSP,               GROUP_NACT,    NA_DATA_TYPE_UINT_LIST,   "" },
 	{ NA_IPREFS_FOLDER_CHOOSER_URI,               GROUP_NACT,    NA_DATA_TYPE_STRING,      "file:///" },
+	{ NA_IPREFS_GCONF_MIGRATION_VERSION,          GROUP_RUNTIME, NA_DATA_TYPE_STRING,      "" },
 	{ NA_IPREFS_IMPORT_ASK_USER_WSP,              GROUP_NACT,    NA_DATA_TYPE_UINT_LIST,   "" },
 	{ NA_IPREFS_IMPORT_ASK_USER_LAST_MODE,        GROUP_NACT,    NA_DATA_TYPE_STRING,      "NoImport" },
 	{ NA_IPREFS_IMPORT_ASSISTANT_WSP,             GROUP_NACT,    NA_DATA_TYPE_UINT_LIST,   "" },
@@ -191,6 +195,22 @@ static const KeyDef st_def_keys[] = {
 	{ 0 }
 };
 
+#define KEY_DEF_COUNT					( G_N_ELEMENTS( st_def_keys ) - 1 )
+
+/* The decoded snapshot of the configuration.
+ * There is one slot per key definition, indexed by the position of the
+ * KeyDef in st_def_keys; it holds the value of the key in its default
+ * group, and is refreshed each time the configuration is reloaded, so
+ * that getters do not have to access the key files.
+ */
+struct _KeySlot {
+	gboolean  found;
+	gboolean  mandatory;
+	NABoxed  *boxed;						/* NULL if not found */
+	gboolean  boolean;						/* decoded value for booleans */
+	guint     uint;							/* decoded value for uints */
+};
+
 /* The configuration content is handled as a GList of KeyValue structs.
  * This list is loaded at initialization time, and then compared each
  * time our file monitors signal us that a change has occured.
@@ -214,6 +234,7 @@ static GObjectClass *st_parent_class           = NULL;
 static gint          st_burst_timeout          = 100;		/* burst timeout in msec */
 static gint          st_signals[ LAST_SIGNAL ] = { 0 };
 static NASettings   *st_settings               = NULL;
+static GHashTable   *st_keys                   = NULL;
 
 static GType     settings_get_type( void );
 static GType     register_type( void );
@@ -225,19 +246,29 @@ static void      instance_finalize( GObject *object );
 static void      settings_new( void );
 
 static GList    *content_diff( GList *old, GList *new );
+static GHashTable *content_hash_new( GList *content );
 static GList    *content_load_keys( GList *content, KeyFile *keyfile );
 static KeyDef   *get_key_def( const gchar *key );
 static KeyFile  *key_file_new( const gchar *dir );
+static gboolean  key_value_equal( const KeyValue *a, const KeyValue *b );
+static guint     key_value_hash( const KeyValue *value );
+static void      notify_consumers( GList *consumers, const KeyValue *changed );
 static void      on_keyfile_changed( GFileMonitor *monitor, GFile *file, GFile *other_file, GFileMonitorEvent event_type );
 static void      on_keyfile_changed_timeout( void );
 static void      on_key_changed_final_handler( NASettings *settings, gchar *group, gchar *key, NABoxed *new_value, gboolean mandatory );
-static KeyValue *peek_key_value_from_content( GList *content, const gchar *group, const gchar *key );
+static KeyDef   *peek_key_def( const gchar *key );
+static KeySlot  *peek_key_slot( const gchar *group, const gchar *key, gboolean *found, gboolean *mandatory );
 static KeyValue *read_key_value( const gchar *group, const gchar *key, gboolean *found, gboolean *mandatory );
 static KeyValue *read_key_value_from_key_file( KeyFile *keyfile, const gchar *group, const gchar *key, const KeyDef *key_def );
 static void      release_consumer( Consumer *consumer );
+static void      release_consumers( GList *consumers );
 static void      release_key_file( KeyFile *key_file );
 static void      release_key_value( KeyValue *value );
+static void      release_slots( KeySlot *slots );
+static void      reload_user_key_file( void );
 static gboolean  set_key_value( const gchar *group, const gchar *key, const gchar *string );
+static void      slot_set_value( KeySlot *slot, const KeyDef *key_def, NABoxed *boxed, gboolean mandatory );
+static void      slots_load_content( KeySlot *slots, GList *content );
 static gboolean  write_user_key_file( void );
 
 static GType
@@ -343,7 +374,8 @@ instance_init( GTypeInstance *instance, gpointer klass )
 	self->private->mandatory = NULL;
 	self->private->user = NULL;
 	self->private->content = NULL;
-	self->private->consumers = NULL;
+	self->private->consumers = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, ( GDestroyNotify ) release_consumers );
+	self->private->slots = g_new0( KeySlot, KEY_DEF_COUNT );
 
 	self->private->timeout.timeout = st_burst_timeout;
 	self->private->timeout.handler = ( NATimeoutFunc ) on_keyfile_changed_timeout;
@@ -391,8 +423,9 @@ instance_finalize( GObject *object )
 	g_list_foreach( self->private->content, ( GFunc ) release_key_value, NULL );
 	g_list_free( self->private->content );
 
-	g_list_foreach( self->private->consumers, ( GFunc ) release_consumer, NULL );
-	g_list_free( self->private->consumers );
+	g_hash_table_destroy( self->private->consumers );
+
+	release_slots( self->private->slots );
 
 	g_free( self->private );
 
@@ -447,11 +480,13 @@ settings_new( void )
 		g_mkdir_with_parents( dir, 0750 );
 		st_settings->private->user = key_file_new( dir );
 		g_free( dir );
-		st_settings->private->mandatory->mandatory = FALSE;
+		st_settings->private->user->mandatory = FALSE;
 		content = content_load_keys( content, st_settings->private->user );
 
 		st_settings->private->content = g_list_copy( content );
 		g_list_free( content );
+
+		slots_load_content( st_settings->private->slots, st_settings->private->content );
 	}
 }
 
@@ -486,12 +521,24 @@ na_settings_register_key_callback( const gchar *key, GCallback callback, gpointe
 			thisfn, key, ( void * ) callback, ( void * ) user_data );
 
 	Consumer *consumer = g_new0( Consumer, 1 );
+	gpointer hash_key, consumers;
+
 	consumer->monitored_key = g_strdup( key );
 	consumer->callback = callback;
 	consumer->user_data = user_data;
 
+	/* consumers are grouped by monitored key; the list is stolen from
+	 * the hash table so that it is not released when replaced
+	 */
 	settings_new();
-	st_settings->private->consumers = g_list_prepend( st_settings->private->consumers, consumer );
+	if( g_hash_table_lookup_extended( st_settings->private->consumers, key, &hash_key, &consumers )){
+		g_hash_table_steal( st_settings->private->consumers, key );
+	} else {
+		hash_key = g_strdup( key );
+		consumers = NULL;
+	}
+	consumers = g_list_prepend(( GList * ) consumers, consumer );
+	g_hash_table_insert( st_settings->private->consumers, hash_key, consumers );
 }
 
 /**
@@ -540,6 +587,12 @@ na_settings_get_boolean_ex( const gchar *group, const gchar *key, gboolean *foun
 	gboolean value;
 	KeyValue *key_value;
 	KeyDef *key_def;
+	KeySlot *slot;
+
+	slot = peek_key_slot( group, key, found, mandatory );
+	if( slot ){
+		return( slot->boolean );
+	}
 
 	value = FALSE;
 	key_value = read_key_value( group, key, found, mandatory );
@@ -583,9 +636,15 @@ na_settings_get_string( const gchar *key, gboolean *found, gboolean *mandatory )
 	gchar *value;
 	KeyValue *key_value;
 	KeyDef *key_def;
+	KeySlot *slot;
+
+	slot = peek_key_slot( NULL, key, found, mandatory );
+	if( slot && slot->boxed ){
+		return( na_boxed_get_string( slot->boxed ));
+	}
 
 	value = NULL;
-	key_value = read_key_value( NULL, key, found, mandatory );
+	key_value = slot ? NULL : read_key_value( NULL, key, found, mandatory );
 
 	if( key_value ){
 		value = na_boxed_get_string( key_value->boxed );
@@ -626,9 +685,15 @@ na_settings_get_string_list( const gchar *key, gboolean *found, gboolean *mandat
 	GSList *value;
 	KeyValue *key_value;
 	KeyDef *key_def;
+	KeySlot *slot;
+
+	slot = peek_key_slot( NULL, key, found, mandatory );
+	if( slot && slot->boxed ){
+		return( na_boxed_get_string_list( slot->boxed ));
+	}
 
 	value = NULL;
-	key_value = read_key_value( NULL, key, found, mandatory );
+	key_value = slot ? NULL : read_key_value( NULL, key, found, mandatory );
 
 	if( key_value ){
 		value = na_boxed_get_string_list( key_value->boxed );
@@ -668,6 +733,12 @@ na_settings_get_uint( const gchar *key, gboolean *found, gboolean *mandatory )
 	guint value;
 	KeyDef *key_def;
 	KeyValue *key_value;
+	KeySlot *slot;
+
+	slot = peek_key_slot( NULL, key, found, mandatory );
+	if( slot ){
+		return( slot->uint );
+	}
 
 	value = 0;
 	key_value = read_key_value( NULL, key, found, mandatory );
@@ -711,9 +782,15 @@ na_settings_get_uint_list( const gchar *key, gboolean *found, gboolean *mandator
 	GList *value;
 	KeyDef *key_def;
 	KeyValue *key_value;
+	KeySlot *slot;
+
+	slot = peek_key_slot( NULL, key, found, mandatory );
+	if( slot && slot->boxed ){
+		return( na_boxed_get_uint_list( slot->boxed ));
+	}
 
 	value = NULL;
-	key_value = read_key_value( NULL, key, found, mandatory );
+	key_value = slot ? NULL : read_key_value( NULL, key, found, mandatory );
 
 	if( key_value ){
 		value = na_boxed_get_uint_list( key_value->boxed );
@@ -985,30 +1062,28 @@ static GList *
 content_diff( GList *old, GList *new )
 {
 	GList *diffs, *io, *in;
+	GHashTable *hold, *hnew;
 	KeyValue *kold, *knew, *kdiff;
-	gboolean found;
 
 	diffs = NULL;
+	hold = content_hash_new( old );
+	hnew = content_hash_new( new );
 
 	for( io = old ; io ; io = io->next ){
 		kold = ( KeyValue * ) io->data;
-		found = FALSE;
-		for( in = new ; in && !found ; in = in->next ){
-			knew = ( KeyValue * ) in->data;
-			if( !strcmp( kold->group, knew->group ) && ( gpointer ) kold->def == ( gpointer ) knew->def ){
-				found = TRUE;
-				if( !na_boxed_are_equal( kold->boxed, knew->boxed )){
-					/* a key has been modified */
-					kdiff = g_new0( KeyValue, 1 );
-					kdiff->group = g_strdup( knew->group );
-					kdiff->def = knew->def;
-					kdiff->mandatory = knew->mandatory;
-					kdiff->boxed = na_boxed_copy( knew->boxed );
-					diffs = g_list_prepend( diffs, kdiff );
-				}
+		knew = ( KeyValue * ) g_hash_table_lookup( hnew, kold );
+		if( knew ){
+			if( !na_boxed_are_equal( kold->boxed, knew->boxed )){
+				/* a key has been modified */
+				kdiff = g_new0( KeyValue, 1 );
+				kdiff->group = g_strdup( knew->group );
+				kdiff->def = knew->def;
+				kdiff->mandatory = knew->mandatory;
+				kdiff->boxed = na_boxed_copy( knew->boxed );
+				diffs = g_list_prepend( diffs, kdiff );
 			}
-		}
-		if( !found ){
+
+		} else {
 			/* a key has disappeared */
 			kdiff = g_new0( KeyValue, 1 );
 			kdiff->group = g_strdup( kold->group );
@@ -1021,14 +1096,7 @@ content_diff( GList *old, GList *new )
 
 	for( in = new ; in ; in = in->next ){
 		knew = ( KeyValue * ) in->data;
-		found = FALSE;
-		for( io = old ; io && !found ; io = io->next ){
-			kold = ( KeyValue * ) io->data;
-			if( !strcmp( kold->group, knew->group ) && ( gpointer ) kold->def == ( gpointer ) knew->def ){
-				found = TRUE;
-			}
-		}
-		if( !found ){
+		if( !g_hash_table_lookup( hold, knew )){
 			/* a key is new */
 			kdiff = g_new0( KeyValue, 1 );
 			kdiff->group = g_strdup( knew->group );
@@ -1039,9 +1107,31 @@ content_diff( GList *old, GList *new )
 		}
 	}
 
+	g_hash_table_destroy( hold );
+	g_hash_table_destroy( hnew );
+
 	return( diffs );
 }
 
+/*
+ * returns a new hash table which indexes the KeyValues of the content
+ * by (group,key); the KeyValues are not owned by the hash table
+ */
+static GHashTable *
+content_hash_new( GList *content )
+{
+	GHashTable *hash;
+	GList *ic;
+
+	hash = g_hash_table_new(( GHashFunc ) key_value_hash, ( GEqualFunc ) key_value_equal );
+
+	for( ic = content ; ic ; ic = ic->next ){
+		g_hash_table_insert( hash, ic->data, ic->data );
+	}
+
+	return( hash );
+}
+
 /* add the content of a configuration files to those already loaded
  *
  * when the two configuration files have been read, then the content of
@@ -1056,7 +1146,9 @@ content_load_keys( GList *content, KeyFile *keyfile )
 	gchar **groups, **ig;
 	gchar **keys, **ik;
 	KeyValue *key_value;
+	KeyValue probe;
 	KeyDef *key_def;
+	GHashTable *hash;
 
 	error = NULL;
 	if( !g_key_file_load_from_file( keyfile->key_file, keyfile->fname, G_KEY_FILE_KEEP_COMMENTS, &error )){
@@ -1069,6 +1161,7 @@ content_load_keys( GList *content, KeyFile *keyfile )
 		error = NULL;
 
 	} else {
+		hash = content_hash_new( content );
 		groups = g_key_file_get_groups( keyfile->key_file, NULL );
 		ig = groups;
 		while( *ig ){
@@ -1077,12 +1170,14 @@ content_load_keys( GList *content, KeyFile *keyfile )
 			while( *ik ){
 				key_def = get_key_def( *ik );
 				if( key_def ){
-					key_value = peek_key_value_from_content( content, *ig, *ik );
-					if( !key_value ){
+					probe.def = key_def;
+					probe.group = *ig;
+					if( !g_hash_table_lookup( hash, &probe )){
 						key_value = read_key_value_from_key_file( keyfile, *ig, *ik, key_def );
 						if( key_value ){
 							key_value->mandatory = keyfile->mandatory;
 							content = g_list_prepend( content, key_value );
+							g_hash_table_insert( hash, key_value, key_value );
 						}
 					}
 				}
@@ -1092,6 +1187,7 @@ content_load_keys( GList *content, KeyFile *keyfile )
 			ig++;
 		}
 		g_strfreev( groups );
+		g_hash_table_destroy( hash );
 	}
 
 	return( content );
@@ -1101,16 +1197,9 @@ static KeyDef *
 get_key_def( const gchar *key )
 {
 	static const gchar *thisfn = "na_settings_get_key_def";
-	KeyDef *found = NULL;
-	KeyDef *idef;
+	KeyDef *found;
 
-	idef = ( KeyDef * ) st_def_keys;
-	while( idef->key && !found ){
-		if( !strcmp( idef->key, key )){
-			found = idef;
-		}
-		idef++;
-	}
+	found = peek_key_def( key );
 	if( !found ){
 		g_warning( "%s: no KeyDef found for key=%s", thisfn, key );
 	}
@@ -1151,6 +1240,40 @@ key_file_new( const gchar *dir )
 	return( keyfile );
 }
 
+/*
+ * KeyValues are hashed by (group,key): as each key has only one KeyDef,
+ * the definition is used as a direct key
+ */
+static gboolean
+key_value_equal( const KeyValue *a, const KeyValue *b )
+{
+	return( a->def == b->def && !strcmp( a->group, b->group ));
+}
+
+static guint
+key_value_hash( const KeyValue *value )
+{
+	return( g_str_hash( value->group ) ^ g_direct_hash( value->def ));
+}
+
+static void
+notify_consumers( GList *consumers, const KeyValue *changed )
+{
+	GList *ic;
+	const Consumer *consumer;
+
+	for( ic = consumers ; ic ; ic = ic->next ){
+		consumer = ( const Consumer * ) ic->data;
+
+		( *( NASettingsKeyCallback ) consumer->callback )(
+				changed->group,
+				changed->def->key,
+				na_boxed_get_pointer( changed->boxed ),
+				changed->mandatory,
+				consumer->user_data );
+	}
+}
+
 /*
  * one of the two monitored configuration files have changed on the disk
  * we do not try to identify which keys have actually change
@@ -1173,10 +1296,8 @@ on_keyfile_changed_timeout( void )
 	static const gchar *thisfn = "na_settings_on_keyfile_changed_timeout";
 	GList *new_content;
 	GList *modifs;
-	GList *ic, *im;
+	GList *im;
 	const KeyValue *changed;
-	const Consumer *consumer;
-	gchar *group_prefix, *key;
 #ifdef NA_MAINTAINER_MODE
 	gchar *value;
 #endif
@@ -1199,33 +1320,21 @@ on_keyfile_changed_timeout( void )
 #endif
 
 	/* for each modification found,
-	 * - check if a consumer has registered for this key, and triggers callback if apply
+	 * - triggers the callback of the consumers which have registered for this key
+	 * - triggers the callback of the consumers which have registered for the
+	 *   composite io-providers read status key, if apply
 	 * - send a notification message
 	 */
 	for( im = modifs ; im ; im = im->next ){
 		changed = ( const KeyValue * ) im->data;
 
-		for( ic = st_settings->private->consumers ; ic ; ic = ic->next ){
-			consumer = ( const Consumer * ) ic->data;
-			group_prefix = NULL;
-
-			if( !strcmp( consumer->monitored_key, NA_IPREFS_IO_PROVIDERS_READ_STATUS )){
-				group_prefix = g_strdup_printf( "%s ", NA_IPREFS_IO_PROVIDER_GROUP );
-				key = NA_IPREFS_IO_PROVIDER_READABLE;
-			} else {
-				key = consumer->monitored_key;
-			}
-
-			if(( !group_prefix || g_str_has_prefix( changed->group, group_prefix )) && !strcmp( changed->def->key, key )){
-				( *( NASettingsKeyCallback ) consumer->callback )(
-						changed->group,
-						changed->def->key,
-						na_boxed_get_pointer( changed->boxed ),
-						changed->mandatory,
-						consumer->user_data );
-			}
+		notify_consumers(
+				g_hash_table_lookup( st_settings->private->consumers, changed->def->key ), changed );
 
-			g_free( group_prefix );
+		if( !strcmp( changed->def->key, NA_IPREFS_IO_PROVIDER_READABLE ) &&
+				g_str_has_prefix( changed->group, NA_IPREFS_IO_PROVIDER_GROUP " " )){
+			notify_consumers(
+					g_hash_table_lookup( st_settings->private->consumers, NA_IPREFS_IO_PROVIDERS_READ_STATUS ), changed );
 		}
 
 		g_debug( "%s: sending signal for group=%s, key=%s", thisfn, changed->group, changed->def->key );
@@ -1238,6 +1347,7 @@ on_keyfile_changed_timeout( void )
 	g_list_foreach( st_settings->private->content, ( GFunc ) release_key_value, NULL );
 	g_list_free( st_settings->private->content );
 	st_settings->private->content = new_content;
+	slots_load_content( st_settings->private->slots, new_content );
 
 	g_debug( "%s: releasing modifs", thisfn );
 	g_list_foreach( modifs, ( GFunc ) release_key_value, NULL );
@@ -1251,21 +1361,54 @@ on_key_changed_final_handler( NASettings *settings, gchar *group, gchar *key, NA
 	na_boxed_dump( new_value );
 }
 
-static KeyValue *
-peek_key_value_from_content( GList *content, const gchar *group, const gchar *key )
+/*
+ * the key definitions are hashed by key name on first call
+ */
+static KeyDef *
+peek_key_def( const gchar *key )
 {
-	KeyValue *value, *found;
-	GList *ic;
+	KeyDef *idef;
 
-	found = NULL;
-	for( ic = content ; ic && !found ; ic = ic->next ){
-		value = ( KeyValue * ) ic->data;
-		if( !strcmp( value->group, group ) && !strcmp( value->def->key, key )){
-			found = value;
+	if( !st_keys ){
+		st_keys = g_hash_table_new( g_str_hash, g_str_equal );
+		for( idef = ( KeyDef * ) st_def_keys ; idef->key ; idef++ ){
+			if( !g_hash_table_lookup( st_keys, idef->key )){
+				g_hash_table_insert( st_keys, ( gpointer ) idef->key, idef );
+			}
 		}
 	}
 
-	return( found );
+	return(( KeyDef * ) g_hash_table_lookup( st_keys, key ));
+}
+
+/*
+ * returns the slot of the snapshot which holds the value of the key in
+ * its default group, or NULL if the key is not in its default group
+ *
+ * found and mandatory are set from the slot
+ */
+static KeySlot *
+peek_key_slot( const gchar *group, const gchar *key, gboolean *found, gboolean *mandatory )
+{
+	KeyDef *key_def;
+	KeySlot *slot;
+
+	settings_new();
+	key_def = get_key_def( key );
+
+	if( !key_def || ( group && strcmp( group, key_def->group ))){
+		return( NULL );
+	}
+
+	slot = st_settings->private->slots + ( key_def - st_def_keys );
+	if( found ){
+		*found = slot->found;
+	}
+	if( mandatory ){
+		*mandatory = slot->mandatory;
+	}
+
+	return( slot );
 }
 
 /* group may be NULL
@@ -1385,6 +1528,17 @@ release_consumer( Consumer *consumer )
 	g_free( consumer );
 }
 
+/*
+ * called when the consumers hash table is destroyed
+ * release the list of consumers registered for a key
+ */
+static void
+release_consumers( GList *consumers )
+{
+	g_list_foreach( consumers, ( GFunc ) release_consumer, NULL );
+	g_list_free( consumers );
+}
+
 /*
  * called from instance_dispose
  * release the opened and monitored GKeyFiles
@@ -1416,11 +1570,68 @@ release_key_value( KeyValue *value )
 	g_free( value );
 }
 
+/*
+ * called from instance_finalize
+ * release the snapshot of the configuration
+ */
+static void
+release_slots( KeySlot *slots )
+{
+	guint i;
+
+	for( i = 0 ; i < KEY_DEF_COUNT ; ++i ){
+		if( slots[i].boxed ){
+			g_object_unref( slots[i].boxed );
+		}
+	}
+	g_free( slots );
+}
+
+/*
+ * the user configuration file may have been modified by another process
+ * since we have loaded it (e.g. by the GConf migration script, or by
+ * na-set-conf), and the file monitor may not have told us yet: reload
+ * it so that we do not overwrite these modifications when writing our
+ * own key
+ *
+ * the cached key file is kept as is if the file cannot be read
+ */
+static void
+reload_user_key_file( void )
+{
+	static const gchar *thisfn = "na_settings_reload_user_key_file";
+	GKeyFile *key_file;
+	GError *error;
+
+	error = NULL;
+	key_file = g_key_file_new();
+
+	if( !g_key_file_load_from_file( key_file, st_settings->private->user->fname, G_KEY_FILE_KEEP_COMMENTS, &error ) &&
+		error->code != G_FILE_ERROR_NOENT ){
+
+		g_warning( "%s: %s (%d) %s", thisfn, st_settings->private->user->fname, error->code, error->message );
+		g_key_file_free( key_file );
+
+	} else {
+		g_key_file_free( st_settings->private->user->key_file );
+		st_settings->private->user->key_file = key_file;
+	}
+
+	if( error ){
+		g_error_free( error );
+	}
+}
+
+/*
+ * the user value of the key is also recorded in the snapshot, unless
+ * the key is mandatory, so that it is immediately available to getters
+ */
 static gboolean
 set_key_value( const gchar *group, const gchar *key, const gchar *string )
 {
 	static const gchar *thisfn = "na_settings_set_key_value";
 	KeyDef *key_def;
+	KeySlot *slot;
 	const gchar *wgroup;
 	gboolean ok;
 	GError *error;
@@ -1428,15 +1639,14 @@ set_key_value( const gchar *group, const gchar *key, const gchar *string )
 	ok = FALSE;
 	settings_new();
 
+	key_def = group ? peek_key_def( key ) : get_key_def( key );
 	wgroup = group;
-	if( !wgroup ){
-		key_def = get_key_def( key );
-		if( key_def ){
-			wgroup = key_def->group;
-		}
+	if( !wgroup && key_def ){
+		wgroup = key_def->group;
 	}
 	if( wgroup ){
 		ok = TRUE;
+		reload_user_key_file();
 
 		if( string ){
 			g_key_file_set_string( st_settings->private->user->key_file, wgroup, key, string );
@@ -1451,11 +1661,84 @@ set_key_value( const gchar *group, const gchar *key, const gchar *string )
 		}
 
 		ok &= write_user_key_file();
+
+		if( key_def && !strcmp( wgroup, key_def->group )){
+			slot = st_settings->private->slots + ( key_def - st_def_keys );
+			if( !slot->mandatory ){
+				slot_set_value( slot, key_def, string ? na_boxed_new_from_string( key_def->type, string ) : NULL, FALSE );
+			}
+		}
 	}
 
 	return( ok );
 }
 
+/*
+ * set the value of a slot of the snapshot, decoding it when needed
+ * the slot takes ownership of the provided boxed, which may be NULL
+ * if the key has not been found
+ */
+static void
+slot_set_value( KeySlot *slot, const KeyDef *key_def, NABoxed *boxed, gboolean mandatory )
+{
+	if( slot->boxed ){
+		g_object_unref( slot->boxed );
+	}
+
+	slot->found = ( boxed != NULL );
+	slot->mandatory = boxed ? mandatory : FALSE;
+	slot->boxed = boxed;
+	slot->boolean = FALSE;
+	slot->uint = 0;
+
+	switch( key_def->type ){
+		case NA_DATA_TYPE_BOOLEAN:
+			if( boxed ){
+				slot->boolean = na_boxed_get_boolean( boxed );
+			} else if( key_def->default_value ){
+				slot->boolean = ( strcasecmp( key_def->default_value, "true" ) == 0 || atoi( key_def->default_value ) != 0 );
+			}
+			break;
+
+		case NA_DATA_TYPE_UINT:
+			if( boxed ){
+				slot->uint = na_boxed_get_uint( boxed );
+			} else if( key_def->default_value ){
+				slot->uint = atoi( key_def->default_value );
+			}
+			break;
+	}
+}
+
+/*
+ * (re)load the snapshot from the content of the configuration
+ *
+ * the content has been loaded mandatory keys first, so that a key
+ * found in the mandatory configuration has been preferred to the user one
+ */
+static void
+slots_load_content( KeySlot *slots, GList *content )
+{
+	GList *ic;
+	KeyValue *key_value;
+	KeySlot *slot;
+	guint i;
+
+	for( i = 0 ; i < KEY_DEF_COUNT ; ++i ){
+		slot_set_value( slots + i, st_def_keys + i, NULL, FALSE );
+	}
+
+	for( ic = content ; ic ; ic = ic->next ){
+		key_value = ( KeyValue * ) ic->data;
+		if( !strcmp( key_value->group, key_value->def->group )){
+			slot = slots + ( key_value->def - st_def_keys );
+			if( !slot->found ){
+				slot_set_value( slot, key_value->def, g_object_ref( key_value->boxed ), key_value->mandatory );
+			}
+		}
+	}
+}
+
 static gboolean
 write_user_key_file( void )
 {
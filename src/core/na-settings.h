@@ -95,6 +95,7 @@ G_BEGIN_DECLS
 #define NA_IPREFS_EXPORT_PREFERRED_FORMAT			"export-preferred-format"
 #define NA_IPREFS_FOLDER_CHOOSER_WSP				"folder-chooser-wsp"
 #define NA_IPREFS_FOLDER_CHOOSER_URI				"folder-chooser-lfu"
+#define NA_IPREFS_GCONF_MIGRATION_VERSION			"gconf-migration-version"
 #define NA_IPREFS_IMPORT_ASK_USER_WSP				"import-ask-user-wsp"
 #define NA_IPREFS_IMPORT_ASK_USER_LAST_MODE			"import-ask-user-last-mode"
 #define NA_IPREFS_IMPORT_ASSISTANT_WSP				"import-assistant-wsp"
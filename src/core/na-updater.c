@@ -268,20 +268,21 @@ na_updater_check_item_writability_status( const NAUpdater *updater, const NAObje
 
 		/* Writability status of the item has been determined at load time
 		 * (cf. e.g. io-desktop/nadp-reader.c:read_done_item_is_writable()).
-		 * Though I'm plenty conscious that this status is subject to many
-		 * changes during the life of the item (e.g. by modifying permissions
-		 * on the underlying store), it is just more efficient to not reevaluate
-		 * this status each time we need it, and enough for our needs..
+		 * As this status is subject to changes during the life of the item
+		 * (e.g. by modifying permissions on the underlying store), the I/O
+		 * provider is given a chance to reevaluate it - it is expected to
+		 * answer from its own cache, so that this stays cheap
 		 */
+		provider = na_object_get_provider( item );
+
 		if( writable ){
-			if( na_object_is_readonly( item )){
+			if( provider ? !na_io_provider_is_item_writable( provider, item ) : na_object_is_readonly( item )){
 				writable = FALSE;
 				reason = NA_IIO_PROVIDER_STATUS_ITEM_READONLY;
 			}
 		}
 
 		if( writable ){
-			provider = na_object_get_provider( item );
 			if( provider ){
 				writable = na_io_provider_is_finally_writable( provider, &reason );
 
@@ -423,6 +424,7 @@ na_updater_insert_item( NAUpdater *updater, NAObjectItem *item, const gchar *par
 
 		if( parent ){
 			na_object_insert_at( parent, item, pos );
+			na_pivot_index_item( NA_PIVOT( updater ), item );
 
 		} else {
 			tree = g_list_append( tree, item );
@@ -454,6 +456,9 @@ na_updater_remove_item( NAUpdater *updater, NAObject *item )
 
 		parent = na_object_get_parent( item );
 		if( parent ){
+			if( NA_IS_OBJECT_ITEM( item )){
+				na_pivot_unindex_item( NA_PIVOT( updater ), NA_OBJECT_ITEM( item ));
+			}
 			tree = na_object_get_items( parent );
 			tree = g_list_remove( tree, ( gconstpointer ) item );
 			na_object_set_items( parent, tree );
@@ -622,3 +627,68 @@ na_updater_delete_item( const NAUpdater *updater, const NAObjectItem *item, GSLi
 
 	return( ret );
 }
+
+/**
+ * na_updater_begin_batch:
+ * @updater: this #NAUpdater instance.
+ *
+ * Opens a batch of writes on all available I/O providers.
+ *
+ * Items written or deleted until na_updater_commit_batch() be called
+ * may only be staged by the I/O providers, which will flush them all
+ * together at commit time.
+ */
+void
+na_updater_begin_batch( const NAUpdater *updater )
+{
+	const GList *providers, *ip;
+
+	g_return_if_fail( NA_IS_UPDATER( updater ));
+
+	if( !updater->private->dispose_has_run ){
+
+		providers = na_io_provider_get_io_providers_list( NA_PIVOT( updater ));
+
+		for( ip = providers ; ip ; ip = ip->next ){
+			na_io_provider_begin_batch( NA_IO_PROVIDER( ip->data ));
+		}
+	}
+}
+
+/**
+ * na_updater_commit_batch:
+ * @updater: this #NAUpdater instance.
+ * @messages: the I/O providers can allocate and store here their error
+ * messages.
+ *
+ * Commits the batch of writes previously opened with
+ * na_updater_begin_batch() on all available I/O providers.
+ *
+ * Returns: %NA_IIO_PROVIDER_CODE_OK if all I/O providers have been
+ * successful, or the first error code else.
+ */
+guint
+na_updater_commit_batch( const NAUpdater *updater, GSList **messages )
+{
+	guint ret, code;
+	const GList *providers, *ip;
+
+	g_return_val_if_fail( NA_IS_UPDATER( updater ), NA_IIO_PROVIDER_CODE_PROGRAM_ERROR );
+	g_return_val_if_fail( messages, NA_IIO_PROVIDER_CODE_PROGRAM_ERROR );
+
+	ret = NA_IIO_PROVIDER_CODE_OK;
+
+	if( !updater->private->dispose_has_run ){
+
+		providers = na_io_provider_get_io_providers_list( NA_PIVOT( updater ));
+
+		for( ip = providers ; ip ; ip = ip->next ){
+			code = na_io_provider_commit_batch( NA_IO_PROVIDER( ip->data ), messages );
+			if( ret == NA_IIO_PROVIDER_CODE_OK ){
+				ret = code;
+			}
+		}
+	}
+
+	return( ret );
+}
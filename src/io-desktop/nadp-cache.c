@@ -0,0 +1,476 @@
+/*
+ * Nautilus-Actions
+ * A Nautilus extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2014 Pierre Wieser and others (see AUTHORS)
+ *
+ * Nautilus-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * Nautilus-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nautilus-Actions; see the file COPYING. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@gnome-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib/gstdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "nadp-cache.h"
+
+/* The cache file is made of:
+ * - a header: magic, version, byte-order mark;
+ * - the count of scanned directories, followed by, for each directory,
+ *   its path and its modification time (-1 if it does not exist);
+ * - the count of cached files, followed by, for each file, its path,
+ *   its modification time, its size and its content.
+ *
+ * Integers are written in host byte order; strings are written as a
+ * 32-bits length followed by the bytes and a terminating NUL, so that
+ * they may be used in place from the mapped file.
+ */
+#define CACHE_MAGIC					"NADP-CAT"
+#define CACHE_VERSION				1
+#define CACHE_BOM					0x01020304
+
+struct _NadpCacheWriter {
+	gboolean  cacheable;
+	time_t    start;
+	guint     dirs_count;
+	GString  *dirs;
+	guint     files_count;
+	GString  *files;
+};
+
+typedef struct {
+	const gchar *ptr;
+	const gchar *end;
+}
+	CacheCursor;
+
+typedef struct {
+	const gchar *path;
+	gint64       mtime;
+	guint64      size;
+	const gchar *data;
+	gsize        length;
+}
+	CacheEntry;
+
+static gchar   *get_cache_fname( void );
+static void     stat_path( const gchar *path, gint64 *mtime, guint64 *size );
+static gboolean check_header( CacheCursor *cursor );
+static gboolean check_dirs( CacheCursor *cursor, GSList *dirs );
+static gboolean check_files( CacheCursor *cursor, guint32 *count );
+static gboolean read_entry( CacheCursor *cursor, CacheEntry *entry );
+static gboolean read_uint32( CacheCursor *cursor, guint32 *value );
+static gboolean read_int64( CacheCursor *cursor, gint64 *value );
+static gboolean read_string( CacheCursor *cursor, const gchar **str, gsize *length );
+static void     append_uint32( GString *buffer, guint32 value );
+static void     append_int64( GString *buffer, gint64 value );
+static void     append_string( GString *buffer, const gchar *str, gsize length );
+
+/**
+ * nadp_cache_read:
+ * @dirs: the ordered list of scanned directories.
+ * @fn: the function to be called for each cached file.
+ * @user_data: user data to be passed to @fn.
+ *
+ * Maps the cache file, and checks that it is still valid for the given
+ * list of directories.
+ *
+ * The whole cache is validated before @fn be called for the first time,
+ * so that either all or none of the cached files are provided.
+ * The data passed to @fn is only valid during the call.
+ *
+ * Returns: %TRUE if the cache has been found valid and read,
+ * %FALSE else.
+ */
+gboolean
+nadp_cache_read( GSList *dirs, NadpCacheReadFn fn, void *user_data )
+{
+	static const gchar *thisfn = "nadp_cache_read";
+	gchar *fname;
+	GMappedFile *mapped;
+	GError *error;
+	CacheCursor cursor;
+	CacheCursor files_cursor;
+	CacheEntry entry;
+	guint32 count, i;
+	gboolean ok;
+
+	ok = FALSE;
+	error = NULL;
+	fname = get_cache_fname();
+	mapped = g_mapped_file_new( fname, FALSE, &error );
+
+	if( error ){
+		g_debug( "%s: %s", thisfn, error->message );
+		g_error_free( error );
+
+	} else {
+		cursor.ptr = g_mapped_file_get_contents( mapped );
+		cursor.end = cursor.ptr + g_mapped_file_get_length( mapped );
+
+		ok = check_header( &cursor ) && check_dirs( &cursor, dirs );
+
+		if( ok ){
+			files_cursor = cursor;
+			ok = check_files( &cursor, &count );
+		}
+
+		if( ok ){
+			read_uint32( &files_cursor, &count );
+			for( i = 0 ; i < count ; ++i ){
+				read_entry( &files_cursor, &entry );
+				( *fn )( entry.path, entry.data, entry.length, user_data );
+			}
+		}
+
+		g_debug( "%s: fname=%s, valid=%s", thisfn, fname, ok ? "True":"False" );
+		g_mapped_file_unref( mapped );
+	}
+
+	g_free( fname );
+
+	return( ok );
+}
+
+/**
+ * nadp_cache_writer_new:
+ * @dirs: the ordered list of directories which are going to be scanned.
+ *
+ * Returns: a new #NadpCacheWriter, which should be released with
+ * nadp_cache_writer_close().
+ *
+ * The modification times of the directories are recorded before they
+ * are scanned: a directory modified during the scan will so invalidate
+ * the cache at next read.
+ */
+NadpCacheWriter *
+nadp_cache_writer_new( GSList *dirs )
+{
+	NadpCacheWriter *writer;
+	GSList *id;
+	gint64 mtime;
+	guint64 size;
+
+	writer = g_new0( NadpCacheWriter, 1 );
+	writer->cacheable = TRUE;
+	writer->start = time( NULL );
+	writer->dirs = g_string_new( NULL );
+	writer->files = g_string_new( NULL );
+
+	for( id = dirs ; id ; id = id->next ){
+		stat_path(( const gchar * ) id->data, &mtime, &size );
+		append_string( writer->dirs, ( const gchar * ) id->data, strlen(( const gchar * ) id->data ));
+		append_int64( writer->dirs, mtime );
+		writer->dirs_count += 1;
+
+		if( mtime >= writer->start ){
+			writer->cacheable = FALSE;
+		}
+	}
+
+	return( writer );
+}
+
+/**
+ * nadp_cache_writer_add:
+ * @writer: this #NadpCacheWriter.
+ * @path: the full pathname of the .desktop file.
+ * @data: the content of the file, or %NULL if it has not been read.
+ * @length: the length of @data.
+ *
+ * Records the file in the cache.
+ *
+ * Files must be added in the order of preference, and even if they
+ * are not valid .desktop files, as they shadow the same identifier
+ * in less preferred directories.
+ *
+ * A file which cannot be read makes the cache not cacheable, as it
+ * could become readable without its directory being modified.
+ */
+void
+nadp_cache_writer_add( NadpCacheWriter *writer, const gchar *path, const gchar *data, gsize length )
+{
+	gint64 mtime;
+	guint64 size;
+
+	g_return_if_fail( writer );
+
+	if( writer->cacheable ){
+
+		if( !data || length > G_MAXUINT32 ){
+			writer->cacheable = FALSE;
+
+		} else {
+			stat_path( path, &mtime, &size );
+
+			/* a file modified in the same second that the scan started may
+			 * have been read before the modification, with a same mtime
+			 * than the one we have just got
+			 */
+			if( mtime < 0 || mtime >= writer->start || size != length ){
+				writer->cacheable = FALSE;
+
+			} else {
+				append_string( writer->files, path, strlen( path ));
+				append_int64( writer->files, mtime );
+				append_int64( writer->files, ( gint64 ) size );
+				append_string( writer->files, data, length );
+				writer->files_count += 1;
+			}
+		}
+	}
+}
+
+/**
+ * nadp_cache_writer_close:
+ * @writer: this #NadpCacheWriter.
+ *
+ * Writes the cache file if all recorded informations were cacheable,
+ * then releases the @writer.
+ */
+void
+nadp_cache_writer_close( NadpCacheWriter *writer )
+{
+	static const gchar *thisfn = "nadp_cache_writer_close";
+	gchar *fname;
+	gchar *dirname;
+	GString *buffer;
+	GError *error;
+
+	g_return_if_fail( writer );
+
+	g_debug( "%s: writer=%p, cacheable=%s, dirs=%u, files=%u",
+			thisfn, ( void * ) writer, writer->cacheable ? "True":"False", writer->dirs_count, writer->files_count );
+
+	if( writer->cacheable ){
+		buffer = g_string_sized_new( 32 + writer->dirs->len + writer->files->len );
+		g_string_append_len( buffer, CACHE_MAGIC, strlen( CACHE_MAGIC ));
+		append_uint32( buffer, CACHE_VERSION );
+		append_uint32( buffer, CACHE_BOM );
+		append_uint32( buffer, writer->dirs_count );
+		g_string_append_len( buffer, writer->dirs->str, writer->dirs->len );
+		append_uint32( buffer, writer->files_count );
+		g_string_append_len( buffer, writer->files->str, writer->files->len );
+
+		fname = get_cache_fname();
+		dirname = g_path_get_dirname( fname );
+		g_mkdir_with_parents( dirname, 0700 );
+		g_free( dirname );
+
+		error = NULL;
+		if( !g_file_set_contents( fname, buffer->str, buffer->len, &error )){
+			g_warning( "%s: %s: %s", thisfn, fname, error->message );
+			g_error_free( error );
+		}
+
+		g_free( fname );
+		g_string_free( buffer, TRUE );
+	}
+
+	g_string_free( writer->dirs, TRUE );
+	g_string_free( writer->files, TRUE );
+	g_free( writer );
+}
+
+static gchar *
+get_cache_fname( void )
+{
+	return( g_build_filename( g_get_user_cache_dir(), PACKAGE, PROVIDER_ID ".cache", NULL ));
+}
+
+/*
+ * mtime is set to -1 if the path does not exist
+ */
+static void
+stat_path( const gchar *path, gint64 *mtime, guint64 *size )
+{
+	GStatBuf buf;
+
+	if( g_stat( path, &buf ) == 0 ){
+		*mtime = ( gint64 ) buf.st_mtime;
+		*size = ( guint64 ) buf.st_size;
+
+	} else {
+		*mtime = -1;
+		*size = 0;
+	}
+}
+
+static gboolean
+check_header( CacheCursor *cursor )
+{
+	guint32 version, bom;
+	gsize len;
+
+	len = strlen( CACHE_MAGIC );
+	if(( gsize )( cursor->end - cursor->ptr ) < len || memcmp( cursor->ptr, CACHE_MAGIC, len )){
+		return( FALSE );
+	}
+	cursor->ptr += len;
+
+	return( read_uint32( cursor, &version ) && version == CACHE_VERSION &&
+			read_uint32( cursor, &bom ) && bom == CACHE_BOM );
+}
+
+/*
+ * the list of directories must be exactly the same, in the same order,
+ * with the same modification times
+ */
+static gboolean
+check_dirs( CacheCursor *cursor, GSList *dirs )
+{
+	guint32 count, i;
+	const gchar *path;
+	gsize length;
+	gint64 cached_mtime, mtime;
+	guint64 size;
+	GSList *id;
+
+	if( !read_uint32( cursor, &count ) || count != g_slist_length( dirs )){
+		return( FALSE );
+	}
+
+	for( i = 0, id = dirs ; i < count ; ++i, id = id->next ){
+		if( !read_string( cursor, &path, &length ) || !read_int64( cursor, &cached_mtime )){
+			return( FALSE );
+		}
+		if( strcmp( path, ( const gchar * ) id->data )){
+			return( FALSE );
+		}
+		stat_path( path, &mtime, &size );
+		if( mtime != cached_mtime ){
+			return( FALSE );
+		}
+	}
+
+	return( TRUE );
+}
+
+/*
+ * files may have been modified in place, without their directory being
+ * modified: check them all before actually using the cache
+ */
+static gboolean
+check_files( CacheCursor *cursor, guint32 *count )
+{
+	guint32 i;
+	CacheEntry entry;
+	gint64 mtime;
+	guint64 size;
+
+	if( !read_uint32( cursor, count )){
+		return( FALSE );
+	}
+
+	for( i = 0 ; i < *count ; ++i ){
+		if( !read_entry( cursor, &entry )){
+			return( FALSE );
+		}
+		stat_path( entry.path, &mtime, &size );
+		if( mtime != entry.mtime || size != entry.size ){
+			return( FALSE );
+		}
+	}
+
+	return( TRUE );
+}
+
+static gboolean
+read_entry( CacheCursor *cursor, CacheEntry *entry )
+{
+	gsize length;
+	gint64 size;
+
+	if( !read_string( cursor, &entry->path, &length ) ||
+		!read_int64( cursor, &entry->mtime ) ||
+		!read_int64( cursor, &size ) ||
+		!read_string( cursor, &entry->data, &entry->length )){
+			return( FALSE );
+	}
+
+	entry->size = ( guint64 ) size;
+
+	return( TRUE );
+}
+
+static gboolean
+read_uint32( CacheCursor *cursor, guint32 *value )
+{
+	if(( gsize )( cursor->end - cursor->ptr ) < sizeof( guint32 )){
+		return( FALSE );
+	}
+	memcpy( value, cursor->ptr, sizeof( guint32 ));
+	cursor->ptr += sizeof( guint32 );
+
+	return( TRUE );
+}
+
+static gboolean
+read_int64( CacheCursor *cursor, gint64 *value )
+{
+	if(( gsize )( cursor->end - cursor->ptr ) < sizeof( gint64 )){
+		return( FALSE );
+	}
+	memcpy( value, cursor->ptr, sizeof( gint64 ));
+	cursor->ptr += sizeof( gint64 );
+
+	return( TRUE );
+}
+
+static gboolean
+read_string( CacheCursor *cursor, const gchar **str, gsize *length )
+{
+	guint32 len;
+
+	if( !read_uint32( cursor, &len ) || ( gsize )( cursor->end - cursor->ptr ) <= len || cursor->ptr[len] != '\0' ){
+		return( FALSE );
+	}
+	*str = cursor->ptr;
+	*length = len;
+	cursor->ptr += len+1;
+
+	return( TRUE );
+}
+
+static void
+append_uint32( GString *buffer, guint32 value )
+{
+	g_string_append_len( buffer, ( const gchar * ) &value, sizeof( guint32 ));
+}
+
+static void
+append_int64( GString *buffer, gint64 value )
+{
+	g_string_append_len( buffer, ( const gchar * ) &value, sizeof( gint64 ));
+}
+
+static void
+append_string( GString *buffer, const gchar *str, gsize length )
+{
+	append_uint32( buffer, ( guint32 ) length );
+	g_string_append_len( buffer, str, length );
+	g_string_append_c( buffer, '\0' );
+}
@@ -0,0 +1,70 @@
+/*
+ * Nautilus-Actions
+ * A Nautilus extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2014 Pierre Wieser and others (see AUTHORS)
+ *
+ * Nautilus-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * Nautilus-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nautilus-Actions; see the file COPYING. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@gnome-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifndef __NADP_CACHE_H__
+#define __NADP_CACHE_H__
+
+/**
+ * SECTION: nadp_cache
+ * @short_description: Desktop files content cache.
+ * @include: nadp-cache.h
+ *
+ * The content cache is a single binary file which holds the raw content
+ * of every .desktop file found in the scanned directories, in the order
+ * of preference in which they have been found. It is memory-mapped when
+ * loading the items, and validated against the modification times of
+ * the scanned directories and of the cached files, so that a cold start
+ * does not need to list the directories nor to open each file.
+ *
+ * This is not a compiled catalog: each cached file still has to be
+ * stat()'ed to validate the cache, and its content is still parsed when
+ * building the items.
+ *
+ * The cache is automatically rebuilt each time it is found invalid.
+ * Removing the file from the user cache directory just forces it to be
+ * rebuilt at next load.
+ */
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _NadpCacheWriter NadpCacheWriter;
+
+typedef void ( *NadpCacheReadFn )( const gchar *path, const gchar *data, gsize length, void *user_data );
+
+gboolean         nadp_cache_read        ( GSList *dirs, NadpCacheReadFn fn, void *user_data );
+
+NadpCacheWriter *nadp_cache_writer_new  ( GSList *dirs );
+void             nadp_cache_writer_add  ( NadpCacheWriter *writer, const gchar *path, const gchar *data, gsize length );
+void             nadp_cache_writer_close( NadpCacheWriter *writer );
+
+G_END_DECLS
+
+#endif /* __NADP_CACHE_H__ */
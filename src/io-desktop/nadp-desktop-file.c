@@ -31,14 +31,21 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 
 #include <api/na-core-utils.h>
 
 #include "nadp-desktop-file.h"
 #include "nadp-keys.h"
+#include "nadp-parser.h"
 
 /* private class data
  */
@@ -49,11 +56,16 @@ struct _NadpDesktopFileClassPrivate {
 /* private instance data
  */
 struct _NadpDesktopFilePrivate {
-	gboolean   dispose_has_run;
-	gchar     *id;
-	gchar     *uri;
-	gchar     *type;
-	GKeyFile  *key_file;
+	gboolean        dispose_has_run;
+	gchar          *id;
+	gchar          *uri;
+	gchar          *type;
+	GKeyFile       *key_file;
+	NadpParser     *parser;
+	gboolean        dirty;
+	gchar          *staged;
+	gchar          *staged_target;
+	gboolean        staged_in_place;
 };
 
 static GObjectClass *st_parent_class = NULL;
@@ -69,6 +81,26 @@ static gchar           *path2id( const gchar *path );
 static gchar           *uri2id( const gchar *uri );
 static gboolean         check_key_file( NadpDesktopFile *ndf );
 static void             remove_encoding_part( NadpDesktopFile *ndf );
+static void             release_parser( NadpDesktopFile *ndf );
+static void             set_dirty_if_changed( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, gchar *previous );
+static gboolean         write_temp_file( NadpDesktopFile *ndf, const gchar *path, gboolean sync );
+static gchar           *resolve_target( const gchar *path );
+static gboolean         write_fd( gint fd, const gchar *data, gsize length, const gchar *fname );
+static gboolean         rename_temp_file( NadpDesktopFile *ndf, gchar **dir );
+static gboolean         copy_temp_file( NadpDesktopFile *ndf );
+static void             discard_temp_file( NadpDesktopFile *ndf );
+static gboolean         sync_path( const gchar *path, gboolean is_dir );
+static gboolean         replace_uri( NadpDesktopFile *ndf );
+
+static gboolean         ndf_has_group( const NadpDesktopFile *ndf, const gchar *group );
+static gboolean         ndf_has_key( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error );
+static gchar           *ndf_get_start_group( const NadpDesktopFile *ndf );
+static gchar          **ndf_get_groups( const NadpDesktopFile *ndf );
+static gboolean         ndf_get_boolean( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error );
+static gint             ndf_get_integer( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error );
+static gchar           *ndf_get_locale_string( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error );
+static gchar           *ndf_get_string( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error );
+static gchar          **ndf_get_string_list( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error );
 
 GType
 nadp_desktop_file_get_type( void )
@@ -139,6 +171,11 @@ instance_init( GTypeInstance *instance, gpointer klass )
 
 	self->private->dispose_has_run = FALSE;
 	self->private->key_file = g_key_file_new();
+	self->private->parser = NULL;
+	self->private->dirty = FALSE;
+	self->private->staged = NULL;
+	self->private->staged_target = NULL;
+	self->private->staged_in_place = FALSE;
 }
 
 static void
@@ -184,6 +221,9 @@ instance_finalize( GObject *object )
 		g_key_file_free( self->private->key_file );
 	}
 
+	release_parser( self );
+	discard_temp_file( self );
+
 	g_free( self->private );
 
 	/* chain call to parent class */
@@ -256,6 +296,71 @@ nadp_desktop_file_new_from_path( const gchar *path )
 	return( ndf );
 }
 
+/**
+ * nadp_desktop_file_new_from_data:
+ * @path: the full pathname of the .desktop file.
+ * @data: the content of the file.
+ * @length: the length of @data.
+ *
+ * Retuns: a newly allocated #NadpDesktopFile object, or %NULL.
+ *
+ * The content of the file has been tokenized in place, and first
+ * validity checks made. This is used when the content of the file has
+ * already been read, e.g. from the content cache.
+ *
+ * As the items are most often only displayed, no key file is built:
+ * values are read from the parser, which only keeps the translations
+ * of the current locale. @data is no more used when the function
+ * returns.
+ *
+ * nadp_desktop_file_load_full() must be called before the key file be
+ * updated.
+ */
+NadpDesktopFile *
+nadp_desktop_file_new_from_data( const gchar *path, const gchar *data, gsize length )
+{
+	static const gchar *thisfn = "nadp_desktop_file_new_from_data";
+	NadpDesktopFile *ndf;
+	GError *error;
+	gchar *uri;
+
+	ndf = NULL;
+	g_debug( "%s: path=%s, length=%lu", thisfn, path, ( unsigned long ) length );
+	g_return_val_if_fail( path && g_utf8_strlen( path, -1 ) && g_path_is_absolute( path ), ndf );
+	g_return_val_if_fail( data, ndf );
+
+	error = NULL;
+	uri = g_filename_to_uri( path, NULL, &error );
+	if( !uri || error ){
+		g_warning( "%s: %s: %s", thisfn, path, error->message );
+		g_error_free( error );
+		g_free( uri );
+		return( NULL );
+	}
+
+	ndf = ndf_new( uri );
+
+	g_free( uri );
+
+	g_key_file_free( ndf->private->key_file );
+	ndf->private->key_file = NULL;
+
+	ndf->private->parser = nadp_parser_new( data, length, &error );
+	if( error ){
+		g_warning( "%s: %s: %s", thisfn, path, error->message );
+		g_error_free( error );
+		g_object_unref( ndf );
+		return( NULL );
+	}
+
+	if( !check_key_file( ndf )){
+		g_object_unref( ndf );
+		return( NULL );
+	}
+
+	return( ndf );
+}
+
 /**
  * nadp_desktop_file_new_from_uri:
  * @uri: the URI the desktop file should be loaded from.
@@ -273,7 +378,6 @@ nadp_desktop_file_new_from_uri( const gchar *uri )
 {
 	static const gchar *thisfn = "nadp_desktop_file_new_from_uri";
 	NadpDesktopFile *ndf;
-	GError *error;
 	gchar *data;
 	gsize length;
 
@@ -290,13 +394,44 @@ nadp_desktop_file_new_from_uri( const gchar *uri )
 	/* normally, length and data should be both NULL or both not NULL
 	 */
 	if( !length || !data ){
+		g_free( data );
 		return( NULL );
 	}
 
+	ndf = nadp_desktop_file_new_from_uri_data( uri, data, length );
+	g_free( data );
+
+	return( ndf );
+}
+
+/**
+ * nadp_desktop_file_new_from_uri_data:
+ * @uri: the URI the desktop file has been read from.
+ * @data: the content of the file.
+ * @length: the length of @data.
+ *
+ * Retuns: a newly allocated #NadpDesktopFile object, or %NULL.
+ *
+ * Key file has been loaded from @data, and first validity checks made.
+ * Contrarily to nadp_desktop_file_new_from_data(), @data is no more
+ * used when the function returns.
+ *
+ * As for nadp_desktop_file_new_from_uri(), do not warns when the
+ * content is malformed.
+ */
+NadpDesktopFile *
+nadp_desktop_file_new_from_uri_data( const gchar *uri, const gchar *data, gsize length )
+{
+	static const gchar *thisfn = "nadp_desktop_file_new_from_uri_data";
+	NadpDesktopFile *ndf;
+	GError *error;
+
+	g_return_val_if_fail( uri && g_utf8_strlen( uri, -1 ), NULL );
+	g_return_val_if_fail( data && length, NULL );
+
 	error = NULL;
 	ndf = ndf_new( uri );
 	g_key_file_load_from_data( ndf->private->key_file, data, length, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, &error );
-	g_free( data );
 
 	if( error ){
 		if( error->code != G_KEY_FILE_ERROR_GROUP_NOT_FOUND ){
@@ -346,9 +481,80 @@ nadp_desktop_file_new_for_write( const gchar *path )
 
 	g_free( uri );
 
+	/* the file has to be created even if no key is ever set */
+	ndf->private->dirty = TRUE;
+
 	return( ndf );
 }
 
+/**
+ * nadp_desktop_file_load_full:
+ * @ndf: the #NadpDesktopFile instance.
+ *
+ * Loads the key file with all its comments and translations, if the
+ * file has only been tokenized for reading, so that nothing be lost
+ * when it will be written.
+ *
+ * Returns: %TRUE if the key file is fully loaded, %FALSE else.
+ */
+gboolean
+nadp_desktop_file_load_full( NadpDesktopFile *ndf )
+{
+	static const gchar *thisfn = "nadp_desktop_file_load_full";
+	gboolean loaded;
+	gchar *path;
+	GKeyFile *key_file;
+	GError *error;
+
+	g_return_val_if_fail( NADP_IS_DESKTOP_FILE( ndf ), FALSE );
+
+	loaded = FALSE;
+
+	if( !ndf->private->dispose_has_run ){
+
+		loaded = ( ndf->private->parser == NULL );
+
+		if( !loaded ){
+			g_debug( "%s: uri=%s", thisfn, ndf->private->uri );
+			error = NULL;
+			path = g_filename_from_uri( ndf->private->uri, NULL, &error );
+
+			if( path ){
+				key_file = g_key_file_new();
+				g_key_file_load_from_file( key_file, path, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, &error );
+
+				/* if the file has been removed meanwhile, there is nothing
+				 * left to be preserved
+				 */
+				if( error && error->domain == G_FILE_ERROR && error->code == G_FILE_ERROR_NOENT ){
+					g_key_file_free( key_file );
+					key_file = g_key_file_new();
+					g_error_free( error );
+					error = NULL;
+					ndf->private->dirty = TRUE;
+				}
+
+				if( !error ){
+					ndf->private->key_file = key_file;
+					release_parser( ndf );
+					loaded = TRUE;
+
+				} else {
+					g_key_file_free( key_file );
+				}
+				g_free( path );
+			}
+
+			if( error ){
+				g_warning( "%s: %s: %s", thisfn, ndf->private->uri, error->message );
+				g_error_free( error );
+			}
+		}
+	}
+
+	return( loaded );
+}
+
 /**
  * nadp_desktop_file_get_key_file:
  * @ndf: the #NadpDesktopFile instance.
@@ -457,8 +663,8 @@ check_key_file( NadpDesktopFile *ndf )
 	error = NULL;
 
 	/* start group must be [Desktop Entry] */
-	start_group = g_key_file_get_start_group( ndf->private->key_file );
-	if( strcmp( start_group, NADP_GROUP_DESKTOP )){
+	start_group = ndf_get_start_group( ndf );
+	if( !start_group || strcmp( start_group, NADP_GROUP_DESKTOP )){
 		g_debug( "%s: %s: invalid start group, found %s, waited for %s",
 				thisfn, ndf->private->uri, start_group, NADP_GROUP_DESKTOP );
 		ret = FALSE;
@@ -466,13 +672,13 @@ check_key_file( NadpDesktopFile *ndf )
 
 	/* must not have Hidden=true value */
 	if( ret ){
-		has_key = g_key_file_has_key( ndf->private->key_file, start_group, NADP_KEY_HIDDEN, &error );
+		has_key = ndf_has_key( ndf, start_group, NADP_KEY_HIDDEN, &error );
 		if( error ){
 			g_debug( "%s: %s: %s", thisfn, ndf->private->uri, error->message );
 			ret = FALSE;
 
 		} else if( has_key ){
-			hidden = g_key_file_get_boolean( ndf->private->key_file, start_group, NADP_KEY_HIDDEN, &error );
+			hidden = ndf_get_boolean( ndf, start_group, NADP_KEY_HIDDEN, &error );
 			if( error ){
 				g_debug( "%s: %s: %s", thisfn, ndf->private->uri, error->message );
 				ret = FALSE;
@@ -489,14 +695,14 @@ check_key_file( NadpDesktopFile *ndf )
 	 */
 	if( ret ){
 		type = NULL;
-		has_key = g_key_file_has_key( ndf->private->key_file, start_group, NADP_KEY_TYPE, &error );
+		has_key = ndf_has_key( ndf, start_group, NADP_KEY_TYPE, &error );
 		if( error ){
 			g_debug( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 			ret = FALSE;
 
 		} else if( has_key ){
-			type = g_key_file_get_string( ndf->private->key_file, start_group, NADP_KEY_TYPE, &error );
+			type = ndf_get_string( ndf, start_group, NADP_KEY_TYPE, &error );
 			if( error ){
 				g_debug( "%s: %s", thisfn, error->message );
 				g_free( type );
@@ -597,7 +803,7 @@ nadp_desktop_file_get_profiles( const NadpDesktopFile *ndf )
 
 	if( !ndf->private->dispose_has_run ){
 
-		groups = g_key_file_get_groups( ndf->private->key_file, NULL );
+		groups = ndf_get_groups( ndf );
 		if( groups ){
 			ig = groups;
 			profile_pfx = g_strdup_printf( "%s ", NADP_GROUP_PROFILE );
@@ -644,7 +850,7 @@ nadp_desktop_file_has_profile( const NadpDesktopFile *ndf, const gchar *profile_
 	if( !ndf->private->dispose_has_run ){
 
 		group_name = g_strdup_printf( "%s %s", NADP_GROUP_PROFILE, profile_id );
-		has_profile = g_key_file_has_group( ndf->private->key_file, group_name );
+		has_profile = ndf_has_group( ndf, group_name );
 		g_free( group_name );
 	}
 
@@ -678,14 +884,18 @@ nadp_desktop_file_remove_key( const NadpDesktopFile *ndf, const gchar *group, co
 
 	if( !ndf->private->dispose_has_run ){
 
-		g_key_file_remove_key( ndf->private->key_file, group, key, NULL );
+		if( g_key_file_remove_key( ndf->private->key_file, group, key, NULL )){
+			ndf->private->dirty = TRUE;
+		}
 
 		locales = ( char ** ) g_get_language_names();
 		iloc = locales;
 
 		while( *iloc ){
 			locale_key = g_strdup_printf( "%s[%s]", key, *iloc );
-			g_key_file_remove_key( ndf->private->key_file, group, locale_key, NULL );
+			if( g_key_file_remove_key( ndf->private->key_file, group, locale_key, NULL )){
+				ndf->private->dirty = TRUE;
+			}
 			g_free( locale_key );
 			iloc++;
 		}
@@ -709,7 +919,9 @@ nadp_desktop_file_remove_profile( const NadpDesktopFile *ndf, const gchar *profi
 	if( !ndf->private->dispose_has_run ){
 
 		group_name = g_strdup_printf( "%s %s", NADP_GROUP_PROFILE, profile_id );
-		g_key_file_remove_group( ndf->private->key_file, group_name, NULL );
+		if( g_key_file_remove_group( ndf->private->key_file, group_name, NULL )){
+			ndf->private->dirty = TRUE;
+		}
 		g_free( group_name );
 	}
 }
@@ -742,13 +954,13 @@ nadp_desktop_file_get_boolean( const NadpDesktopFile *ndf, const gchar *group, c
 	if( !ndf->private->dispose_has_run ){
 
 		error = NULL;
-		has_entry = g_key_file_has_key( ndf->private->key_file, group, entry, &error );
+		has_entry = ndf_has_key( ndf, group, entry, &error );
 		if( error ){
 			g_warning( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 
 		} else if( has_entry ){
-			read_value = g_key_file_get_boolean( ndf->private->key_file, group, entry, &error );
+			read_value = ndf_get_boolean( ndf, group, entry, &error );
 			if( error ){
 				g_warning( "%s: %s", thisfn, error->message );
 				g_error_free( error );
@@ -791,7 +1003,7 @@ nadp_desktop_file_get_locale_string( const NadpDesktopFile *ndf, const gchar *gr
 
 		error = NULL;
 
-		read_value = g_key_file_get_locale_string( ndf->private->key_file, group, entry, NULL, &error );
+		read_value = ndf_get_locale_string( ndf, group, entry, &error );
 		if( !read_value || error ){
 			if( error->code != G_KEY_FILE_ERROR_KEY_NOT_FOUND ){
 				g_warning( "%s: %s", thisfn, error->message );
@@ -837,13 +1049,13 @@ nadp_desktop_file_get_string( const NadpDesktopFile *ndf, const gchar *group, co
 	if( !ndf->private->dispose_has_run ){
 
 		error = NULL;
-		has_entry = g_key_file_has_key( ndf->private->key_file, group, entry, &error );
+		has_entry = ndf_has_key( ndf, group, entry, &error );
 		if( error ){
 			g_warning( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 
 		} else if( has_entry ){
-			read_value = g_key_file_get_string( ndf->private->key_file, group, entry, &error );
+			read_value = ndf_get_string( ndf, group, entry, &error );
 			if( error ){
 				g_warning( "%s: %s", thisfn, error->message );
 				g_error_free( error );
@@ -888,13 +1100,13 @@ nadp_desktop_file_get_string_list( const NadpDesktopFile *ndf, const gchar *grou
 	if( !ndf->private->dispose_has_run ){
 
 		error = NULL;
-		has_entry = g_key_file_has_key( ndf->private->key_file, group, entry, &error );
+		has_entry = ndf_has_key( ndf, group, entry, &error );
 		if( error ){
 			g_warning( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 
 		} else if( has_entry ){
-			read_array = g_key_file_get_string_list( ndf->private->key_file, group, entry, NULL, &error );
+			read_array = ndf_get_string_list( ndf, group, entry, &error );
 			if( error ){
 				g_warning( "%s: %s", thisfn, error->message );
 				g_error_free( error );
@@ -939,13 +1151,13 @@ nadp_desktop_file_get_uint( const NadpDesktopFile *ndf, const gchar *group, cons
 	if( !ndf->private->dispose_has_run ){
 
 		error = NULL;
-		has_entry = g_key_file_has_key( ndf->private->key_file, group, entry, &error );
+		has_entry = ndf_has_key( ndf, group, entry, &error );
 		if( error ){
 			g_warning( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 
 		} else if( has_entry ){
-			value = ( guint ) g_key_file_get_integer( ndf->private->key_file, group, entry, &error );
+			value = ( guint ) ndf_get_integer( ndf, group, entry, &error );
 			if( error ){
 				g_warning( "%s: %s", thisfn, error->message );
 				g_error_free( error );
@@ -971,11 +1183,15 @@ nadp_desktop_file_get_uint( const NadpDesktopFile *ndf, const gchar *group, cons
 void
 nadp_desktop_file_set_boolean( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, gboolean value )
 {
+	gchar *previous;
+
 	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
 
 	if( !ndf->private->dispose_has_run ){
 
+		previous = g_key_file_get_value( ndf->private->key_file, group, key, NULL );
 		g_key_file_set_boolean( ndf->private->key_file, group, key, value );
+		set_dirty_if_changed( ndf, group, key, previous );
 	}
 }
 
@@ -1016,6 +1232,8 @@ nadp_desktop_file_set_locale_string( const NadpDesktopFile *ndf, const gchar *gr
 	guint i;
 	gchar *prefix;
 	gboolean write;
+	gchar *locale_key;
+	gchar *previous;
 
 	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
 
@@ -1065,7 +1283,11 @@ nadp_desktop_file_set_locale_string( const NadpDesktopFile *ndf, const gchar *gr
 			}
 
 			if( write ){
+				locale_key = g_strdup_printf( "%s[%s]", key, locales[i] );
+				previous = g_key_file_get_value( ndf->private->key_file, group, locale_key, NULL );
 				g_key_file_set_locale_string( ndf->private->key_file, group, key, locales[i], value );
+				set_dirty_if_changed( ndf, group, locale_key, previous );
+				g_free( locale_key );
 			}
 		}
 
@@ -1085,11 +1307,15 @@ nadp_desktop_file_set_locale_string( const NadpDesktopFile *ndf, const gchar *gr
 void
 nadp_desktop_file_set_string( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, const gchar *value )
 {
+	gchar *previous;
+
 	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
 
 	if( !ndf->private->dispose_has_run ){
 
+		previous = g_key_file_get_value( ndf->private->key_file, group, key, NULL );
 		g_key_file_set_string( ndf->private->key_file, group, key, value );
+		set_dirty_if_changed( ndf, group, key, previous );
 	}
 }
 
@@ -1106,14 +1332,17 @@ void
 nadp_desktop_file_set_string_list( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GSList *value )
 {
 	gchar **array;
+	gchar *previous;
 
 	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
 
 	if( !ndf->private->dispose_has_run ){
 
+		previous = g_key_file_get_value( ndf->private->key_file, group, key, NULL );
 		array = na_core_utils_slist_to_array( value );
 		g_key_file_set_string_list( ndf->private->key_file, group, key, ( const gchar * const * ) array, g_slist_length( value ));
 		g_strfreev( array );
+		set_dirty_if_changed( ndf, group, key, previous );
 	}
 }
 
@@ -1129,14 +1358,42 @@ nadp_desktop_file_set_string_list( const NadpDesktopFile *ndf, const gchar *grou
 void
 nadp_desktop_file_set_uint( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, guint value )
 {
+	gchar *previous;
+
 	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
 
 	if( !ndf->private->dispose_has_run ){
 
+		previous = g_key_file_get_value( ndf->private->key_file, group, key, NULL );
 		g_key_file_set_integer( ndf->private->key_file, group, key, value );
+		set_dirty_if_changed( ndf, group, key, previous );
 	}
 }
 
+/**
+ * nadp_desktop_file_is_dirty:
+ * @ndf: the #NadpDesktopFile instance.
+ *
+ * Returns: %TRUE if the key file has been modified since it has been
+ * loaded or last written, %FALSE else.
+ */
+gboolean
+nadp_desktop_file_is_dirty( const NadpDesktopFile *ndf )
+{
+	gboolean dirty;
+
+	g_return_val_if_fail( NADP_IS_DESKTOP_FILE( ndf ), FALSE );
+
+	dirty = FALSE;
+
+	if( !ndf->private->dispose_has_run ){
+
+		dirty = ndf->private->dirty;
+	}
+
+	return( dirty );
+}
+
 /**
  * nadp_desktop_file_write:
  * @ndf: the #NadpDesktopFile instance.
@@ -1148,20 +1405,21 @@ nadp_desktop_file_set_uint( const NadpDesktopFile *ndf, const gchar *group, cons
  * Starting with v 3.0.4, locale strings whose identifier include an
  * encoding part are removed from the desktop file when rewriting it
  * (these were wrongly written between v 2.99 and 3.0.3).
+ *
+ * Starting with v 3.2, the file is not rewritten at all if none of its
+ * keys has actually been modified. Local files are written to a
+ * temporary file which is synced, then renamed over the target, so that
+ * a crash never leaves a truncated .desktop file behind.
  */
 gboolean
 nadp_desktop_file_write( NadpDesktopFile *ndf )
 {
 	static const gchar *thisfn = "nadp_desktop_file_write";
 	gboolean ret;
-	gchar *data;
-	GFile *file;
-	GFileOutputStream *stream;
-	GError *error;
-	gsize length;
+	gchar *path;
+	gchar *dir;
 
 	ret = FALSE;
-	error = NULL;
 	g_return_val_if_fail( NADP_IS_DESKTOP_FILE( ndf ), ret );
 
 	if( !ndf->private->dispose_has_run ){
@@ -1170,50 +1428,157 @@ nadp_desktop_file_write( NadpDesktopFile *ndf )
 			remove_encoding_part( ndf );
 		}
 
-		data = g_key_file_to_data( ndf->private->key_file, &length, NULL );
-		file = g_file_new_for_uri( ndf->private->uri );
+		if( !ndf->private->dirty ){
+			g_debug( "%s: uri=%s: unchanged, not written", thisfn, ndf->private->uri );
+			return( TRUE );
+		}
+
 		g_debug( "%s: uri=%s", thisfn, ndf->private->uri );
+		path = g_filename_from_uri( ndf->private->uri, NULL, NULL );
 
-		stream = g_file_replace( file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &error );
-		if( error ){
-			g_warning( "%s: g_file_replace: %s", thisfn, error->message );
-			g_error_free( error );
-			if( stream ){
-				g_object_unref( stream );
+		if( path ){
+			ret = write_temp_file( ndf, path, TRUE ) && rename_temp_file( ndf, &dir );
+			if( ret ){
+				sync_path( dir, TRUE );
+				g_free( dir );
 			}
-			g_object_unref( file );
-			g_free( data );
-			return( FALSE );
+			g_free( path );
+
+		} else {
+			ret = replace_uri( ndf );
 		}
+	}
 
-		g_output_stream_write( G_OUTPUT_STREAM( stream ), data, length, NULL, &error );
-		if( error ){
-			g_warning( "%s: g_output_stream_write: %s", thisfn, error->message );
-			g_error_free( error );
-			g_object_unref( stream );
-			g_object_unref( file );
-			g_free( data );
-			return( FALSE );
+	return( ret );
+}
+
+/**
+ * nadp_desktop_file_stage:
+ * @ndf: the #NadpDesktopFile instance.
+ *
+ * Writes the key file to a temporary file besides of the target, without
+ * syncing it to the disk. The file only takes place of the target when
+ * nadp_desktop_file_commit_staged() is called.
+ *
+ * This let a caller which has many files to write pay for only one
+ * synchronization pass at the end.
+ *
+ * A key file which has not been modified is not staged at all; nor is a
+ * file which is not local, which is directly written instead.
+ *
+ * Returns: %TRUE if write is ok, %FALSE else.
+ */
+gboolean
+nadp_desktop_file_stage( NadpDesktopFile *ndf )
+{
+	static const gchar *thisfn = "nadp_desktop_file_stage";
+	gboolean ret;
+	gchar *path;
+
+	ret = FALSE;
+	g_return_val_if_fail( NADP_IS_DESKTOP_FILE( ndf ), ret );
+
+	if( !ndf->private->dispose_has_run ){
+
+		if( ndf->private->key_file ){
+			remove_encoding_part( ndf );
 		}
 
-		g_output_stream_close( G_OUTPUT_STREAM( stream ), NULL, &error );
-		if( error ){
-			g_warning( "%s: g_output_stream_close: %s", thisfn, error->message );
-			g_error_free( error );
-			g_object_unref( stream );
-			g_object_unref( file );
-			g_free( data );
-			return( FALSE );
+		if( !ndf->private->dirty ){
+			g_debug( "%s: uri=%s: unchanged, not staged", thisfn, ndf->private->uri );
+			return( TRUE );
 		}
 
-		g_object_unref( stream );
-		g_object_unref( file );
-		g_free( data );
+		g_debug( "%s: uri=%s", thisfn, ndf->private->uri );
+		path = g_filename_from_uri( ndf->private->uri, NULL, NULL );
+
+		if( path ){
+			ret = write_temp_file( ndf, path, FALSE );
+			g_free( path );
+
+		} else {
+			ret = replace_uri( ndf );
+		}
+	}
+
+	return( ret );
+}
+
+/**
+ * nadp_desktop_file_commit_staged:
+ * @ndfs: a list of #NadpDesktopFile instances.
+ *
+ * Syncs all files previously staged with nadp_desktop_file_stage() in
+ * one pass, then renames them over their target, and last syncs each
+ * involved directory only once.
+ *
+ * Instances of the list which have nothing staged are just ignored.
+ *
+ * Returns: %TRUE if all staged files have been successfully committed,
+ * %FALSE else.
+ */
+gboolean
+nadp_desktop_file_commit_staged( GList *ndfs )
+{
+	static const gchar *thisfn = "nadp_desktop_file_commit_staged";
+	gboolean ret;
+	GList *it;
+	NadpDesktopFile *ndf;
+	GHashTable *dirs;
+	GList *dir_list, *id;
+	gchar *dir;
+
+	ret = TRUE;
+	dirs = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+
+	for( it = ndfs ; it ; it = it->next ){
+		ndf = NADP_DESKTOP_FILE( it->data );
+		if( !ndf->private->dispose_has_run && ndf->private->staged ){
+			if( !sync_path( ndf->private->staged, FALSE )){
+				discard_temp_file( ndf );
+				ret = FALSE;
+			}
+		}
+	}
+
+	for( it = ndfs ; it ; it = it->next ){
+		ndf = NADP_DESKTOP_FILE( it->data );
+		if( !ndf->private->dispose_has_run && ndf->private->staged ){
+			if( rename_temp_file( ndf, &dir )){
+				g_hash_table_replace( dirs, dir, NULL );
+			} else {
+				ret = FALSE;
+			}
+		}
+	}
 
-		return( TRUE );
+	dir_list = g_hash_table_get_keys( dirs );
+	for( id = dir_list ; id ; id = id->next ){
+		sync_path(( const gchar * ) id->data, TRUE );
 	}
+	g_debug( "%s: %u synced directories, ret=%s", thisfn, g_list_length( dir_list ), ret ? "True":"False" );
+	g_list_free( dir_list );
+	g_hash_table_destroy( dirs );
+
+	return( ret );
+}
+
+/**
+ * nadp_desktop_file_discard_staged:
+ * @ndf: the #NadpDesktopFile instance.
+ *
+ * Removes the temporary file previously staged with
+ * nadp_desktop_file_stage(), if any. The key file stays dirty.
+ */
+void
+nadp_desktop_file_discard_staged( NadpDesktopFile *ndf )
+{
+	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
 
-	return( FALSE );
+	if( !ndf->private->dispose_has_run ){
+
+		discard_temp_file( ndf );
+	}
 }
 
 static void
@@ -1247,6 +1612,8 @@ remove_encoding_part( NadpDesktopFile *ndf )
 						g_warning( "%s: %s", thisfn, error->message );
 						g_error_free( error );
 						error = NULL;
+					} else {
+						ndf->private->dirty = TRUE;
 					}
 				}
 
@@ -1260,3 +1627,443 @@ remove_encoding_part( NadpDesktopFile *ndf )
 		g_regex_unref( regex );
 	}
 }
+
+static void
+release_parser( NadpDesktopFile *ndf )
+{
+	if( ndf->private->parser ){
+		nadp_parser_free( ndf->private->parser );
+		ndf->private->parser = NULL;
+	}
+}
+
+/*
+ * the raw value is compared before and after the set, so that only
+ * actual modifications mark the key file as dirty
+ * @previous is released here
+ */
+static void
+set_dirty_if_changed( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, gchar *previous )
+{
+	gchar *value;
+
+	if( !ndf->private->dirty ){
+		value = g_key_file_get_value( ndf->private->key_file, group, key, NULL );
+		if( g_strcmp0( previous, value )){
+			ndf->private->dirty = TRUE;
+		}
+		g_free( value );
+	}
+
+	g_free( previous );
+}
+
+/*
+ * writes the key file into a hidden temporary file of the same directory
+ * than the target, which is not seen by the reader as it does not have
+ * the right suffix
+ *
+ * a symbolic link is resolved, so that the file it points to is replaced
+ * rather than the link itself; the existing permissions and ownership of
+ * the target are preserved - when they cannot be (e.g. the target belongs
+ * to another user, or is a dangling link), the temporary file will be
+ * copied in place of the target instead of being renamed over it
+ */
+static gboolean
+write_temp_file( NadpDesktopFile *ndf, const gchar *path, gboolean sync )
+{
+	static const gchar *thisfn = "nadp_desktop_file_write_temp_file";
+	gboolean ret, in_place;
+	gchar *data;
+	gsize length;
+	gchar *target, *dir, *bname, *tmpl;
+	gint fd;
+	struct stat st, tmp_st;
+
+	discard_temp_file( ndf );
+
+	in_place = FALSE;
+	target = resolve_target( path );
+	if( !target ){
+		g_debug( "%s: %s: dangling symbolic link, will be written in place", thisfn, path );
+		target = g_strdup( path );
+		in_place = TRUE;
+	}
+
+	data = g_key_file_to_data( ndf->private->key_file, &length, NULL );
+	dir = g_path_get_dirname( target );
+	bname = g_path_get_basename( target );
+	tmpl = g_strdup_printf( "%s%s.%s.XXXXXX", dir, G_DIR_SEPARATOR_S, bname );
+	g_free( bname );
+	g_free( dir );
+
+	ret = FALSE;
+	fd = g_mkstemp_full( tmpl, O_WRONLY, 0666 );
+
+	if( fd < 0 ){
+		g_warning( "%s: %s: %s", thisfn, tmpl, g_strerror( errno ));
+
+	} else {
+		if( !in_place && g_stat( target, &st ) == 0 ){
+			fchmod( fd, st.st_mode & 07777 );
+
+			if( fstat( fd, &tmp_st ) != 0 ||
+				(( tmp_st.st_uid != st.st_uid || tmp_st.st_gid != st.st_gid ) && fchown( fd, st.st_uid, st.st_gid ) != 0 )){
+
+				g_debug( "%s: %s: unable to preserve the ownership, will be written in place", thisfn, target );
+				in_place = TRUE;
+			}
+		}
+
+		ret = write_fd( fd, data, length, tmpl );
+
+		if( ret && sync && !in_place && fsync( fd ) != 0 ){
+			g_warning( "%s: %s: fsync: %s", thisfn, tmpl, g_strerror( errno ));
+			ret = FALSE;
+		}
+
+		if( close( fd ) != 0 && ret ){
+			g_warning( "%s: %s: close: %s", thisfn, tmpl, g_strerror( errno ));
+			ret = FALSE;
+		}
+
+		if( !ret ){
+			g_unlink( tmpl );
+		}
+	}
+
+	if( ret ){
+		ndf->private->staged = tmpl;
+		ndf->private->staged_target = target;
+		ndf->private->staged_in_place = in_place;
+	} else {
+		g_free( tmpl );
+		g_free( target );
+	}
+
+	g_free( data );
+
+	return( ret );
+}
+
+/*
+ * returns the path of the file to be actually replaced, as a newly
+ * allocated string, or %NULL if @path is a dangling symbolic link
+ */
+static gchar *
+resolve_target( const gchar *path )
+{
+	gchar *resolved, *target;
+
+	if( !g_file_test( path, G_FILE_TEST_IS_SYMLINK )){
+		return( g_strdup( path ));
+	}
+
+	target = NULL;
+	resolved = realpath( path, NULL );
+	if( resolved ){
+		target = g_strdup( resolved );
+		free( resolved );
+	}
+
+	return( target );
+}
+
+static gboolean
+write_fd( gint fd, const gchar *data, gsize length, const gchar *fname )
+{
+	static const gchar *thisfn = "nadp_desktop_file_write_fd";
+	gsize written;
+	gssize count;
+
+	for( written = 0 ; written < length ; ){
+		count = write( fd, data+written, length-written );
+		if( count < 0 ){
+			if( errno != EINTR ){
+				g_warning( "%s: %s: %s", thisfn, fname, g_strerror( errno ));
+				return( FALSE );
+			}
+		} else {
+			written += count;
+		}
+	}
+
+	return( TRUE );
+}
+
+/*
+ * atomically replaces the target with the staged temporary file, or
+ * copies it in place when the target attributes cannot be preserved
+ * @dir is set to the directory of the replaced file, to be synced by
+ * the caller
+ */
+static gboolean
+rename_temp_file( NadpDesktopFile *ndf, gchar **dir )
+{
+	static const gchar *thisfn = "nadp_desktop_file_rename_temp_file";
+
+	if( ndf->private->staged_in_place ){
+		if( !copy_temp_file( ndf )){
+			discard_temp_file( ndf );
+			return( FALSE );
+		}
+		g_unlink( ndf->private->staged );
+
+	} else if( g_rename( ndf->private->staged, ndf->private->staged_target ) != 0 ){
+		g_warning( "%s: %s: %s", thisfn, ndf->private->staged_target, g_strerror( errno ));
+		discard_temp_file( ndf );
+		return( FALSE );
+	}
+
+	*dir = g_path_get_dirname( ndf->private->staged_target );
+
+	g_free( ndf->private->staged );
+	ndf->private->staged = NULL;
+	g_free( ndf->private->staged_target );
+	ndf->private->staged_target = NULL;
+	ndf->private->staged_in_place = FALSE;
+	ndf->private->dirty = FALSE;
+
+	return( TRUE );
+}
+
+/*
+ * rewrites the target with the content of the staged temporary file,
+ * so that the target keeps its inode, and so its attributes
+ * (this is not atomic)
+ */
+static gboolean
+copy_temp_file( NadpDesktopFile *ndf )
+{
+	static const gchar *thisfn = "nadp_desktop_file_copy_temp_file";
+	gboolean ret;
+	gchar *data;
+	gsize length;
+	GError *error;
+	gint fd;
+
+	error = NULL;
+	if( !g_file_get_contents( ndf->private->staged, &data, &length, &error )){
+		g_warning( "%s: %s: %s", thisfn, ndf->private->staged, error->message );
+		g_error_free( error );
+		return( FALSE );
+	}
+
+	ret = FALSE;
+	fd = g_open( ndf->private->staged_target, O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+
+	if( fd < 0 ){
+		g_warning( "%s: %s: %s", thisfn, ndf->private->staged_target, g_strerror( errno ));
+
+	} else {
+		ret = write_fd( fd, data, length, ndf->private->staged_target );
+
+		if( ret && fsync( fd ) != 0 ){
+			g_warning( "%s: %s: fsync: %s", thisfn, ndf->private->staged_target, g_strerror( errno ));
+			ret = FALSE;
+		}
+
+		if( close( fd ) != 0 && ret ){
+			g_warning( "%s: %s: close: %s", thisfn, ndf->private->staged_target, g_strerror( errno ));
+			ret = FALSE;
+		}
+	}
+
+	g_free( data );
+
+	return( ret );
+}
+
+static void
+discard_temp_file( NadpDesktopFile *ndf )
+{
+	if( ndf->private->staged ){
+		g_unlink( ndf->private->staged );
+		g_free( ndf->private->staged );
+		ndf->private->staged = NULL;
+	}
+
+	g_free( ndf->private->staged_target );
+	ndf->private->staged_target = NULL;
+	ndf->private->staged_in_place = FALSE;
+}
+
+/*
+ * syncing a directory makes a rename durable; not all filesystems
+ * support it, so a failure is not reported for directories
+ */
+static gboolean
+sync_path( const gchar *path, gboolean is_dir )
+{
+	static const gchar *thisfn = "nadp_desktop_file_sync_path";
+	gboolean ret;
+	gint fd;
+
+	ret = FALSE;
+	fd = g_open( path, O_RDONLY, 0 );
+
+	if( fd >= 0 ){
+		ret = ( fsync( fd ) == 0 );
+		if( !ret && !is_dir ){
+			g_warning( "%s: %s: %s", thisfn, path, g_strerror( errno ));
+		}
+		close( fd );
+
+	} else if( !is_dir ){
+		g_warning( "%s: %s: %s", thisfn, path, g_strerror( errno ));
+	}
+
+	return( ret || is_dir );
+}
+
+/*
+ * non-local files are still written through GIO
+ */
+static gboolean
+replace_uri( NadpDesktopFile *ndf )
+{
+	static const gchar *thisfn = "nadp_desktop_file_replace_uri";
+	gchar *data;
+	GFile *file;
+	GFileOutputStream *stream;
+	GError *error;
+	gsize length;
+
+	error = NULL;
+	data = g_key_file_to_data( ndf->private->key_file, &length, NULL );
+	file = g_file_new_for_uri( ndf->private->uri );
+
+	stream = g_file_replace( file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &error );
+	if( error ){
+		g_warning( "%s: g_file_replace: %s", thisfn, error->message );
+		g_error_free( error );
+		if( stream ){
+			g_object_unref( stream );
+		}
+		g_object_unref( file );
+		g_free( data );
+		return( FALSE );
+	}
+
+	g_output_stream_write( G_OUTPUT_STREAM( stream ), data, length, NULL, &error );
+	if( error ){
+		g_warning( "%s: g_output_stream_write: %s", thisfn, error->message );
+		g_error_free( error );
+		g_object_unref( stream );
+		g_object_unref( file );
+		g_free( data );
+		return( FALSE );
+	}
+
+	g_output_stream_close( G_OUTPUT_STREAM( stream ), NULL, &error );
+	if( error ){
+		g_warning( "%s: g_output_stream_close: %s", thisfn, error->message );
+		g_error_free( error );
+		g_object_unref( stream );
+		g_object_unref( file );
+		g_free( data );
+		return( FALSE );
+	}
+
+	g_object_unref( stream );
+	g_object_unref( file );
+	g_free( data );
+
+	ndf->private->dirty = FALSE;
+
+	return( TRUE );
+}
+
+/*
+ * the read accessors are redirected to the parser while the key file
+ * has not been fully loaded
+ */
+static gboolean
+ndf_has_group( const NadpDesktopFile *ndf, const gchar *group )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_has_group( ndf->private->parser, group ));
+	}
+
+	return( g_key_file_has_group( ndf->private->key_file, group ));
+}
+
+static gboolean
+ndf_has_key( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_has_key( ndf->private->parser, group, key, error ));
+	}
+
+	return( g_key_file_has_key( ndf->private->key_file, group, key, error ));
+}
+
+static gchar *
+ndf_get_start_group( const NadpDesktopFile *ndf )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_get_start_group( ndf->private->parser ));
+	}
+
+	return( g_key_file_get_start_group( ndf->private->key_file ));
+}
+
+static gchar **
+ndf_get_groups( const NadpDesktopFile *ndf )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_get_groups( ndf->private->parser, NULL ));
+	}
+
+	return( g_key_file_get_groups( ndf->private->key_file, NULL ));
+}
+
+static gboolean
+ndf_get_boolean( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_get_boolean( ndf->private->parser, group, key, error ));
+	}
+
+	return( g_key_file_get_boolean( ndf->private->key_file, group, key, error ));
+}
+
+static gint
+ndf_get_integer( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_get_integer( ndf->private->parser, group, key, error ));
+	}
+
+	return( g_key_file_get_integer( ndf->private->key_file, group, key, error ));
+}
+
+static gchar *
+ndf_get_locale_string( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_get_locale_string( ndf->private->parser, group, key, error ));
+	}
+
+	return( g_key_file_get_locale_string( ndf->private->key_file, group, key, NULL, error ));
+}
+
+static gchar *
+ndf_get_string( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_get_string( ndf->private->parser, group, key, error ));
+	}
+
+	return( g_key_file_get_string( ndf->private->key_file, group, key, error ));
+}
+
+static gchar **
+ndf_get_string_list( const NadpDesktopFile *ndf, const gchar *group, const gchar *key, GError **error )
+{
+	if( ndf->private->parser ){
+		return( nadp_parser_get_string_list( ndf->private->parser, group, key, NULL, error ));
+	}
+
+	return( g_key_file_get_string_list( ndf->private->key_file, group, key, NULL, error ));
+}
@@ -77,12 +77,20 @@ GType            nadp_desktop_file_get_type         ( void );
 
 NadpDesktopFile *nadp_desktop_file_new              ( void );
 NadpDesktopFile *nadp_desktop_file_new_from_path    ( const gchar *path );
+NadpDesktopFile *nadp_desktop_file_new_from_data    ( const gchar *path, const gchar *data, gsize length );
 NadpDesktopFile *nadp_desktop_file_new_from_uri     ( const gchar *uri );
+NadpDesktopFile *nadp_desktop_file_new_from_uri_data( const gchar *uri, const gchar *data, gsize length );
 NadpDesktopFile *nadp_desktop_file_new_for_write    ( const gchar *path );
 
+gboolean         nadp_desktop_file_load_full        ( NadpDesktopFile *ndf );
+
 GKeyFile        *nadp_desktop_file_get_key_file     ( const NadpDesktopFile *ndf );
 gchar           *nadp_desktop_file_get_key_file_uri ( const NadpDesktopFile *ndf );
+gboolean         nadp_desktop_file_is_dirty         ( const NadpDesktopFile *ndf );
 gboolean         nadp_desktop_file_write            ( NadpDesktopFile *ndf );
+gboolean         nadp_desktop_file_stage            ( NadpDesktopFile *ndf );
+gboolean         nadp_desktop_file_commit_staged    ( GList *ndfs );
+void             nadp_desktop_file_discard_staged   ( NadpDesktopFile *ndf );
 
 gchar           *nadp_desktop_file_get_file_type    ( const NadpDesktopFile *ndf );
 gchar           *nadp_desktop_file_get_id           ( const NadpDesktopFile *ndf );
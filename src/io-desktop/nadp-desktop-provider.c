@@ -31,17 +31,24 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <api/na-core-utils.h>
 #include <api/na-ifactory-provider.h>
+#include <api/na-object-api.h>
 
 #include "nadp-desktop-provider.h"
 #include "nadp-formats.h"
 #include "nadp-keys.h"
 #include "nadp-monitor.h"
+#include "nadp-notifier.h"
 #include "nadp-reader.h"
+#include "nadp-utils.h"
 #include "nadp-writer.h"
 
 /* private class data
@@ -50,6 +57,16 @@ struct _NadpDesktopProviderClassPrivate {
 	void *empty;						/* so that gcc -pedantic is happy */
 };
 
+/* the state of a .desktop file right after we have written it
+ */
+typedef struct {
+	gboolean exists;
+	time_t   mtime;
+	goffset  size;
+	guint64  inode;
+}
+	NadpWriteStamp;
+
 static GType         st_module_type = 0;
 static GObjectClass *st_parent_class = NULL;
 static guint         st_burst_timeout = 100;		/* burst timeout in msec */
@@ -63,6 +80,9 @@ static void   iio_provider_iface_init( NAIIOProviderInterface *iface );
 static gchar *iio_provider_get_id( const NAIIOProvider *provider );
 static gchar *iio_provider_get_name( const NAIIOProvider *provider );
 static guint  iio_provider_get_version( const NAIIOProvider *provider );
+static gboolean iio_provider_is_item_writable( const NAIIOProvider *provider, const NAObjectItem *item );
+static void   iio_provider_begin_batch( const NAIIOProvider *provider );
+static guint  iio_provider_commit_batch( const NAIIOProvider *provider, GSList **messages );
 
 static void   ifactory_provider_iface_init( NAIFactoryProviderInterface *iface );
 static guint  ifactory_provider_get_version( const NAIFactoryProvider *reader );
@@ -176,6 +196,13 @@ instance_init( GTypeInstance *instance, gpointer klass )
 	self->private->timeout.handler = ( NATimeoutFunc ) on_monitor_timeout;
 	self->private->timeout.user_data = self;
 	self->private->timeout.source_id = 0;
+	self->private->changed = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+	self->private->full_reload = FALSE;
+	self->private->writability = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+	self->private->batch = 0;
+	self->private->staged = NULL;
+	self->private->own_writes = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, g_free );
+	self->private->written_ids = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
 }
 
 static void
@@ -195,6 +222,16 @@ instance_dispose( GObject *object )
 		self->private->dispose_has_run = TRUE;
 
 		nadp_desktop_provider_release_monitors( self );
+		nadp_notifier_unsubscribe( self );
+
+		/* a batch which has not been committed is dropped as a whole
+		 */
+		if( self->private->staged ){
+			g_list_foreach( self->private->staged, ( GFunc ) nadp_desktop_file_discard_staged, NULL );
+			g_list_foreach( self->private->staged, ( GFunc ) g_object_unref, NULL );
+			g_list_free( self->private->staged );
+			self->private->staged = NULL;
+		}
 
 		/* chain up to the parent class */
 		if( G_OBJECT_CLASS( st_parent_class )->dispose ){
@@ -215,6 +252,11 @@ instance_finalize( GObject *object )
 
 	self = NADP_DESKTOP_PROVIDER( object );
 
+	g_hash_table_destroy( self->private->changed );
+	g_hash_table_destroy( self->private->writability );
+	g_hash_table_destroy( self->private->own_writes );
+	g_hash_table_destroy( self->private->written_ids );
+
 	g_free( self->private );
 
 	/* chain call to parent class */
@@ -239,6 +281,10 @@ iio_provider_iface_init( NAIIOProviderInterface *iface )
 	iface->write_item = nadp_iio_provider_write_item;
 	iface->delete_item = nadp_iio_provider_delete_item;
 	iface->duplicate_data = nadp_iio_provider_duplicate_data;
+	iface->read_item = nadp_iio_provider_read_item;
+	iface->is_item_writable = iio_provider_is_item_writable;
+	iface->begin_batch = iio_provider_begin_batch;
+	iface->commit_batch = iio_provider_commit_batch;
 }
 
 static guint
@@ -247,6 +293,55 @@ iio_provider_get_version( const NAIIOProvider *provider )
 	return( 1 );
 }
 
+/*
+ * the writability status of a loaded item may have changed since it has
+ * been read: ask again the writability cache, which is cheap as long as
+ * the desktop directories have not been touched
+ */
+static gboolean
+iio_provider_is_item_writable( const NAIIOProvider *provider, const NAObjectItem *item )
+{
+	NadpDesktopFile *ndf;
+	gchar *uri;
+	gboolean writable;
+
+	g_return_val_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ), FALSE );
+
+	ndf = ( NadpDesktopFile * ) na_object_get_provider_data( item );
+
+	if( !ndf ){
+		return( !na_object_is_readonly( item ));
+	}
+
+	g_return_val_if_fail( NADP_IS_DESKTOP_FILE( ndf ), FALSE );
+
+	uri = nadp_desktop_file_get_key_file_uri( ndf );
+	writable = nadp_desktop_provider_is_uri_writable( NADP_DESKTOP_PROVIDER( provider ), uri );
+	g_free( uri );
+
+	return( writable );
+}
+
+static void
+iio_provider_begin_batch( const NAIIOProvider *provider )
+{
+	g_return_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ));
+
+	nadp_desktop_provider_begin_batch( NADP_DESKTOP_PROVIDER( provider ));
+}
+
+static guint
+iio_provider_commit_batch( const NAIIOProvider *provider, GSList **messages )
+{
+	g_return_val_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ), NA_IIO_PROVIDER_CODE_PROGRAM_ERROR );
+
+	if( !nadp_desktop_provider_commit_batch( NADP_DESKTOP_PROVIDER( provider ), messages )){
+		return( NA_IIO_PROVIDER_CODE_WRITE_ERROR );
+	}
+
+	return( NA_IIO_PROVIDER_CODE_OK );
+}
+
 static gchar *
 iio_provider_get_id( const NAIIOProvider *provider )
 {
@@ -290,6 +385,7 @@ iimporter_iface_init( NAIImporterInterface *iface )
 
 	iface->get_version = iimporter_get_version;
 	iface->import_from_uri = nadp_reader_iimporter_import_from_uri;
+	iface->probe = nadp_reader_iimporter_probe;
 }
 
 static guint
@@ -361,16 +457,28 @@ nadp_desktop_provider_add_monitor( NadpDesktopProvider *provider, const gchar *d
 /**
  * nadp_desktop_provider_on_monitor_event:
  * @provider: this #NadpDesktopProvider object.
+ * @id: the identifier of the modified .desktop file, or %NULL if the
+ *  whole items list has to be read again.
  *
  * Factorize events received from GIO when monitoring desktop directories.
  */
 void
-nadp_desktop_provider_on_monitor_event( NadpDesktopProvider *provider )
+nadp_desktop_provider_on_monitor_event( NadpDesktopProvider *provider, const gchar *id )
 {
 	g_return_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ));
 
 	if( !provider->private->dispose_has_run ){
 
+		/* whatever be the event, permissions may have changed too
+		 */
+		nadp_desktop_provider_reset_writability( provider );
+
+		if( id ){
+			g_hash_table_replace( provider->private->changed, g_strdup( id ), NULL );
+		} else {
+			provider->private->full_reload = TRUE;
+		}
+
 		na_timeout_event( &provider->private->timeout );
 	}
 }
@@ -394,16 +502,379 @@ nadp_desktop_provider_release_monitors( NadpDesktopProvider *provider )
 	}
 }
 
+/**
+ * nadp_desktop_provider_is_uri_writable:
+ * @provider: this #NadpDesktopProvider object.
+ * @uri: the URI of a .desktop file.
+ *
+ * All the .desktop files of a same directory which share the same owner,
+ * group and permissions have also the same writability status. This
+ * status is so only evaluated once per such a set, and kept until the
+ * next scan of the directories, or until the directory is modified.
+ *
+ * Returns: %TRUE if the file is writable, %FALSE else.
+ */
+gboolean
+nadp_desktop_provider_is_uri_writable( NadpDesktopProvider *provider, const gchar *uri )
+{
+	static const gchar *thisfn = "nadp_desktop_provider_is_uri_writable";
+	gchar *path, *dir, *key;
+	struct stat st;
+	gpointer value;
+	gboolean writable;
+
+	g_return_val_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ), FALSE );
+
+	writable = FALSE;
+
+	if( !provider->private->dispose_has_run ){
+
+		path = g_filename_from_uri( uri, NULL, NULL );
+
+		/* not a local file: just ask GIO
+		 */
+		if( !path ){
+			return( nadp_utils_uri_is_writable( uri ));
+		}
+
+		if( g_stat( path, &st ) == -1 ){
+			g_debug( "%s: %s: %s", thisfn, path, g_strerror( errno ));
+			g_free( path );
+			return( FALSE );
+		}
+
+		dir = g_path_get_dirname( path );
+		key = g_strdup_printf( "%s:%lu:%lu:%lo", dir,
+				( gulong ) st.st_uid, ( gulong ) st.st_gid, ( gulong )( st.st_mode & 07777 ));
+
+		if( g_hash_table_lookup_extended( provider->private->writability, key, NULL, &value )){
+			writable = GPOINTER_TO_UINT( value );
+			g_free( key );
+
+		} else {
+			writable = ( g_access( path, W_OK ) == 0 );
+			if( !writable ){
+				g_debug( "%s: %s is not writable", thisfn, path );
+			}
+			g_hash_table_insert( provider->private->writability, key, GUINT_TO_POINTER( writable ));
+		}
+
+		g_free( dir );
+		g_free( path );
+	}
+
+	return( writable );
+}
+
+/**
+ * nadp_desktop_provider_reset_writability:
+ * @provider: this #NadpDesktopProvider object.
+ *
+ * Forgets all writability statuses previously evaluated.
+ */
+void
+nadp_desktop_provider_reset_writability( NadpDesktopProvider *provider )
+{
+	g_return_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ));
+
+	if( !provider->private->dispose_has_run ){
+
+		g_hash_table_remove_all( provider->private->writability );
+	}
+}
+
+/**
+ * nadp_desktop_provider_begin_batch:
+ * @provider: this #NadpDesktopProvider object.
+ *
+ * Opens a batch of writes: until the batch is committed, the written
+ * .desktop files are only staged, and will be synced to the disk all
+ * together.
+ *
+ * Batches may be nested; only the outermost commit flushes the files.
+ */
+void
+nadp_desktop_provider_begin_batch( NadpDesktopProvider *provider )
+{
+	g_return_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ));
+
+	if( !provider->private->dispose_has_run ){
+
+		provider->private->batch += 1;
+	}
+}
+
+/**
+ * nadp_desktop_provider_is_in_batch:
+ * @provider: this #NadpDesktopProvider object.
+ *
+ * Returns: %TRUE if a batch of writes is currently opened.
+ */
+gboolean
+nadp_desktop_provider_is_in_batch( NadpDesktopProvider *provider )
+{
+	g_return_val_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ), FALSE );
+
+	return( !provider->private->dispose_has_run && provider->private->batch > 0 );
+}
+
+/**
+ * nadp_desktop_provider_stage_file:
+ * @provider: this #NadpDesktopProvider object.
+ * @ndf: a #NadpDesktopFile which has been staged in the current batch.
+ *
+ * Records @ndf so that it will be committed with the batch.
+ */
+void
+nadp_desktop_provider_stage_file( NadpDesktopProvider *provider, NadpDesktopFile *ndf )
+{
+	g_return_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ));
+	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
+
+	if( !provider->private->dispose_has_run ){
+
+		if( !g_list_find( provider->private->staged, ndf )){
+			provider->private->staged = g_list_prepend( provider->private->staged, g_object_ref( ndf ));
+		}
+	}
+}
+
+/**
+ * nadp_desktop_provider_unstage_file:
+ * @provider: this #NadpDesktopProvider object.
+ * @ndf: a #NadpDesktopFile.
+ *
+ * Forgets the pending write of @ndf, if any, e.g. because the item is
+ * deleted in the same batch.
+ */
+void
+nadp_desktop_provider_unstage_file( NadpDesktopProvider *provider, NadpDesktopFile *ndf )
+{
+	GList *found;
+
+	g_return_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ));
+	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
+
+	if( !provider->private->dispose_has_run ){
+
+		found = g_list_find( provider->private->staged, ndf );
+		if( found ){
+			nadp_desktop_file_discard_staged( ndf );
+			provider->private->staged = g_list_delete_link( provider->private->staged, found );
+			g_object_unref( ndf );
+		}
+	}
+}
+
+/**
+ * nadp_desktop_provider_record_write:
+ * @provider: this #NadpDesktopProvider object.
+ * @ndf: a #NadpDesktopFile which has just been written or deleted by
+ *  this process.
+ *
+ * Records the path, the modification time, the size and the inode of
+ * the file as they are right after our write (or the fact that it does
+ * not exist anymore), so that the monitor events it causes may be
+ * recognized and dropped.
+ *
+ * Other processes are told about the modified item: outside of a batch
+ * immediately, else when the batch is committed.
+ */
+void
+nadp_desktop_provider_record_write( NadpDesktopProvider *provider, NadpDesktopFile *ndf )
+{
+	gchar *uri;
+	gchar *path;
+	gchar *id;
+	NadpWriteStamp *stamp;
+	struct stat st;
+	GSList *ids;
+
+	g_return_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ));
+	g_return_if_fail( NADP_IS_DESKTOP_FILE( ndf ));
+
+	if( !provider->private->dispose_has_run ){
+
+		uri = nadp_desktop_file_get_key_file_uri( ndf );
+		path = g_filename_from_uri( uri, NULL, NULL );
+		g_free( uri );
+
+		if( path ){
+			stamp = g_new0( NadpWriteStamp, 1 );
+			if( g_stat( path, &st ) == 0 ){
+				stamp->exists = TRUE;
+				stamp->mtime = st.st_mtime;
+				stamp->size = st.st_size;
+				stamp->inode = st.st_ino;
+			}
+			g_hash_table_replace( provider->private->own_writes, path, stamp );
+		}
+
+		id = nadp_desktop_file_get_id( ndf );
+
+		if( nadp_desktop_provider_is_in_batch( provider )){
+			g_hash_table_replace( provider->private->written_ids, id, NULL );
+
+		} else {
+			ids = g_slist_prepend( NULL, id );
+			nadp_notifier_push( ids );
+			g_slist_free( ids );
+			g_free( id );
+		}
+	}
+}
+
+/**
+ * nadp_desktop_provider_is_own_write:
+ * @provider: this #NadpDesktopProvider object.
+ * @path: the path of a .desktop file a monitor event has been received for.
+ *
+ * Several monitor events are received for each write. They are all
+ * dropped as long as the file is still the one we have written. As soon
+ * as it differs, someone else has modified it, and the record is
+ * forgotten.
+ *
+ * Returns: %TRUE if the current state of the file is the one recorded
+ * after our last write, %FALSE else.
+ */
+gboolean
+nadp_desktop_provider_is_own_write( NadpDesktopProvider *provider, const gchar *path )
+{
+	gboolean own;
+	NadpWriteStamp *stamp;
+	struct stat st;
+
+	g_return_val_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ), FALSE );
+
+	own = FALSE;
+
+	if( !provider->private->dispose_has_run ){
+
+		stamp = ( NadpWriteStamp * ) g_hash_table_lookup( provider->private->own_writes, path );
+
+		if( stamp ){
+			if( g_stat( path, &st ) == 0 ){
+				own = ( stamp->exists &&
+						stamp->mtime == st.st_mtime &&
+						stamp->size == st.st_size &&
+						stamp->inode == st.st_ino );
+			} else {
+				own = !stamp->exists;
+			}
+
+			if( !own ){
+				g_hash_table_remove( provider->private->own_writes, path );
+			}
+		}
+	}
+
+	return( own );
+}
+
+/**
+ * nadp_desktop_provider_commit_batch:
+ * @provider: this #NadpDesktopProvider object.
+ * @messages: a pointer to a GSList list of strings; a message is
+ *  appended for each staged file which could not be committed.
+ *
+ * Closes a batch of writes. When the outermost batch is closed, all the
+ * staged files are synced in one pass, then renamed to their target.
+ *
+ * A file which could not be committed keeps its dirty flag.
+ *
+ * Returns: %TRUE if all staged files have been successfully written,
+ * %FALSE else.
+ */
+gboolean
+nadp_desktop_provider_commit_batch( NadpDesktopProvider *provider, GSList **messages )
+{
+	static const gchar *thisfn = "nadp_desktop_provider_commit_batch";
+	gboolean ret;
+	GList *it;
+	GSList *ids;
+	GHashTableIter iter;
+	gpointer key;
+	NadpDesktopFile *ndf;
+	gchar *uri;
+
+	g_return_val_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ), FALSE );
+
+	ret = TRUE;
+
+	if( !provider->private->dispose_has_run && provider->private->batch > 0 ){
+
+		/* the writes are recorded while the batch is still opened, so
+		 * that their ids are only notified once, below
+		 */
+		if( provider->private->batch == 1 && provider->private->staged ){
+			g_debug( "%s: committing %u staged file(s)", thisfn, g_list_length( provider->private->staged ));
+			provider->private->staged = g_list_reverse( provider->private->staged );
+			ret = nadp_desktop_file_commit_staged( provider->private->staged );
+			for( it = provider->private->staged ; it ; it = it->next ){
+				ndf = NADP_DESKTOP_FILE( it->data );
+				if( nadp_desktop_file_is_dirty( ndf )){
+					uri = nadp_desktop_file_get_key_file_uri( ndf );
+					na_core_utils_slist_add_message( messages, _( "Unable to write %s" ), uri );
+					g_free( uri );
+				} else {
+					nadp_desktop_provider_record_write( provider, ndf );
+				}
+			}
+			g_list_foreach( provider->private->staged, ( GFunc ) g_object_unref, NULL );
+			g_list_free( provider->private->staged );
+			provider->private->staged = NULL;
+		}
+
+		provider->private->batch -= 1;
+
+		/* deleted items are also recorded here, even if nothing has
+		 * been staged
+		 */
+		if( provider->private->batch == 0 && g_hash_table_size( provider->private->written_ids )){
+			ids = NULL;
+			g_hash_table_iter_init( &iter, provider->private->written_ids );
+			while( g_hash_table_iter_next( &iter, &key, NULL )){
+				ids = g_slist_prepend( ids, key );
+			}
+			nadp_notifier_push( ids );
+			g_slist_free( ids );
+			g_hash_table_remove_all( provider->private->written_ids );
+		}
+	}
+
+	return( ret );
+}
+
 static void
 on_monitor_timeout( NadpDesktopProvider *provider )
 {
 	static const gchar *thisfn = "nadp_desktop_provider_on_monitor_timeout";
 
+	GHashTableIter iter;
+	gpointer key;
+	GSList *ids;
+
 	/* last individual notification is older that the st_burst_timeout
 	 * so triggers the NAIIOProvider interface and destroys this timeout
 	 */
-	g_debug( "%s: triggering NAIIOProvider interface for provider=%p (%s)",
-			thisfn, ( void * ) provider, G_OBJECT_TYPE_NAME( provider ));
+	g_debug( "%s: triggering NAIIOProvider interface for provider=%p (%s), full_reload=%s, changed=%u",
+			thisfn, ( void * ) provider, G_OBJECT_TYPE_NAME( provider ),
+			provider->private->full_reload ? "True":"False", g_hash_table_size( provider->private->changed ));
+
+	if( provider->private->full_reload ){
+		na_iio_provider_item_changed( NA_IIO_PROVIDER( provider ));
+
+	} else if( g_hash_table_size( provider->private->changed )){
+		ids = NULL;
+		g_hash_table_iter_init( &iter, provider->private->changed );
+		while( g_hash_table_iter_next( &iter, &key, NULL )){
+			ids = g_slist_prepend( ids, key );
+		}
+
+		na_iio_provider_items_delta( NA_IIO_PROVIDER( provider ), ids );
+		g_slist_free( ids );
+	}
 
-	na_iio_provider_item_changed( NA_IIO_PROVIDER( provider ));
+	g_hash_table_remove_all( provider->private->changed );
+	provider->private->full_reload = FALSE;
 }
@@ -58,9 +58,16 @@ G_BEGIN_DECLS
  */
 typedef struct _NadpDesktopProviderPrivate {
 	/*< private >*/
-	gboolean  dispose_has_run;
-	GList    *monitors;
-	NATimeout timeout;
+	gboolean    dispose_has_run;
+	GList      *monitors;
+	NATimeout   timeout;
+	GHashTable *changed;
+	gboolean    full_reload;
+	GHashTable *writability;
+	guint       batch;
+	GList      *staged;
+	GHashTable *own_writes;
+	GHashTable *written_ids;
 }
 	NadpDesktopProviderPrivate;
 
@@ -89,9 +96,21 @@ GType nadp_desktop_provider_get_type     ( void );
 void  nadp_desktop_provider_register_type( GTypeModule *module );
 
 void  nadp_desktop_provider_add_monitor     ( NadpDesktopProvider *provider, const gchar *dir );
-void  nadp_desktop_provider_on_monitor_event( NadpDesktopProvider *provider );
+void  nadp_desktop_provider_on_monitor_event( NadpDesktopProvider *provider, const gchar *id );
 void  nadp_desktop_provider_release_monitors( NadpDesktopProvider *provider );
 
+gboolean nadp_desktop_provider_is_uri_writable  ( NadpDesktopProvider *provider, const gchar *uri );
+void     nadp_desktop_provider_reset_writability( NadpDesktopProvider *provider );
+
+void     nadp_desktop_provider_begin_batch      ( NadpDesktopProvider *provider );
+gboolean nadp_desktop_provider_is_in_batch      ( NadpDesktopProvider *provider );
+void     nadp_desktop_provider_stage_file       ( NadpDesktopProvider *provider, NadpDesktopFile *ndf );
+void     nadp_desktop_provider_unstage_file     ( NadpDesktopProvider *provider, NadpDesktopFile *ndf );
+gboolean nadp_desktop_provider_commit_batch     ( NadpDesktopProvider *provider, GSList **messages );
+
+void     nadp_desktop_provider_record_write     ( NadpDesktopProvider *provider, NadpDesktopFile *ndf );
+gboolean nadp_desktop_provider_is_own_write     ( NadpDesktopProvider *provider, const gchar *path );
+
 G_END_DECLS
 
 #endif /* __NADP_DESKTOP_PROVIDER_H__ */
@@ -33,6 +33,7 @@
 
 #include <api/na-extension.h>
 
+#include "nadp-desktop-file.h"
 #include "nadp-desktop-provider.h"
 
 /* the count of GType types provided by this extension
@@ -56,6 +57,11 @@ na_extension_startup( GTypeModule *module )
 
 	nadp_desktop_provider_register_type( module );
 
+	/* desktop files are instanciated by the importer worker threads,
+	 * while their lazy type registration is not thread-safe
+	 */
+	nadp_desktop_file_get_type();
+
 	return( TRUE );
 }
 
@@ -33,6 +33,8 @@
 
 #include <gio/gio.h>
 
+#include <api/na-core-utils.h>
+
 #include "nadp-monitor.h"
 
 /* private class data
@@ -61,6 +63,7 @@ static void   instance_dispose( GObject *object );
 static void   instance_finalize( GObject *object );
 
 static void   on_monitor_changed( GFileMonitor *monitor, GFile *file, GFile *other_file, GFileMonitorEvent event_type, NadpMonitor *my_monitor );
+static void   on_monitor_file_changed( NadpMonitor *my_monitor, GFile *file );
 
 GType
 nadp_monitor_get_type( void )
@@ -246,5 +249,48 @@ nadp_monitor_new( const NadpDesktopProvider *provider, const gchar *path )
 static void
 on_monitor_changed( GFileMonitor *monitor, GFile *file, GFile *other_file, GFileMonitorEvent event_type, NadpMonitor *my_monitor )
 {
-	nadp_desktop_provider_on_monitor_event( my_monitor->private->provider );
+	on_monitor_file_changed( my_monitor, file );
+
+	if( other_file ){
+		on_monitor_file_changed( my_monitor, other_file );
+	}
+}
+
+/*
+ * an event on the monitored directory itself requires a full reload;
+ * an event on a .desktop file only requires the corresponding item to
+ * be read again, unless the file is still in the state we have written
+ * it ourselves; other files are not read by the provider
+ */
+static void
+on_monitor_file_changed( NadpMonitor *my_monitor, GFile *file )
+{
+	static const gchar *thisfn = "nadp_monitor_on_monitor_file_changed";
+	gchar *bname;
+	gchar *id;
+	gchar *path;
+
+	if( g_file_equal( file, my_monitor->private->file )){
+		nadp_desktop_provider_on_monitor_event( my_monitor->private->provider, NULL );
+
+	} else {
+		bname = g_file_get_basename( file );
+
+		if( g_str_has_suffix( bname, NADP_DESKTOP_FILE_SUFFIX )){
+			path = g_file_get_path( file );
+
+			if( path && nadp_desktop_provider_is_own_write( my_monitor->private->provider, path )){
+				g_debug( "%s: %s: dropping event on our own write", thisfn, path );
+
+			} else {
+				id = na_core_utils_str_remove_suffix( bname, NADP_DESKTOP_FILE_SUFFIX );
+				nadp_desktop_provider_on_monitor_event( my_monitor->private->provider, id );
+				g_free( id );
+			}
+
+			g_free( path );
+		}
+
+		g_free( bname );
+	}
 }
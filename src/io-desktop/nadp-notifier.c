@@ -0,0 +1,201 @@
+/*
+ * Nautilus-Actions
+ * A Nautilus extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2014 Pierre Wieser and others (see AUTHORS)
+ *
+ * Nautilus-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * Nautilus-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nautilus-Actions; see the file COPYING. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@gnome-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <gio/gio.h>
+
+#include "nadp-notifier.h"
+
+#ifdef HAVE_GDBUS
+static GDBusConnection *st_bus          = NULL;
+static gboolean         st_bus_tried    = FALSE;
+static guint            st_subscription = 0;
+
+static GDBusConnection *get_bus( void );
+static void             on_items_changed( GDBusConnection *connection, const gchar *sender, const gchar *path, const gchar *iface, const gchar *signal, GVariant *parameters, NadpDesktopProvider *provider );
+#endif
+
+/**
+ * nadp_notifier_subscribe:
+ * @provider: this #NadpDesktopProvider object.
+ *
+ * Starts listening to the changes pushed by other processes.
+ * The received identifiers are handled as if they had been reported by
+ * our own monitors.
+ */
+void
+nadp_notifier_subscribe( NadpDesktopProvider *provider )
+{
+#ifdef HAVE_GDBUS
+	static const gchar *thisfn = "nadp_notifier_subscribe";
+	GDBusConnection *bus;
+
+	g_return_if_fail( NADP_IS_DESKTOP_PROVIDER( provider ));
+
+	if( !st_subscription ){
+		bus = get_bus();
+		if( bus ){
+			st_subscription = g_dbus_connection_signal_subscribe( bus,
+					NULL, NADP_NOTIFIER_IFACE, NADP_NOTIFIER_SIGNAL, NADP_NOTIFIER_PATH, NULL,
+					G_DBUS_SIGNAL_FLAGS_NONE, ( GDBusSignalCallback ) on_items_changed, provider, NULL );
+			g_debug( "%s: provider=%p, subscription=%u", thisfn, ( void * ) provider, st_subscription );
+		}
+	}
+#endif
+}
+
+/**
+ * nadp_notifier_unsubscribe:
+ * @provider: this #NadpDesktopProvider object.
+ *
+ * Stops listening to the changes pushed by other processes.
+ */
+void
+nadp_notifier_unsubscribe( NadpDesktopProvider *provider )
+{
+#ifdef HAVE_GDBUS
+	if( st_subscription ){
+		g_dbus_connection_signal_unsubscribe( st_bus, st_subscription );
+		st_subscription = 0;
+	}
+#endif
+}
+
+/**
+ * nadp_notifier_push:
+ * @ids: a list of identifiers of the items which have been written or
+ *  deleted by this process.
+ *
+ * Broadcasts the list to other processes.
+ *
+ * The message is flushed before returning, so that short-lived writers,
+ * as command-line utilities, do not exit before it has been sent.
+ */
+void
+nadp_notifier_push( GSList *ids )
+{
+#ifdef HAVE_GDBUS
+	static const gchar *thisfn = "nadp_notifier_push";
+	GDBusConnection *bus;
+	GVariantBuilder builder;
+	GSList *it;
+	GError *error;
+
+	if( !ids ){
+		return;
+	}
+
+	bus = get_bus();
+	if( !bus ){
+		return;
+	}
+
+	g_variant_builder_init( &builder, G_VARIANT_TYPE( "as" ));
+	for( it = ids ; it ; it = it->next ){
+		g_variant_builder_add( &builder, "s", ( const gchar * ) it->data );
+	}
+
+	error = NULL;
+	g_dbus_connection_emit_signal( bus,
+			NULL, NADP_NOTIFIER_PATH, NADP_NOTIFIER_IFACE, NADP_NOTIFIER_SIGNAL,
+			g_variant_new( "(as)", &builder ), &error );
+
+	if( error ){
+		g_warning( "%s: %s", thisfn, error->message );
+		g_error_free( error );
+
+	} else {
+		g_dbus_connection_flush_sync( bus, NULL, NULL );
+		g_debug( "%s: %u pushed identifier(s)", thisfn, g_slist_length( ids ));
+	}
+#endif
+}
+
+#ifdef HAVE_GDBUS
+/*
+ * the session bus is only tried once: there may be no session bus at
+ * all, e.g. when a command-line utility is run from a remote shell
+ */
+static GDBusConnection *
+get_bus( void )
+{
+	static const gchar *thisfn = "nadp_notifier_get_bus";
+	GError *error;
+
+	if( !st_bus_tried ){
+		st_bus_tried = TRUE;
+		error = NULL;
+		st_bus = g_bus_get_sync( G_BUS_TYPE_SESSION, NULL, &error );
+		if( error ){
+			g_debug( "%s: %s", thisfn, error->message );
+			g_error_free( error );
+			st_bus = NULL;
+		}
+	}
+
+	return( st_bus );
+}
+
+/*
+ * our own pushes are ignored, as are identifiers which could not be
+ * the basename of a .desktop file
+ */
+static void
+on_items_changed( GDBusConnection *connection, const gchar *sender, const gchar *path, const gchar *iface, const gchar *signal, GVariant *parameters, NadpDesktopProvider *provider )
+{
+	static const gchar *thisfn = "nadp_notifier_on_items_changed";
+	gchar **ids;
+	guint i;
+
+	if( !g_strcmp0( sender, g_dbus_connection_get_unique_name( connection ))){
+		return;
+	}
+
+	if( !g_variant_is_of_type( parameters, G_VARIANT_TYPE( "(as)" ))){
+		g_debug( "%s: unexpected parameters type %s", thisfn, g_variant_get_type_string( parameters ));
+		return;
+	}
+
+	g_variant_get( parameters, "(^a&s)", &ids );
+	g_debug( "%s: sender=%s, count=%u", thisfn, sender, g_strv_length( ids ));
+
+	for( i = 0 ; ids[i] ; ++i ){
+		if( strlen( ids[i] ) && !strchr( ids[i], G_DIR_SEPARATOR )){
+			nadp_desktop_provider_on_monitor_event( provider, ids[i] );
+		}
+	}
+
+	g_free( ids );
+}
+#endif
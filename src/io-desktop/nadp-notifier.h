@@ -0,0 +1,62 @@
+/*
+ * Nautilus-Actions
+ * A Nautilus extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2014 Pierre Wieser and others (see AUTHORS)
+ *
+ * Nautilus-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * Nautilus-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nautilus-Actions; see the file COPYING. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@gnome-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifndef __NADP_NOTIFIER_H__
+#define __NADP_NOTIFIER_H__
+
+/**
+ * SECTION: nadp_notifier
+ * @short_description: Desktop I/O provider notifications.
+ * @include: nadp-notifier.h
+ *
+ * When a process writes or deletes .desktop files, it broadcasts the
+ * identifiers of the modified items on the D-Bus session bus. Other
+ * processes, and first of all the &nautilus; plugin, so know which
+ * items have to be read again, without having to wait for, nor to
+ * interpret, the events of their own directory monitors.
+ *
+ * This is only available when GDBus is; else, the providers just rely
+ * on their monitors.
+ */
+
+#include "nadp-desktop-provider.h"
+
+G_BEGIN_DECLS
+
+#define NADP_NOTIFIER_PATH				"/org/nautilus_actions/DBus/Desktop"
+#define NADP_NOTIFIER_IFACE				"org.nautilus_actions.DBus.Desktop1"
+#define NADP_NOTIFIER_SIGNAL			"ItemsChanged"
+
+void nadp_notifier_subscribe  ( NadpDesktopProvider *provider );
+void nadp_notifier_unsubscribe( NadpDesktopProvider *provider );
+void nadp_notifier_push       ( GSList *ids );
+
+G_END_DECLS
+
+#endif /* __NADP_NOTIFIER_H__ */
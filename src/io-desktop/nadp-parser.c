@@ -0,0 +1,950 @@
+/*
+ * Nautilus-Actions
+ * A Nautilus extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2014 Pierre Wieser and others (see AUTHORS)
+ *
+ * Nautilus-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * Nautilus-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nautilus-Actions; see the file COPYING. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@gnome-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nadp-parser.h"
+
+/* a group, as a slice of the kept buffer
+ * a group which appears several times in the buffer is only recorded
+ * once, its keys being merged, as GKeyFile does
+ */
+typedef struct {
+	const gchar *name;
+	gsize        length;
+}
+	ParserGroup;
+
+/* a key and its raw value, as slices of the kept buffer
+ */
+typedef struct {
+	guint        group;
+	const gchar *key;
+	gsize        key_length;
+	const gchar *value;
+	gsize        value_length;
+}
+	ParserEntry;
+
+struct _NadpParser {
+	GArray *groups;
+	GArray *entries;
+	gchar  *buffer;
+};
+
+#define LIST_SEPARATOR				';'
+
+static gboolean           parse_line( NadpParser *parser, const gchar *line, gsize length, gint *current, GError **error );
+static gboolean           parse_group( NadpParser *parser, const gchar *line, const gchar *end, gint *current, GError **error );
+static gboolean           parse_key_value( NadpParser *parser, const gchar *line, const gchar *end, gint current, GError **error );
+static gboolean           is_group_line( const gchar *line, const gchar *end, const gchar **close );
+static gboolean           is_group_name( const gchar *name, gsize length );
+static gboolean           is_key_name( const gchar *key, gsize length );
+static gboolean           is_locale_kept( const gchar *key, gsize length );
+static void               keep_slices( NadpParser *parser );
+static gint               find_group( const NadpParser *parser, const gchar *group );
+static const ParserEntry *find_entry( const NadpParser *parser, const gchar *group, const gchar *key, GError **error );
+static const ParserEntry *find_locale_entry( const NadpParser *parser, gint group, const gchar *key, const gchar *locale );
+static gchar             *entry_get_string( const ParserEntry *entry, GError **error );
+static gchar             *unescape( const gchar *value, gsize length, GPtrArray *pieces, GError **error );
+
+/**
+ * nadp_parser_new:
+ * @data: the content of a .desktop file.
+ * @length: the length of @data.
+ * @error: a #GError.
+ *
+ * Tokenizes the @data buffer.
+ *
+ * Comments and translations which do not match the current locale are
+ * skipped, as GKeyFile does when it does not keep them; the kept slices
+ * are then copied in a single buffer owned by the parser, so that @data
+ * may be released as soon as this function returns.
+ *
+ * Returns: a newly allocated #NadpParser which should be nadp_parser_free()
+ * by the caller, or %NULL if @data is not a valid key file.
+ */
+NadpParser *
+nadp_parser_new( const gchar *data, gsize length, GError **error )
+{
+	NadpParser *parser;
+	const gchar *line, *eol, *end;
+	gsize line_length;
+	gint current;
+	gboolean ok;
+
+	g_return_val_if_fail( data || !length, NULL );
+
+	parser = g_new0( NadpParser, 1 );
+	parser->groups = g_array_new( FALSE, FALSE, sizeof( ParserGroup ));
+	parser->entries = g_array_new( FALSE, FALSE, sizeof( ParserEntry ));
+
+	ok = TRUE;
+	current = -1;
+	end = data + length;
+
+	for( line = data ; ok && line < end ; line = eol+1 ){
+		eol = memchr( line, '\n', end-line );
+		if( !eol ){
+			eol = end;
+		}
+		line_length = eol-line;
+		if( line_length && line[line_length-1] == '\r' ){
+			line_length -= 1;
+		}
+		ok = parse_line( parser, line, line_length, &current, error );
+	}
+
+	if( !ok ){
+		nadp_parser_free( parser );
+		parser = NULL;
+
+	} else {
+		keep_slices( parser );
+	}
+
+	return( parser );
+}
+
+/**
+ * nadp_parser_free:
+ * @parser: this #NadpParser.
+ *
+ * Releases the @parser.
+ */
+void
+nadp_parser_free( NadpParser *parser )
+{
+	if( parser ){
+		g_array_free( parser->groups, TRUE );
+		g_array_free( parser->entries, TRUE );
+		g_free( parser->buffer );
+		g_free( parser );
+	}
+}
+
+/**
+ * nadp_parser_get_start_group:
+ * @parser: this #NadpParser.
+ *
+ * Returns: the name of the first group, as a newly allocated string
+ * which should be g_free() by the caller, or %NULL.
+ */
+gchar *
+nadp_parser_get_start_group( const NadpParser *parser )
+{
+	ParserGroup *group;
+
+	g_return_val_if_fail( parser, NULL );
+
+	if( !parser->groups->len ){
+		return( NULL );
+	}
+
+	group = &g_array_index( parser->groups, ParserGroup, 0 );
+
+	return( g_strndup( group->name, group->length ));
+}
+
+/**
+ * nadp_parser_get_groups:
+ * @parser: this #NadpParser.
+ * @length: if not %NULL, set to the count of groups.
+ *
+ * Returns: the names of the groups, in the order they appear in the
+ * file, as a newly allocated %NULL-terminated array of strings which
+ * should be g_strfreev() by the caller.
+ */
+gchar **
+nadp_parser_get_groups( const NadpParser *parser, gsize *length )
+{
+	gchar **groups;
+	ParserGroup *group;
+	guint i;
+
+	g_return_val_if_fail( parser, NULL );
+
+	groups = g_new0( gchar *, parser->groups->len+1 );
+
+	for( i = 0 ; i < parser->groups->len ; ++i ){
+		group = &g_array_index( parser->groups, ParserGroup, i );
+		groups[i] = g_strndup( group->name, group->length );
+	}
+
+	if( length ){
+		*length = parser->groups->len;
+	}
+
+	return( groups );
+}
+
+/**
+ * nadp_parser_has_group:
+ * @parser: this #NadpParser.
+ * @group: the searched group.
+ *
+ * Returns: %TRUE if the @group exists, %FALSE else.
+ */
+gboolean
+nadp_parser_has_group( const NadpParser *parser, const gchar *group )
+{
+	g_return_val_if_fail( parser, FALSE );
+
+	return( find_group( parser, group ) >= 0 );
+}
+
+/**
+ * nadp_parser_has_key:
+ * @parser: this #NadpParser.
+ * @group: the searched group.
+ * @key: the searched key.
+ * @error: set if the @group does not exist.
+ *
+ * Returns: %TRUE if the @key exists in the @group, %FALSE else.
+ */
+gboolean
+nadp_parser_has_key( const NadpParser *parser, const gchar *group, const gchar *key, GError **error )
+{
+	GError *local_error;
+	const ParserEntry *entry;
+
+	g_return_val_if_fail( parser, FALSE );
+
+	local_error = NULL;
+	entry = find_entry( parser, group, key, &local_error );
+
+	if( local_error ){
+		if( local_error->code == G_KEY_FILE_ERROR_KEY_NOT_FOUND ){
+			g_error_free( local_error );
+		} else {
+			g_propagate_error( error, local_error );
+		}
+	}
+
+	return( entry != NULL );
+}
+
+/**
+ * nadp_parser_get_boolean:
+ * @parser: this #NadpParser.
+ * @group: the searched group.
+ * @key: the searched key.
+ * @error: a #GError.
+ *
+ * Returns: the value of the @key.
+ */
+gboolean
+nadp_parser_get_boolean( const NadpParser *parser, const gchar *group, const gchar *key, GError **error )
+{
+	const ParserEntry *entry;
+	gsize length, i;
+
+	g_return_val_if_fail( parser, FALSE );
+
+	entry = find_entry( parser, group, key, error );
+	if( !entry ){
+		return( FALSE );
+	}
+
+	/* trailing whitespaces are ignored
+	 */
+	for( length = 0, i = 0 ; i < entry->value_length ; ++i ){
+		if( !g_ascii_isspace( entry->value[i] )){
+			length = i+1;
+		}
+	}
+
+	if(( length == 4 && !strncmp( entry->value, "true", 4 )) ||
+		( length == 1 && entry->value[0] == '1' )){
+			return( TRUE );
+	}
+
+	if(( length == 5 && !strncmp( entry->value, "false", 5 )) ||
+		( length == 1 && entry->value[0] == '0' )){
+			return( FALSE );
+	}
+
+	g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+			"Key file contains key '%s' which has a value that cannot be interpreted.", key );
+
+	return( FALSE );
+}
+
+/**
+ * nadp_parser_get_integer:
+ * @parser: this #NadpParser.
+ * @group: the searched group.
+ * @key: the searched key.
+ * @error: a #GError.
+ *
+ * Returns: the value of the @key.
+ */
+gint
+nadp_parser_get_integer( const NadpParser *parser, const gchar *group, const gchar *key, GError **error )
+{
+	const ParserEntry *entry;
+	gchar *value, *eof;
+	glong long_value;
+	gint int_value;
+
+	g_return_val_if_fail( parser, 0 );
+
+	entry = find_entry( parser, group, key, error );
+	if( !entry ){
+		return( 0 );
+	}
+
+	/* strtol() needs a NUL-terminated string
+	 */
+	value = g_strndup( entry->value, entry->value_length );
+	errno = 0;
+	long_value = strtol( value, &eof, 10 );
+	int_value = ( gint ) long_value;
+
+	if( *value == '\0' || ( *eof != '\0' && !g_ascii_isspace( *eof ))){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+				"Value '%s' cannot be interpreted as a number.", value );
+		int_value = 0;
+
+	} else if( int_value != long_value || errno == ERANGE ){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+				"Integer value '%s' out of range", value );
+		int_value = 0;
+	}
+
+	g_free( value );
+
+	return( int_value );
+}
+
+/**
+ * nadp_parser_get_locale_string:
+ * @parser: this #NadpParser.
+ * @group: the searched group.
+ * @key: the searched key.
+ * @error: a #GError.
+ *
+ * Returns: the value of the @key, translated in the first possible
+ * language of the current locale, or untranslated, as a newly allocated
+ * string which should be g_free() by the caller.
+ */
+gchar *
+nadp_parser_get_locale_string( const NadpParser *parser, const gchar *group, const gchar *key, GError **error )
+{
+	const gchar * const *languages;
+	const ParserEntry *entry;
+	GError *local_error;
+	gchar *value;
+	gint igroup;
+	guint i;
+
+	g_return_val_if_fail( parser, NULL );
+	g_return_val_if_fail( key, NULL );
+
+	value = NULL;
+	igroup = find_group( parser, group );
+
+	if( igroup >= 0 ){
+		languages = g_get_language_names();
+
+		for( i = 0 ; !value && languages[i] ; ++i ){
+			entry = find_locale_entry( parser, igroup, key, languages[i] );
+
+			/* as GKeyFile does, an invalid escape sequence is not an error
+			 * here, but a translation which is not UTF-8 is ignored
+			 */
+			if( entry ){
+				local_error = NULL;
+				value = entry_get_string( entry, &local_error );
+				if( local_error ){
+					g_error_free( local_error );
+				}
+			}
+		}
+	}
+
+	if( !value ){
+		local_error = NULL;
+		value = nadp_parser_get_string( parser, group, key, &local_error );
+		if( local_error ){
+			if( value ){
+				g_error_free( local_error );
+			} else {
+				g_propagate_error( error, local_error );
+			}
+		}
+	}
+
+	return( value );
+}
+
+/**
+ * nadp_parser_get_string:
+ * @parser: this #NadpParser.
+ * @group: the searched group.
+ * @key: the searched key.
+ * @error: a #GError.
+ *
+ * Returns: the unescaped value of the @key, as a newly allocated string
+ * which should be g_free() by the caller, or %NULL. As with GKeyFile,
+ * a string may be returned even if @error is set.
+ */
+gchar *
+nadp_parser_get_string( const NadpParser *parser, const gchar *group, const gchar *key, GError **error )
+{
+	const ParserEntry *entry;
+
+	g_return_val_if_fail( parser, NULL );
+
+	entry = find_entry( parser, group, key, error );
+	if( !entry ){
+		return( NULL );
+	}
+
+	return( entry_get_string( entry, error ));
+}
+
+/**
+ * nadp_parser_get_string_list:
+ * @parser: this #NadpParser.
+ * @group: the searched group.
+ * @key: the searched key.
+ * @length: if not %NULL, set to the count of returned strings.
+ * @error: a #GError.
+ *
+ * Returns: the unescaped ';'-separated values of the @key, as a newly
+ * allocated %NULL-terminated array of strings which should be
+ * g_strfreev() by the caller, or %NULL.
+ */
+gchar **
+nadp_parser_get_string_list( const NadpParser *parser, const gchar *group, const gchar *key, gsize *length, GError **error )
+{
+	const ParserEntry *entry;
+	GPtrArray *pieces;
+	GError *local_error;
+	gchar *string;
+
+	g_return_val_if_fail( parser, NULL );
+
+	if( length ){
+		*length = 0;
+	}
+
+	entry = find_entry( parser, group, key, error );
+	if( !entry ){
+		return( NULL );
+	}
+
+	if( !g_utf8_validate( entry->value, entry->value_length, NULL )){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_UNKNOWN_ENCODING,
+				"Key file contains key '%s' with value which is not UTF-8", key );
+		return( NULL );
+	}
+
+	local_error = NULL;
+	pieces = g_ptr_array_new();
+	string = unescape( entry->value, entry->value_length, pieces, &local_error );
+	g_free( string );
+
+	if( local_error ){
+		g_propagate_error( error, local_error );
+		g_ptr_array_foreach( pieces, ( GFunc ) g_free, NULL );
+		g_ptr_array_free( pieces, TRUE );
+		return( NULL );
+	}
+
+	if( length ){
+		*length = pieces->len;
+	}
+	g_ptr_array_add( pieces, NULL );
+
+	return(( gchar ** ) g_ptr_array_free( pieces, FALSE ));
+}
+
+static gboolean
+parse_line( NadpParser *parser, const gchar *line, gsize length, gint *current, GError **error )
+{
+	const gchar *start, *end, *close;
+
+	start = line;
+	end = line + length;
+
+	while( start < end && g_ascii_isspace( *start )){
+		start++;
+	}
+
+	/* empty lines and comments
+	 */
+	if( start == end || *start == '#' ){
+		return( TRUE );
+	}
+
+	if( is_group_line( start, end, &close )){
+		return( parse_group( parser, start+1, close, current, error ));
+	}
+
+	if( *start != '=' && memchr( start, '=', end-start )){
+		return( parse_key_value( parser, start, end, *current, error ));
+	}
+
+	g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE,
+			"Key file contains line '%.*s' which is not a key-value pair, group, or comment", ( gint ) length, line );
+
+	return( FALSE );
+}
+
+/*
+ * a group line is '[name]', only followed by spaces or tabulations
+ */
+static gboolean
+is_group_line( const gchar *line, const gchar *end, const gchar **close )
+{
+	const gchar *p;
+
+	if( *line != '[' ){
+		return( FALSE );
+	}
+
+	for( p = line+1 ; p < end && *p != ']' ; ++p )
+		;
+
+	if( p == end ){
+		return( FALSE );
+	}
+
+	*close = p;
+
+	for( p++ ; p < end && ( *p == ' ' || *p == '\t' ) ; ++p )
+		;
+
+	return( p == end );
+}
+
+static gboolean
+parse_group( NadpParser *parser, const gchar *name, const gchar *end, gint *current, GError **error )
+{
+	ParserGroup group;
+	ParserGroup *igroup;
+	gsize length;
+	guint i;
+
+	length = end-name;
+
+	if( !is_group_name( name, length )){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE,
+				"Invalid group name: %.*s", ( gint ) length, name );
+		return( FALSE );
+	}
+
+	for( i = 0 ; i < parser->groups->len ; ++i ){
+		igroup = &g_array_index( parser->groups, ParserGroup, i );
+		if( igroup->length == length && !memcmp( igroup->name, name, length )){
+			*current = i;
+			return( TRUE );
+		}
+	}
+
+	group.name = name;
+	group.length = length;
+	g_array_append_val( parser->groups, group );
+	*current = parser->groups->len-1;
+
+	return( TRUE );
+}
+
+static gboolean
+is_group_name( const gchar *name, gsize length )
+{
+	gsize i;
+
+	if( !length ){
+		return( FALSE );
+	}
+
+	for( i = 0 ; i < length ; ++i ){
+		if( name[i] == '[' || name[i] == ']' || g_ascii_iscntrl( name[i] )){
+			return( FALSE );
+		}
+	}
+
+	return( TRUE );
+}
+
+static gboolean
+parse_key_value( NadpParser *parser, const gchar *line, const gchar *end, gint current, GError **error )
+{
+	ParserEntry entry;
+	const gchar *equal, *key_end, *value;
+
+	if( current < 0 ){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+				"Key file does not start with a group" );
+		return( FALSE );
+	}
+
+	equal = memchr( line, '=', end-line );
+
+	for( key_end = equal ; key_end > line && g_ascii_isspace( key_end[-1] ) ; --key_end )
+		;
+
+	if( !is_key_name( line, key_end-line )){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE,
+				"Invalid key name: %.*s", ( gint )( key_end-line ), line );
+		return( FALSE );
+	}
+
+	/* as GKeyFile does, a translation which is not one of the current
+	 * locale is ignored once the key name has been validated
+	 */
+	if( !is_locale_kept( line, key_end-line )){
+		return( TRUE );
+	}
+
+	for( value = equal+1 ; value < end && g_ascii_isspace( *value ) ; ++value )
+		;
+
+	/* only UTF-8 is accepted in the start group
+	 */
+	if( current == 0 && key_end-line == 8 && !strncmp( line, "Encoding", 8 ) &&
+		!( end-value == 5 && !g_ascii_strncasecmp( value, "UTF-8", 5 ))){
+
+			g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_UNKNOWN_ENCODING,
+					"Key file contains unsupported encoding '%.*s'", ( gint )( end-value ), value );
+			return( FALSE );
+	}
+
+	entry.group = current;
+	entry.key = line;
+	entry.key_length = key_end-line;
+	entry.value = value;
+	entry.value_length = end-value;
+	g_array_append_val( parser->entries, entry );
+
+	return( TRUE );
+}
+
+/*
+ * a key name is not empty, does not start nor end with a space, and may
+ * be followed by a '[locale]' suffix
+ */
+static gboolean
+is_key_name( const gchar *key, gsize length )
+{
+	const gchar *p, *end;
+
+	end = key + length;
+
+	for( p = key ; p < end && *p != '=' && *p != '[' && *p != ']' ; ++p )
+		;
+
+	if( p == key || *key == ' ' || p[-1] == ' ' ){
+		return( FALSE );
+	}
+
+	if( p < end && *p == '[' ){
+		for( p++ ; p < end && ( g_ascii_isalnum( *p ) || *p == '-' || *p == '_' || *p == '.' || *p == '@' ) ; ++p )
+			;
+
+		if( p == end || *p != ']' ){
+			return( FALSE );
+		}
+		p++;
+	}
+
+	return( p == end );
+}
+
+/*
+ * a key without '[locale]' suffix is always kept; a translation is kept
+ * if its locale is one of the language names of the current locale
+ */
+static gboolean
+is_locale_kept( const gchar *key, gsize length )
+{
+	const gchar * const *languages;
+	const gchar *locale;
+	gsize locale_length;
+	guint i;
+
+	if( key[length-1] != ']' ){
+		return( TRUE );
+	}
+
+	locale = memchr( key, '[', length );
+	locale += 1;
+	locale_length = key + length - 1 - locale;
+	languages = g_get_language_names();
+
+	for( i = 0 ; languages[i] ; ++i ){
+		if( strlen( languages[i] ) == locale_length &&
+			!g_ascii_strncasecmp( languages[i], locale, locale_length )){
+				return( TRUE );
+		}
+	}
+
+	return( FALSE );
+}
+
+/*
+ * copy the kept slices of the parsed buffer in a single allocation,
+ * and make the groups and entries point to this copy
+ */
+static void
+keep_slices( NadpParser *parser )
+{
+	ParserGroup *group;
+	ParserEntry *entry;
+	gsize size;
+	gchar *p;
+	guint i;
+
+	size = 0;
+	for( i = 0 ; i < parser->groups->len ; ++i ){
+		size += g_array_index( parser->groups, ParserGroup, i ).length;
+	}
+	for( i = 0 ; i < parser->entries->len ; ++i ){
+		entry = &g_array_index( parser->entries, ParserEntry, i );
+		size += entry->key_length + entry->value_length;
+	}
+
+	parser->buffer = g_malloc( size+1 );
+	p = parser->buffer;
+
+	for( i = 0 ; i < parser->groups->len ; ++i ){
+		group = &g_array_index( parser->groups, ParserGroup, i );
+		memcpy( p, group->name, group->length );
+		group->name = p;
+		p += group->length;
+	}
+	for( i = 0 ; i < parser->entries->len ; ++i ){
+		entry = &g_array_index( parser->entries, ParserEntry, i );
+		memcpy( p, entry->key, entry->key_length );
+		entry->key = p;
+		p += entry->key_length;
+		memcpy( p, entry->value, entry->value_length );
+		entry->value = p;
+		p += entry->value_length;
+	}
+}
+
+static gint
+find_group( const NadpParser *parser, const gchar *group )
+{
+	ParserGroup *igroup;
+	gsize length;
+	guint i;
+
+	if( group ){
+		length = strlen( group );
+
+		for( i = 0 ; i < parser->groups->len ; ++i ){
+			igroup = &g_array_index( parser->groups, ParserGroup, i );
+			if( igroup->length == length && !memcmp( igroup->name, group, length )){
+				return( i );
+			}
+		}
+	}
+
+	return( -1 );
+}
+
+/*
+ * when a key appears several times in a group, the last one wins
+ */
+static const ParserEntry *
+find_entry( const NadpParser *parser, const gchar *group, const gchar *key, GError **error )
+{
+	const ParserEntry *entry;
+	gint igroup;
+	gsize length;
+	guint i;
+
+	igroup = find_group( parser, group );
+
+	if( igroup < 0 ){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+				"Key file does not have group '%s'", group ? group : "(null)" );
+		return( NULL );
+	}
+
+	length = key ? strlen( key ) : 0;
+
+	for( i = parser->entries->len ; i > 0 ; --i ){
+		entry = &g_array_index( parser->entries, ParserEntry, i-1 );
+		if( entry->group == ( guint ) igroup &&
+			entry->key_length == length &&
+			!memcmp( entry->key, key, length )){
+				return( entry );
+		}
+	}
+
+	g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_KEY_NOT_FOUND,
+			"Key file does not have key '%s' in group '%s'", key, group );
+
+	return( NULL );
+}
+
+/*
+ * search for 'key[locale]' without building the candidate key
+ */
+static const ParserEntry *
+find_locale_entry( const NadpParser *parser, gint group, const gchar *key, const gchar *locale )
+{
+	const ParserEntry *entry;
+	gsize key_length, locale_length;
+	guint i;
+
+	key_length = strlen( key );
+	locale_length = strlen( locale );
+
+	for( i = parser->entries->len ; i > 0 ; --i ){
+		entry = &g_array_index( parser->entries, ParserEntry, i-1 );
+		if( entry->group == ( guint ) group &&
+			entry->key_length == key_length + locale_length + 2 &&
+			!memcmp( entry->key, key, key_length ) &&
+			entry->key[key_length] == '[' &&
+			!memcmp( entry->key+key_length+1, locale, locale_length ) &&
+			entry->key[entry->key_length-1] == ']' ){
+				return( entry );
+		}
+	}
+
+	return( NULL );
+}
+
+static gchar *
+entry_get_string( const ParserEntry *entry, GError **error )
+{
+	GError *local_error;
+	gchar *string;
+
+	if( !g_utf8_validate( entry->value, entry->value_length, NULL )){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_UNKNOWN_ENCODING,
+				"Key file contains key '%.*s' with value which is not UTF-8", ( gint ) entry->key_length, entry->key );
+		return( NULL );
+	}
+
+	/* as GKeyFile does, the unescaped string is returned even if an
+	 * invalid escape sequence has been found
+	 */
+	local_error = NULL;
+	string = unescape( entry->value, entry->value_length, NULL, &local_error );
+
+	if( local_error ){
+		g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+				"Key file contains key '%.*s' which has a value that cannot be interpreted.", ( gint ) entry->key_length, entry->key );
+		g_error_free( local_error );
+	}
+
+	return( string );
+}
+
+/*
+ * unescapes the value in a single allocation
+ * if @pieces is not %NULL, the value is also split on unescaped list
+ * separators, and '\;' is a valid escape sequence
+ */
+static gchar *
+unescape( const gchar *value, gsize length, GPtrArray *pieces, GError **error )
+{
+	gchar *string, *q, *q0;
+	const gchar *p, *end;
+
+	string = g_malloc( length+1 );
+	q = q0 = string;
+	end = value + length;
+
+	for( p = value ; p < end ; ++p ){
+
+		if( *p == '\\' ){
+			p++;
+
+			if( p == end ){
+				if( error && !*error ){
+					g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+							"Key file contains escape character at end of line" );
+				}
+				break;
+			}
+
+			switch( *p ){
+				case 's':
+					*q = ' ';
+					break;
+				case 'n':
+					*q = '\n';
+					break;
+				case 't':
+					*q = '\t';
+					break;
+				case 'r':
+					*q = '\r';
+					break;
+				case '\\':
+					*q = '\\';
+					break;
+				default:
+					if( pieces && *p == LIST_SEPARATOR ){
+						*q = LIST_SEPARATOR;
+					} else {
+						*q++ = '\\';
+						*q = *p;
+						if( error && !*error ){
+							g_set_error( error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+									"Key file contains invalid escape sequence '\\%c'", *p );
+						}
+					}
+					break;
+			}
+
+		} else {
+			*q = *p;
+			if( pieces && *p == LIST_SEPARATOR ){
+				g_ptr_array_add( pieces, g_strndup( q0, q-q0 ));
+				q0 = q+1;
+			}
+		}
+
+		q++;
+	}
+
+	*q = '\0';
+
+	if( pieces && q0 < q ){
+		g_ptr_array_add( pieces, g_strndup( q0, q-q0 ));
+	}
+
+	return( string );
+}
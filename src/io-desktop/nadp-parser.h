@@ -0,0 +1,75 @@
+/*
+ * Nautilus-Actions
+ * A Nautilus extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2014 Pierre Wieser and others (see AUTHORS)
+ *
+ * Nautilus-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * Nautilus-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nautilus-Actions; see the file COPYING. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@gnome-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifndef __NADP_PARSER_H__
+#define __NADP_PARSER_H__
+
+/**
+ * SECTION: nadp_parser
+ * @short_description: Read-only .desktop file parser.
+ * @include: nadp-parser.h
+ *
+ * The parser tokenizes the content of a .desktop file in place: it
+ * records the position of the groups, keys and values, skipping the
+ * comments and the translations which do not match the current locale,
+ * and only copies these kept slices once in a single buffer. Values are
+ * not unescaped until they are actually asked for, and then directly in
+ * the returned string.
+ *
+ * It is meant to replace GKeyFile when items are only read, and so
+ * reproduces the GKeyFile semantics: same syntax errors, same escape
+ * sequences, same lookup of the localized strings, same error codes
+ * in the G_KEY_FILE_ERROR domain.
+ *
+ * The parsed buffer is no more used once the parser has been built.
+ */
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _NadpParser NadpParser;
+
+NadpParser *nadp_parser_new              ( const gchar *data, gsize length, GError **error );
+void        nadp_parser_free             ( NadpParser *parser );
+
+gchar      *nadp_parser_get_start_group  ( const NadpParser *parser );
+gchar     **nadp_parser_get_groups       ( const NadpParser *parser, gsize *length );
+gboolean    nadp_parser_has_group        ( const NadpParser *parser, const gchar *group );
+gboolean    nadp_parser_has_key          ( const NadpParser *parser, const gchar *group, const gchar *key, GError **error );
+
+gboolean    nadp_parser_get_boolean      ( const NadpParser *parser, const gchar *group, const gchar *key, GError **error );
+gint        nadp_parser_get_integer      ( const NadpParser *parser, const gchar *group, const gchar *key, GError **error );
+gchar      *nadp_parser_get_locale_string( const NadpParser *parser, const gchar *group, const gchar *key, GError **error );
+gchar      *nadp_parser_get_string       ( const NadpParser *parser, const gchar *group, const gchar *key, GError **error );
+gchar     **nadp_parser_get_string_list  ( const NadpParser *parser, const gchar *group, const gchar *key, gsize *length, GError **error );
+
+G_END_DECLS
+
+#endif /* __NADP_PARSER_H__ */
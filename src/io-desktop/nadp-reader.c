@@ -31,9 +31,14 @@
 #include <config.h>
 #endif
 
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <glib/gi18n.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <api/na-core-utils.h>
 #include <api/na-data-types.h>
@@ -41,10 +46,11 @@
 #include <api/na-ifactory-provider.h>
 #include <api/na-object-api.h>
 
+#include "nadp-cache.h"
 #include "nadp-desktop-provider.h"
 #include "nadp-keys.h"
+#include "nadp-notifier.h"
 #include "nadp-reader.h"
-#include "nadp-utils.h"
 #include "nadp-xdg-dirs.h"
 
 typedef struct {
@@ -61,13 +67,44 @@ typedef struct {
 }
 	NadpReaderData;
 
+/* the structure filled by a worker thread when parsing a .desktop file
+ */
+typedef struct {
+	DesktopPath     *dps;
+	gchar           *data;
+	gsize            length;
+	NadpDesktopFile *ndf;
+}
+	NadpParseData;
+
+/* the structure passed to the content cache reader
+ */
+typedef struct {
+	const NadpDesktopProvider *provider;
+	GList                     *items;
+	GSList                   **messages;
+}
+	NadpCacheData;
+
 #define ERR_NOT_DESKTOP		_( "The Desktop I/O Provider is not able to handle the URI" )
 
-static GList            *get_list_of_desktop_paths( NadpDesktopProvider *provider, GSList **mesages );
-static void              get_list_of_desktop_files( const NadpDesktopProvider *provider, GList **files, const gchar *dir, GSList **messages );
-static gboolean          is_already_loaded( const NadpDesktopProvider *provider, GList *files, const gchar *desktop_id );
+/* .desktop files are parsed in parallel when there is at least this
+ * count of files, with at most this count of worker threads
+ */
+#define PARSE_THREADS_MIN_FILES		32
+#define PARSE_THREADS_MAX			16
+
+static GSList           *get_list_of_desktop_dirs( void );
+static GList            *get_list_of_desktop_paths( NadpDesktopProvider *provider, GSList *dirs, GSList **mesages );
+static void              get_list_of_desktop_files( const NadpDesktopProvider *provider, GList **files, GHashTable *loaded, const gchar *dir, GSList **messages );
+static void              add_desktop_file( const NadpDesktopProvider *provider, GList **files, GHashTable *loaded, const gchar *dir, const gchar *name );
 static GList            *desktop_path_from_id( const NadpDesktopProvider *provider, GList *files, const gchar *dir, const gchar *id );
+static gchar            *find_desktop_id( const gchar *dir, const gchar *folded );
+static GList            *items_from_desktop_paths( const NadpDesktopProvider *provider, GList *desktop_paths, NadpCacheWriter *writer, GSList **messages );
+static guint             get_parse_threads( guint count );
+static void              parse_desktop_path( NadpParseData *parse, void *empty );
 static NAIFactoryObject *item_from_desktop_path( const NadpDesktopProvider *provider, DesktopPath *dps, GSList **messages );
+static void              item_from_cache( const gchar *path, const gchar *data, gsize length, NadpCacheData *cache_data );
 static NAIFactoryObject *item_from_desktop_file( const NadpDesktopProvider *provider, NadpDesktopFile *ndf, GSList **messages );
 static void              desktop_weak_notify( NadpDesktopFile *ndf, GObject *item );
 static void              free_desktop_paths( GList *paths );
@@ -89,8 +126,10 @@ nadp_iio_provider_read_items( const NAIIOProvider *provider, GSList **messages )
 {
 	static const gchar *thisfn = "nadp_iio_provider_read_items";
 	GList *items;
-	GList *desktop_paths, *ip;
-	NAIFactoryObject *item;
+	GSList *dirs, *idir;
+	GList *desktop_paths;
+	NadpCacheData cache_data;
+	NadpCacheWriter *writer;
 
 	g_debug( "%s: provider=%p (%s), messages=%p",
 			thisfn, ( void * ) provider, G_OBJECT_TYPE_NAME( provider ), ( void * ) messages );
@@ -99,43 +138,114 @@ nadp_iio_provider_read_items( const NAIIOProvider *provider, GSList **messages )
 
 	items = NULL;
 	nadp_desktop_provider_release_monitors( NADP_DESKTOP_PROVIDER( provider ));
+	nadp_desktop_provider_reset_writability( NADP_DESKTOP_PROVIDER( provider ));
 
-	desktop_paths = get_list_of_desktop_paths( NADP_DESKTOP_PROVIDER( provider ), messages );
-	for( ip = desktop_paths ; ip ; ip = ip->next ){
+	dirs = get_list_of_desktop_dirs();
+	for( idir = dirs ; idir ; idir = idir->next ){
+		nadp_desktop_provider_add_monitor( NADP_DESKTOP_PROVIDER( provider ), ( const gchar * ) idir->data );
+	}
+	nadp_notifier_subscribe( NADP_DESKTOP_PROVIDER( provider ));
 
-		item = item_from_desktop_path( NADP_DESKTOP_PROVIDER( provider ), ( DesktopPath * ) ip->data, messages );
+	/* first try to get the items from the content cache
+	 * when the cache is not valid, scan the directories and rebuild it
+	 */
+	cache_data.provider = NADP_DESKTOP_PROVIDER( provider );
+	cache_data.items = NULL;
+	cache_data.messages = messages;
 
-		if( item ){
-			items = g_list_prepend( items, item );
-			na_object_dump( item );
-		}
+	if( nadp_cache_read( dirs, ( NadpCacheReadFn ) item_from_cache, &cache_data )){
+		items = g_list_reverse( cache_data.items );
+
+	} else {
+		writer = nadp_cache_writer_new( dirs );
+		desktop_paths = get_list_of_desktop_paths( NADP_DESKTOP_PROVIDER( provider ), dirs, messages );
+
+		/* desktop paths are built by prepending: restore the order of
+		 * preference so that the cache is written in the same order
+		 * than the one it will be read
+		 */
+		desktop_paths = g_list_reverse( desktop_paths );
+
+		items = items_from_desktop_paths( NADP_DESKTOP_PROVIDER( provider ), desktop_paths, writer, messages );
+
+		free_desktop_paths( desktop_paths );
+		nadp_cache_writer_close( writer );
 	}
 
-	free_desktop_paths( desktop_paths );
+	na_core_utils_slist_free( dirs );
 
 	g_debug( "%s: count=%d", thisfn, g_list_length( items ));
 	return( items );
 }
 
 /*
- * returns a list of DesktopPath items
+ * Returns a newly allocated NAObjectItem-derived object, read from the
+ * most preferred .desktop file for this id, or NULL if none is found
+ *
+ * As in nadp_iio_provider_read_items(), the most preferred file shadows
+ * the other ones, even if it is not a valid .desktop file, and ids are
+ * compared case-insensitively.
+ *
+ * This is implementation of NAIIOProvider::read_item method
+ */
+NAObjectItem *
+nadp_iio_provider_read_item( const NAIIOProvider *provider, const gchar *id, GSList **messages )
+{
+	static const gchar *thisfn = "nadp_iio_provider_read_item";
+	NAIFactoryObject *item;
+	GSList *dirs, *idir;
+	DesktopPath dps;
+	gchar *folded, *bname;
+
+	g_debug( "%s: provider=%p (%s), id=%s, messages=%p",
+			thisfn, ( void * ) provider, G_OBJECT_TYPE_NAME( provider ), id, ( void * ) messages );
+
+	g_return_val_if_fail( NA_IS_IIO_PROVIDER( provider ), NULL );
+
+	item = NULL;
+	dps.id = NULL;
+	dirs = get_list_of_desktop_dirs();
+	folded = g_ascii_strdown( id, -1 );
+
+	for( idir = dirs ; idir && !dps.id ; idir = idir->next ){
+		dps.id = find_desktop_id(( const gchar * ) idir->data, folded );
+
+		if( dps.id ){
+			bname = g_strdup_printf( "%s%s", dps.id, NADP_DESKTOP_FILE_SUFFIX );
+			dps.path = g_build_filename(( const gchar * ) idir->data, bname, NULL );
+			g_free( bname );
+			item = item_from_desktop_path( NADP_DESKTOP_PROVIDER( provider ), &dps, messages );
+			if( item ){
+				na_object_dump( item );
+			}
+			g_free( dps.path );
+		}
+	}
+
+	g_free( dps.id );
+	g_free( folded );
+	na_core_utils_slist_free( dirs );
+
+	return( item ? NA_OBJECT_ITEM( item ) : NULL );
+}
+
+/*
+ * returns the ordered list of the directories to be scanned
  *
  * we get the ordered list of XDG_DATA_DIRS, and the ordered list of
- *  subdirs to add; then for each item of each list, we search for
- *  .desktop files in the resulted built path
+ *  subdirs to add
  *
- * the returned list is so a list of DesktopPath struct, in
- * the ordered of preference (most preferred first)
+ * the returned list should be na_core_utils_slist_free() by the caller
  */
-static GList *
-get_list_of_desktop_paths( NadpDesktopProvider *provider, GSList **messages )
+static GSList *
+get_list_of_desktop_dirs( void )
 {
-	GList *files;
+	GSList *dirs;
 	GSList *xdg_dirs, *idir;
 	GSList *subdirs, *isub;
 	gchar *dir;
 
-	files = NULL;
+	dirs = NULL;
 	xdg_dirs = nadp_xdg_dirs_get_data_dirs();
 	subdirs = na_core_utils_slist_from_split( NADP_DESKTOP_PROVIDER_SUBDIRS, G_SEARCHPATH_SEPARATOR_S );
 
@@ -148,84 +258,183 @@ get_list_of_desktop_paths( NadpDesktopProvider *provider, GSList **messages )
 		for( isub = subdirs ; isub ; isub = isub->next ){
 
 			dir = g_build_filename(( gchar * ) idir->data, ( gchar * ) isub->data, NULL );
-			nadp_desktop_provider_add_monitor( provider, dir );
-			get_list_of_desktop_files( provider, &files, dir, messages );
-			g_free( dir );
+			dirs = g_slist_prepend( dirs, dir );
 		}
 	}
 
 	na_core_utils_slist_free( subdirs );
 	na_core_utils_slist_free( xdg_dirs );
 
+	return( g_slist_reverse( dirs ));
+}
+
+/*
+ * returns a list of DesktopPath items
+ *
+ * for each directory, we search for .desktop files
+ *
+ * the returned list is so a list of DesktopPath struct, in
+ * the reverse order of preference (most preferred last)
+ */
+static GList *
+get_list_of_desktop_paths( NadpDesktopProvider *provider, GSList *dirs, GSList **messages )
+{
+	GList *files;
+	GSList *idir;
+	GHashTable *loaded;
+
+	files = NULL;
+
+	/* set of the already loaded ids, case-folded
+	 */
+	loaded = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+
+	for( idir = dirs ; idir ; idir = idir->next ){
+		get_list_of_desktop_files( provider, &files, loaded, ( const gchar * ) idir->data, messages );
+	}
+
+	g_hash_table_destroy( loaded );
+
 	return( files );
 }
 
 /*
  * scans the directory for .desktop files
  * only adds to the list those which have not been yet loaded
+ *
+ * the directory is opened once, and then enumerated relatively to its
+ * file descriptor; the entry type returned by readdir() lets us skip
+ * other entries than regular files without any stat() (which is only
+ * needed for symbolic links and file systems which do not fill d_type)
  */
+#ifdef HAVE_FDOPENDIR
+static void
+get_list_of_desktop_files( const NadpDesktopProvider *provider, GList **files, GHashTable *loaded, const gchar *dir, GSList **messages )
+{
+	static const gchar *thisfn = "nadp_reader_get_list_of_desktop_files";
+	int dir_fd;
+	DIR *dir_handle;
+	struct dirent *entry;
+	gboolean is_file;
+#ifdef HAVE_FSTATAT
+	struct stat buf;
+#endif
+
+	g_debug( "%s: provider=%p, files=%p, dir=%s, messages=%p",
+			thisfn, ( void * ) provider, ( void * ) files, dir, ( void * ) messages );
+
+	dir_fd = open( dir, O_RDONLY | O_DIRECTORY );
+	if( dir_fd < 0 ){
+		/* do not warn when the directory just doesn't exist
+		 */
+		if( errno == ENOENT || errno == ENOTDIR ){
+			g_debug( "%s: %s: directory doesn't exist", thisfn, dir );
+		} else {
+			g_warning( "%s: %s: %s", thisfn, dir, g_strerror( errno ));
+		}
+		return;
+	}
+
+	dir_handle = fdopendir( dir_fd );
+	if( !dir_handle ){
+		g_warning( "%s: %s: %s", thisfn, dir, g_strerror( errno ));
+		close( dir_fd );
+		return;
+	}
+
+	while(( entry = readdir( dir_handle ))){
+
+		if( !g_str_has_suffix( entry->d_name, NADP_DESKTOP_FILE_SUFFIX )){
+			continue;
+		}
+
+		switch( entry->d_type ){
+			case DT_REG:
+				is_file = TRUE;
+				break;
+
+			case DT_LNK:
+			case DT_UNKNOWN:
+#ifdef HAVE_FSTATAT
+				is_file = ( fstatat( dir_fd, entry->d_name, &buf, 0 ) == 0 && S_ISREG( buf.st_mode ));
+#else
+				is_file = TRUE;
+#endif
+				break;
+
+			default:
+				is_file = FALSE;
+				break;
+		}
+
+		if( is_file ){
+			add_desktop_file( provider, files, loaded, dir, entry->d_name );
+		}
+	}
+
+	/* this also closes dir_fd */
+	closedir( dir_handle );
+}
+#else
 static void
-get_list_of_desktop_files( const NadpDesktopProvider *provider, GList **files, const gchar *dir, GSList **messages )
+get_list_of_desktop_files( const NadpDesktopProvider *provider, GList **files, GHashTable *loaded, const gchar *dir, GSList **messages )
 {
 	static const gchar *thisfn = "nadp_reader_get_list_of_desktop_files";
 	GDir *dir_handle;
 	GError *error;
 	const gchar *name;
-	gchar *desktop_id;
 
-	g_debug( "%s: provider=%p, files=%p (count=%d), dir=%s, messages=%p",
-			thisfn, ( void * ) provider, ( void * ) files, g_list_length( *files ), dir, ( void * ) messages );
+	g_debug( "%s: provider=%p, files=%p, dir=%s, messages=%p",
+			thisfn, ( void * ) provider, ( void * ) files, dir, ( void * ) messages );
 
 	error = NULL;
-	dir_handle = NULL;
+	dir_handle = g_dir_open( dir, 0, &error );
 
-	/* do not warn when the directory just doesn't exist
-	 */
-	if( g_file_test( dir, G_FILE_TEST_IS_DIR )){
-		dir_handle = g_dir_open( dir, 0, &error );
-		if( error ){
+	if( error ){
+		/* do not warn when the directory just doesn't exist
+		 */
+		if( g_error_matches( error, G_FILE_ERROR, G_FILE_ERROR_NOENT ) ||
+			g_error_matches( error, G_FILE_ERROR, G_FILE_ERROR_NOTDIR )){
+				g_debug( "%s: %s: directory doesn't exist", thisfn, dir );
+		} else {
 			g_warning( "%s: %s: %s", thisfn, dir, error->message );
-			g_error_free( error );
-			goto close_dir_handle;
 		}
-	} else {
-		g_debug( "%s: %s: directory doesn't exist", thisfn, dir );
+		g_error_free( error );
+		return;
 	}
 
-	if( dir_handle ){
-		while(( name = g_dir_read_name( dir_handle ))){
-			if( g_str_has_suffix( name, NADP_DESKTOP_FILE_SUFFIX )){
-				desktop_id = na_core_utils_str_remove_suffix( name, NADP_DESKTOP_FILE_SUFFIX );
-				if( !is_already_loaded( provider, *files, desktop_id )){
-					*files = desktop_path_from_id( provider, *files, dir, desktop_id );
-				}
-				g_free( desktop_id );
-			}
+	while(( name = g_dir_read_name( dir_handle ))){
+		if( g_str_has_suffix( name, NADP_DESKTOP_FILE_SUFFIX )){
+			add_desktop_file( provider, files, loaded, dir, name );
 		}
 	}
 
-close_dir_handle:
-	if( dir_handle ){
-		g_dir_close( dir_handle );
-	}
+	g_dir_close( dir_handle );
 }
+#endif
 
-static gboolean
-is_already_loaded( const NadpDesktopProvider *provider, GList *files, const gchar *desktop_id )
+/*
+ * ids are compared case-insensitively: a file shadows all files with
+ * the same case-folded id found in less preferred directories
+ */
+static void
+add_desktop_file( const NadpDesktopProvider *provider, GList **files, GHashTable *loaded, const gchar *dir, const gchar *name )
 {
-	gboolean found;
-	GList *ip;
-	DesktopPath *dps;
+	gchar *desktop_id;
+	gchar *folded;
 
-	found = FALSE;
-	for( ip = files ; ip && !found ; ip = ip->next ){
-		dps = ( DesktopPath * ) ip->data;
-		if( !g_ascii_strcasecmp( dps->id, desktop_id )){
-			found = TRUE;
-		}
+	desktop_id = na_core_utils_str_remove_suffix( name, NADP_DESKTOP_FILE_SUFFIX );
+	folded = g_ascii_strdown( desktop_id, -1 );
+
+	if( !g_hash_table_lookup_extended( loaded, folded, NULL, NULL )){
+		g_hash_table_insert( loaded, folded, NULL );
+		*files = desktop_path_from_id( provider, *files, dir, desktop_id );
+
+	} else {
+		g_free( folded );
 	}
 
-	return( found );
+	g_free( desktop_id );
 }
 
 static GList *
@@ -248,6 +457,187 @@ desktop_path_from_id( const NadpDesktopProvider *provider, GList *files, const g
 	return( list );
 }
 
+/*
+ * returns the id of the first regular .desktop file of the directory
+ * whose case-folded id is @folded, or %NULL
+ *
+ * the entries are enumerated in the same order than when scanning the
+ * directory, so that the same file is elected
+ */
+static gchar *
+find_desktop_id( const gchar *dir, const gchar *folded )
+{
+	GDir *dir_handle;
+	const gchar *name;
+	gchar *desktop_id, *id_folded, *path;
+	gboolean is_file;
+
+	desktop_id = NULL;
+	dir_handle = g_dir_open( dir, 0, NULL );
+
+	if( dir_handle ){
+		while( !desktop_id && ( name = g_dir_read_name( dir_handle ))){
+			if( g_str_has_suffix( name, NADP_DESKTOP_FILE_SUFFIX )){
+				desktop_id = na_core_utils_str_remove_suffix( name, NADP_DESKTOP_FILE_SUFFIX );
+				id_folded = g_ascii_strdown( desktop_id, -1 );
+				is_file = FALSE;
+
+				if( !strcmp( id_folded, folded )){
+					path = g_build_filename( dir, name, NULL );
+					is_file = g_file_test( path, G_FILE_TEST_IS_REGULAR );
+					g_free( path );
+				}
+
+				if( !is_file ){
+					g_free( desktop_id );
+					desktop_id = NULL;
+				}
+
+				g_free( id_folded );
+			}
+		}
+
+		g_dir_close( dir_handle );
+	}
+
+	return( desktop_id );
+}
+
+/*
+ * Returns a list of newly allocated NAIFactoryObject-derived objects,
+ * initialized from the .desktop files pointed to by the DesktopPath list
+ *
+ * Reading and parsing the files is done by a pool of worker threads;
+ * the objects are then built, and the cache is written, by the main
+ * thread, in the order of the DesktopPath list, as NAIFactoryObject
+ * is not thread-safe.
+ *
+ * The content of each file is recorded in the content cache, even if it
+ * is not a valid .desktop file, as it shadows the same id in less
+ * preferred directories.
+ */
+static GList *
+items_from_desktop_paths( const NadpDesktopProvider *provider, GList *desktop_paths, NadpCacheWriter *writer, GSList **messages )
+{
+	static const gchar *thisfn = "nadp_reader_items_from_desktop_paths";
+	GList *items, *ip;
+	NadpParseData *parses;
+	guint count, threads, i;
+	GThreadPool *pool;
+	GError *error;
+	NAIFactoryObject *item;
+
+	items = NULL;
+	count = g_list_length( desktop_paths );
+	parses = g_new0( NadpParseData, count );
+
+	for( i = 0, ip = desktop_paths ; ip ; ++i, ip = ip->next ){
+		parses[i].dps = ( DesktopPath * ) ip->data;
+	}
+
+	pool = NULL;
+	threads = get_parse_threads( count );
+	g_debug( "%s: count=%u, threads=%u", thisfn, count, threads );
+
+	if( threads > 1 ){
+		/* make sure the class is registered before the workers run */
+		g_type_class_unref( g_type_class_ref( NADP_TYPE_DESKTOP_FILE ));
+
+		error = NULL;
+		pool = g_thread_pool_new(( GFunc ) parse_desktop_path, NULL, threads, TRUE, &error );
+		if( error ){
+			g_warning( "%s: %s", thisfn, error->message );
+			g_error_free( error );
+			pool = NULL;
+		}
+	}
+
+	for( i = 0 ; i < count ; ++i ){
+		if( pool ){
+			g_thread_pool_push( pool, &parses[i], NULL );
+		} else {
+			parse_desktop_path( &parses[i], NULL );
+		}
+	}
+
+	if( pool ){
+		g_thread_pool_free( pool, FALSE, TRUE );
+	}
+
+	for( i = 0 ; i < count ; ++i ){
+		if( writer ){
+			nadp_cache_writer_add( writer, parses[i].dps->path, parses[i].data, parses[i].length );
+		}
+
+		g_free( parses[i].data );
+
+		if( parses[i].ndf ){
+			item = item_from_desktop_file( provider, parses[i].ndf, messages );
+
+			if( item ){
+				items = g_list_prepend( items, item );
+				na_object_dump( item );
+			}
+		}
+	}
+
+	g_free( parses );
+
+	/* the items have been prepended while walking the slots in the
+	 * order of preference: restore this order
+	 */
+	return( g_list_reverse( items ));
+}
+
+/*
+ * the count of worker threads depends of the count of files to be
+ * parsed, and of the count of available processors
+ */
+static guint
+get_parse_threads( guint count )
+{
+	glong cpus;
+
+	if( count < PARSE_THREADS_MIN_FILES ){
+		return( 1 );
+	}
+
+	/* threads have to be explicitly initialized before GLib 2.32 */
+#if !GLIB_CHECK_VERSION( 2,32,0 )
+	if( !g_thread_supported()){
+		return( 1 );
+	}
+#endif
+
+	cpus = sysconf( _SC_NPROCESSORS_ONLN );
+
+	return(( guint ) CLAMP( cpus, 1, PARSE_THREADS_MAX ));
+}
+
+/*
+ * reads and parses one .desktop file
+ *
+ * this may be run in a worker thread: it doesn't touch to anything
+ * else than the given NadpParseData structure
+ */
+static void
+parse_desktop_path( NadpParseData *parse, void *empty )
+{
+	static const gchar *thisfn = "nadp_reader_parse_desktop_path";
+	GError *error;
+
+	error = NULL;
+	if( !g_file_get_contents( parse->dps->path, &parse->data, &parse->length, &error )){
+		g_warning( "%s: %s", thisfn, error->message );
+		g_error_free( error );
+		parse->data = NULL;
+		parse->length = 0;
+
+	} else {
+		parse->ndf = nadp_desktop_file_new_from_data( parse->dps->path, parse->data, parse->length );
+	}
+}
+
 /*
  * Returns a newly allocated NAIFactoryObject-derived object, initialized
  * from the .desktop file pointed to by DesktopPath struct
@@ -255,14 +645,41 @@ desktop_path_from_id( const NadpDesktopProvider *provider, GList *files, const g
 static NAIFactoryObject *
 item_from_desktop_path( const NadpDesktopProvider *provider, DesktopPath *dps, GSList **messages )
 {
-	NadpDesktopFile *ndf;
+	NadpParseData parse;
+
+	memset( &parse, '\0', sizeof( NadpParseData ));
+	parse.dps = dps;
 
-	ndf = nadp_desktop_file_new_from_path( dps->path );
-	if( !ndf ){
+	parse_desktop_path( &parse, NULL );
+	g_free( parse.data );
+
+	if( !parse.ndf ){
 		return( NULL );
 	}
 
-	return( item_from_desktop_file( provider, ndf, messages ));
+	return( item_from_desktop_file( provider, parse.ndf, messages ));
+}
+
+/*
+ * Called for each file recorded in the content cache, in the order of
+ * preference: the data is mapped from the cache file
+ */
+static void
+item_from_cache( const gchar *path, const gchar *data, gsize length, NadpCacheData *cache_data )
+{
+	NadpDesktopFile *ndf;
+	NAIFactoryObject *item;
+
+	ndf = nadp_desktop_file_new_from_data( path, data, length );
+
+	if( ndf ){
+		item = item_from_desktop_file( cache_data->provider, ndf, cache_data->messages );
+
+		if( item ){
+			cache_data->items = g_list_prepend( cache_data->items, item );
+			na_object_dump( item );
+		}
+	}
 }
 
 /*
@@ -355,7 +772,8 @@ free_desktop_paths( GList *paths )
  *
  * GLib does not have any primitive to load a key file from an uri.
  * So we have to load the file into memory, and then try to load the key
- * file from the memory data.
+ * file from the memory data. When the caller has already loaded the
+ * file, its content is just reused.
  *
  * Starting with N-A 3.2, we only honor the version 2 of #NAIImporter interface,
  * thus no more checking here against possible duplicate identifiers.
@@ -375,14 +793,19 @@ nadp_reader_iimporter_import_from_uri( const NAIImporter *instance, void *parms_
 
 	parms = ( NAIImporterImportFromUriParmsv2 * ) parms_ptr;
 
-	if( !na_core_utils_file_is_loadable( parms->uri )){
+	if( parms->data ){
+		ndf = nadp_desktop_file_new_from_uri_data( parms->uri, parms->data, parms->length );
+
+	} else if( !na_core_utils_file_is_loadable( parms->uri )){
 		code = IMPORTER_CODE_NOT_LOADABLE;
 		return( code );
+
+	} else {
+		ndf = nadp_desktop_file_new_from_uri( parms->uri );
 	}
 
 	code = IMPORTER_CODE_NOT_WILLING_TO;
 
-	ndf = nadp_desktop_file_new_from_uri( parms->uri );
 	if( ndf ){
 		parms->imported = ( NAObjectItem * ) item_from_desktop_file(
 				( const NadpDesktopProvider * ) NADP_DESKTOP_PROVIDER( instance ),
@@ -413,6 +836,39 @@ nadp_reader_iimporter_import_from_uri( const NAIImporter *instance, void *parms_
 	return( code );
 }
 
+/**
+ * nadp_reader_iimporter_probe:
+ * @instance: the #NAIImporter provider.
+ * @uri: the URI of the file to be imported.
+ * @data: the first bytes of the file.
+ * @length: the length of @data.
+ *
+ * Returns: %TRUE if @data may be the head of a .desktop file.
+ *
+ * Apart from blank lines, a .desktop file begins either with a group
+ * header, or with comments. In the later case, the comments may be long
+ * enough to fill the whole @data.
+ */
+gboolean
+nadp_reader_iimporter_probe( const NAIImporter *instance, const gchar *uri, const gchar *data, gsize length )
+{
+	const gchar *begin, *end;
+
+	end = data + length;
+	for( begin = data ; begin < end && g_ascii_isspace( *begin ) ; ++begin )
+		;
+
+	if( begin == end || ( *begin != '[' && *begin != '#' )){
+		return( FALSE );
+	}
+
+	if( g_strstr_len( begin, end-begin, "[" NADP_GROUP_DESKTOP "]" )){
+		return( TRUE );
+	}
+
+	return( *begin == '#' && length >= NA_IIMPORTER_PROBE_SIZE && !g_strstr_len( begin, end-begin, "\n[" ));
+}
+
 /*
  * at this time, the object has been allocated and its id has been set
  * read here the subitems key, which may be 'Profiles' or 'ItemsList'
@@ -621,7 +1077,7 @@ read_done_item_is_writable( const NAIFactoryProvider *provider, NAObjectItem *it
 
 	ndf = reader_data->ndf;
 	uri = nadp_desktop_file_get_key_file_uri( ndf );
-	writable = nadp_utils_uri_is_writable( uri );
+	writable = nadp_desktop_provider_is_uri_writable( NADP_DESKTOP_PROVIDER( provider ), uri );
 	g_free( uri );
 
 	return( writable );
@@ -37,8 +37,10 @@
 G_BEGIN_DECLS
 
 GList       *nadp_iio_provider_read_items            ( const NAIIOProvider *provider, GSList **messages );
+NAObjectItem *nadp_iio_provider_read_item            ( const NAIIOProvider *provider, const gchar *id, GSList **messages );
 
 guint        nadp_reader_iimporter_import_from_uri   ( const NAIImporter *instance, void *parms_ptr );
+gboolean     nadp_reader_iimporter_probe             ( const NAIImporter *instance, const gchar *uri, const gchar *data, gsize length );
 
 void         nadp_reader_ifactory_provider_read_start( const NAIFactoryProvider *reader, void *reader_data, const NAIFactoryObject *serializable, GSList **messages );
 NADataBoxed *nadp_reader_ifactory_provider_read_data ( const NAIFactoryProvider *reader, void *reader_data, const NAIFactoryObject *serializable, const NADataDef *iddef, GSList **messages );
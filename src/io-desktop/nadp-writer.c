@@ -149,10 +149,16 @@ nadp_iio_provider_write_item( const NAIIOProvider *provider, const NAObjectItem
 
 	ndf = ( NadpDesktopFile * ) na_object_get_provider_data( item );
 
-	/* write into the current key file and write it to current path */
+	/* write into the current key file and write it to current path
+	 * making sure that translations and comments are not lost
+	 */
 	if( ndf ){
 		g_return_val_if_fail( NADP_IS_DESKTOP_FILE( ndf ), ret );
 
+		if( !nadp_desktop_file_load_full( ndf )){
+			return( NA_IIO_PROVIDER_CODE_WRITE_ERROR );
+		}
+
 	} else {
 		userdir = nadp_xdg_dirs_get_user_data_dir();
 		subdirs = na_core_utils_slist_from_split( NADP_DESKTOP_PROVIDER_SUBDIRS, G_SEARCHPATH_SEPARATOR_S );
@@ -210,6 +216,7 @@ write_item( const NAIIOProvider *provider, const NAObjectItem *item, NadpDesktop
 	static const gchar *thisfn = "nadp_iio_provider_write_item";
 	guint ret;
 	NadpDesktopProvider *self;
+	gboolean dirty;
 
 	g_debug( "%s: provider=%p (%s), item=%p (%s), ndf=%p, messages=%p",
 			thisfn,
@@ -239,8 +246,26 @@ write_item( const NAIIOProvider *provider, const NAObjectItem *item, NadpDesktop
 
 	na_ifactory_provider_write_item( NA_IFACTORY_PROVIDER( provider ), ndf, NA_IFACTORY_OBJECT( item ), messages );
 
-	if( !nadp_desktop_file_write( ndf )){
-		ret = NA_IIO_PROVIDER_CODE_WRITE_ERROR;
+	/* inside of a batch, the file is only staged, and will be synced
+	 * to the disk with all other files when the batch is committed
+	 */
+	if( nadp_desktop_provider_is_in_batch( self )){
+		if( !nadp_desktop_file_stage( ndf )){
+			ret = NA_IIO_PROVIDER_CODE_WRITE_ERROR;
+
+		} else if( nadp_desktop_file_is_dirty( ndf )){
+			nadp_desktop_provider_stage_file( self, ndf );
+		}
+
+	} else {
+		dirty = nadp_desktop_file_is_dirty( ndf );
+
+		if( !nadp_desktop_file_write( ndf )){
+			ret = NA_IIO_PROVIDER_CODE_WRITE_ERROR;
+
+		} else if( dirty ){
+			nadp_desktop_provider_record_write( self, ndf );
+		}
 	}
 
 	return( ret );
@@ -277,8 +302,10 @@ nadp_iio_provider_delete_item( const NAIIOProvider *provider, const NAObjectItem
 
 	if( ndf ){
 		g_return_val_if_fail( NADP_IS_DESKTOP_FILE( ndf ), ret );
+		nadp_desktop_provider_unstage_file( self, ndf );
 		uri = nadp_desktop_file_get_key_file_uri( ndf );
 		if( nadp_utils_uri_delete( uri )){
+			nadp_desktop_provider_record_write( self, ndf );
 			ret = NA_IIO_PROVIDER_CODE_OK;
 		}
 		g_free( uri );
@@ -60,8 +60,9 @@ static gboolean      read_done_item_is_writable( const NAIFactoryProvider *provi
 static void          read_done_action_read_profiles( const NAIFactoryProvider *provider, NAObjectAction *action, ReaderData *data, GSList **messages );
 static void          read_done_action_load_profile( const NAIFactoryProvider *provider, ReaderData *data, const gchar *path, GSList **messages );
 
-static NADataBoxed  *get_boxed_from_path( const NagpGConfProvider *provider, const gchar *path, ReaderData *reader_data, const NADataDef *def );
-static gboolean      is_key_writable( NagpGConfProvider *gconf, const gchar *key );
+static NADataBoxed  *get_boxed_from_entries( ReaderData *reader_data, const NADataDef *def );
+static GConfEntry   *search_entry( GSList *entries, const gchar *entry );
+static gboolean      check_value_type( GConfEntry *entry, GConfValue *value, GConfValueType type );
 
 /*
  * nagp_iio_provider_read_items:
@@ -69,6 +70,11 @@ static gboolean      is_key_writable( NagpGConfProvider *gconf, const gchar *key
  * Note that whatever be the version of the read action, it will be
  * stored as a #NAObjectAction and its set of #NAObjectProfile of the same,
  * latest, version of these classes.
+ *
+ * The whole configurations tree is preloaded in the GConfClient cache
+ * before reading the items, so that the entries of each item and profile
+ * are fetched without any more round-trip to gconfd ; the data are then
+ * decoded from these entries.
  */
 GList *
 nagp_iio_provider_read_items( const NAIIOProvider *provider, GSList **messages )
@@ -78,6 +84,8 @@ nagp_iio_provider_read_items( const NAIIOProvider *provider, GSList **messages )
 	GList *items_list = NULL;
 	GSList *listpath, *ip;
 	NAObjectItem *item;
+	GError *error;
+	gboolean preloaded;
 
 	g_debug( "%s: provider=%p, messages=%p", thisfn, ( void * ) provider, ( void * ) messages );
 
@@ -87,6 +95,14 @@ nagp_iio_provider_read_items( const NAIIOProvider *provider, GSList **messages )
 
 	if( !self->private->dispose_has_run ){
 
+		error = NULL;
+		gconf_client_add_dir( self->private->gconf, NAGP_CONFIGURATIONS_PATH, GCONF_CLIENT_PRELOAD_RECURSIVE, &error );
+		preloaded = ( error == NULL );
+		if( error ){
+			g_warning( "%s: gconf_client_add_dir: %s", thisfn, error->message );
+			g_error_free( error );
+		}
+
 		listpath = na_gconf_utils_get_subdirs( self->private->gconf, NAGP_CONFIGURATIONS_PATH );
 
 		for( ip = listpath ; ip ; ip = ip->next ){
@@ -99,6 +115,10 @@ nagp_iio_provider_read_items( const NAIIOProvider *provider, GSList **messages )
 		}
 
 		na_gconf_utils_free_subdirs( listpath );
+
+		if( preloaded ){
+			gconf_client_remove_dir( self->private->gconf, NAGP_CONFIGURATIONS_PATH, NULL );
+		}
 	}
 
 	g_debug( "%s: count=%d", thisfn, g_list_length( items_list ));
@@ -113,7 +133,7 @@ read_item( NagpGConfProvider *provider, const gchar *path, GSList **messages )
 {
 	static const gchar *thisfn = "nagp_reader_read_item";
 	NAObjectItem *item;
-	gchar *full_path;
+	GSList *entries;
 	gchar *type;
 	gchar *id;
 	ReaderData *data;
@@ -123,9 +143,8 @@ read_item( NagpGConfProvider *provider, const gchar *path, GSList **messages )
 	g_return_val_if_fail( NA_IS_IIO_PROVIDER( provider ), NULL );
 	g_return_val_if_fail( !provider->private->dispose_has_run, NULL );
 
-	full_path = gconf_concat_dir_and_key( path, NAGP_ENTRY_TYPE );
-	type = na_gconf_utils_read_string( provider->private->gconf, full_path, TRUE, NAGP_VALUE_TYPE_ACTION );
-	g_free( full_path );
+	entries = na_gconf_utils_get_entries( provider->private->gconf, path );
+	na_gconf_utils_get_string_from_entries( entries, NAGP_ENTRY_TYPE, &type );
 	item = NULL;
 
 	/* an item may have 'Action' or 'Menu' type; defaults to Action
@@ -149,7 +168,7 @@ read_item( NagpGConfProvider *provider, const gchar *path, GSList **messages )
 
 		data = g_new0( ReaderData, 1 );
 		data->path = ( gchar * ) path;
-		data->entries = na_gconf_utils_get_entries( provider->private->gconf, path );
+		data->entries = entries;
 		na_gconf_utils_dump_entries( data->entries );
 
 		na_ifactory_provider_read_item(
@@ -158,10 +177,11 @@ read_item( NagpGConfProvider *provider, const gchar *path, GSList **messages )
 				NA_IFACTORY_OBJECT( item ),
 				messages );
 
-		na_gconf_utils_free_entries( data->entries );
 		g_free( data );
 	}
 
+	na_gconf_utils_free_entries( entries );
+
 	return( item );
 }
 
@@ -215,8 +235,7 @@ nagp_reader_read_data( const NAIFactoryProvider *provider, void *reader_data, co
 		return( NULL );
 	}
 
-	boxed = get_boxed_from_path(
-			NAGP_GCONF_PROVIDER( provider ), (( ReaderData * ) reader_data )->path, reader_data, def );
+	boxed = get_boxed_from_entries(( ReaderData * ) reader_data, def );
 
 	return( boxed );
 }
@@ -259,16 +278,15 @@ read_done_item_is_writable( const NAIFactoryProvider *provider, NAObjectItem *it
 	GSList *ie;
 	gboolean writable;
 	GConfEntry *gconf_entry;
-	const gchar *key;
 
 	/* check for writability of this item
 	 * item is writable if and only if all entries are themselves writable
+	 * the writability has been returned by gconfd along with the entries
 	 */
 	writable = TRUE;
 	for( ie = data->entries ; ie && writable ; ie = ie->next ){
 		gconf_entry = ( GConfEntry * ) ie->data;
-		key = gconf_entry_get_key( gconf_entry );
-		writable = is_key_writable( NAGP_GCONF_PROVIDER( provider ), key );
+		writable = gconf_entry_get_is_writable( gconf_entry );
 	}
 
 	g_debug( "nagp_reader_read_done_item: writable=%s", writable ? "True":"False" );
@@ -355,47 +373,58 @@ read_done_action_load_profile( const NAIFactoryProvider *provider, ReaderData *d
 	g_free( profile_data );
 }
 
+/*
+ * the data is decoded from the already fetched entries, falling back to
+ * the default value of the type if the entry does not have the expected
+ * type
+ */
 static NADataBoxed *
-get_boxed_from_path( const NagpGConfProvider *provider, const gchar *path, ReaderData *reader_data, const NADataDef *def )
+get_boxed_from_entries( ReaderData *reader_data, const NADataDef *def )
 {
-	static const gchar *thisfn = "nagp_reader_get_boxed_from_path";
+	static const gchar *thisfn = "nagp_reader_get_boxed_from_entries";
 	NADataBoxed *boxed;
-	gboolean have_entry;
-	gchar *str_value;
+	GConfEntry *entry;
+	GConfValue *value;
 	gboolean bool_value;
-	GSList *slist_value;
+	GSList *slist_value, *iv;
 	gint int_value;
 
 	boxed = NULL;
-	have_entry = na_gconf_utils_has_entry( reader_data->entries, def->gconf_entry );
-	g_debug( "%s: entry=%s, have_entry=%s", thisfn, def->gconf_entry, have_entry ? "True":"False" );
+	entry = search_entry( reader_data->entries, def->gconf_entry );
+	g_debug( "%s: entry=%s, have_entry=%s", thisfn, def->gconf_entry, entry ? "True":"False" );
 
-	if( have_entry ){
-		gchar *entry_path = gconf_concat_dir_and_key( path, def->gconf_entry );
+	if( entry ){
+		value = gconf_entry_get_value( entry );
 		boxed = na_data_boxed_new( def );
 
 		switch( def->type ){
 
 			case NA_DATA_TYPE_STRING:
 			case NA_DATA_TYPE_LOCALE_STRING:
-				str_value = na_gconf_utils_read_string( provider->private->gconf, entry_path, TRUE, NULL );
-				na_boxed_set_from_string( NA_BOXED( boxed ), str_value );
-				g_free( str_value );
+				na_boxed_set_from_string( NA_BOXED( boxed ),
+						check_value_type( entry, value, GCONF_VALUE_STRING ) ? gconf_value_get_string( value ) : NULL );
 				break;
 
 			case NA_DATA_TYPE_BOOLEAN:
-				bool_value = na_gconf_utils_read_bool( provider->private->gconf, entry_path, TRUE, FALSE );
+				bool_value = check_value_type( entry, value, GCONF_VALUE_BOOL ) ? gconf_value_get_bool( value ) : FALSE;
 				na_boxed_set_from_void( NA_BOXED( boxed ), GUINT_TO_POINTER( bool_value ));
 				break;
 
 			case NA_DATA_TYPE_STRING_LIST:
-				slist_value = na_gconf_utils_read_string_list( provider->private->gconf, entry_path );
+				slist_value = NULL;
+				if( check_value_type( entry, value, GCONF_VALUE_LIST ) &&
+						gconf_value_get_list_type( value ) == GCONF_VALUE_STRING ){
+					for( iv = gconf_value_get_list( value ) ; iv ; iv = iv->next ){
+						slist_value = g_slist_prepend( slist_value, g_strdup( gconf_value_get_string(( GConfValue * ) iv->data )));
+					}
+					slist_value = g_slist_reverse( slist_value );
+				}
 				na_boxed_set_from_void( NA_BOXED( boxed ), slist_value );
 				na_core_utils_slist_free( slist_value );
 				break;
 
 			case NA_DATA_TYPE_UINT:
-				int_value = na_gconf_utils_read_int( provider->private->gconf, entry_path, TRUE, 0 );
+				int_value = check_value_type( entry, value, GCONF_VALUE_INT ) ? gconf_value_get_int( value ) : 0;
 				na_boxed_set_from_void( NA_BOXED( boxed ), GUINT_TO_POINTER( int_value ));
 				break;
 
@@ -404,31 +433,44 @@ get_boxed_from_path( const NagpGConfProvider *provider, const gchar *path, Reade
 				g_free( boxed );
 				boxed = NULL;
 		}
-
-		g_free( entry_path );
 	}
 
 	return( boxed );
 }
 
 /*
- * key must be an existing entry (not a dir) to get a relevant return
- * value ; else we get FALSE
+ * entries are the immediate children of the read path, so the searched
+ * entry is the last component of their key
  */
+static GConfEntry *
+search_entry( GSList *entries, const gchar *entry )
+{
+	GSList *ie;
+	const gchar *key, *name;
+
+	for( ie = entries ; ie ; ie = ie->next ){
+		key = gconf_entry_get_key(( GConfEntry * ) ie->data );
+		name = strrchr( key, '/' );
+		name = name ? name+1 : key;
+
+		if( !strcmp( name, entry )){
+			return(( GConfEntry * ) ie->data );
+		}
+	}
+
+	return( NULL );
+}
+
 static gboolean
-is_key_writable( NagpGConfProvider *gconf, const gchar *key )
+check_value_type( GConfEntry *entry, GConfValue *value, GConfValueType type )
 {
-	static const gchar *thisfn = "nagp_read_is_key_writable";
-	GError *error = NULL;
-	gboolean is_writable;
-
-	is_writable = gconf_client_key_is_writable( gconf->private->gconf, key, &error );
-	if( error ){
-		g_warning( "%s: gconf_client_key_is_writable: %s", thisfn, error->message );
-		g_error_free( error );
-		error = NULL;
-		is_writable = FALSE;
+	static const gchar *thisfn = "nagp_reader_check_value_type";
+
+	if( value && value->type != type ){
+		g_warning( "%s: path=%s, found type '%u' while waiting for type '%u'",
+				thisfn, gconf_entry_get_key( entry ), value->type, type );
+		return( FALSE );
 	}
 
-	return( is_writable );
+	return( value != NULL );
 }
@@ -34,25 +34,25 @@
 #include "naxml-keys.h"
 
 NAXMLKeyStr naxml_schema_key_schema_str [] = {
-		{ NAXML_KEY_SCHEMA_NODE_KEY,             TRUE,  TRUE, FALSE },
-		{ NAXML_KEY_SCHEMA_NODE_APPLYTO,         TRUE,  TRUE, FALSE },
-		{ NAXML_KEY_SCHEMA_NODE_OWNER,           TRUE, FALSE, FALSE },
-		{ NAXML_KEY_SCHEMA_NODE_TYPE,            TRUE,  TRUE, FALSE },
-		{ NAXML_KEY_SCHEMA_NODE_LISTTYPE,        TRUE,  TRUE, FALSE },
-		{ NAXML_KEY_SCHEMA_NODE_LOCALE,          TRUE,  TRUE, FALSE },
-		{ NAXML_KEY_SCHEMA_NODE_DEFAULT,         TRUE,  TRUE, FALSE },
+		{ NAXML_KEY_SCHEMA_NODE_KEY,             TRUE,  TRUE },
+		{ NAXML_KEY_SCHEMA_NODE_APPLYTO,         TRUE,  TRUE },
+		{ NAXML_KEY_SCHEMA_NODE_OWNER,           TRUE, FALSE },
+		{ NAXML_KEY_SCHEMA_NODE_TYPE,            TRUE,  TRUE },
+		{ NAXML_KEY_SCHEMA_NODE_LISTTYPE,        TRUE,  TRUE },
+		{ NAXML_KEY_SCHEMA_NODE_LOCALE,          TRUE,  TRUE },
+		{ NAXML_KEY_SCHEMA_NODE_DEFAULT,         TRUE,  TRUE },
 		{ NULL }
 };
 
 NAXMLKeyStr naxml_schema_key_locale_str [] = {
-		{ NAXML_KEY_SCHEMA_NODE_LOCALE_DEFAULT,  TRUE,  TRUE, FALSE },
-		{ NAXML_KEY_SCHEMA_NODE_LOCALE_SHORT,    TRUE, FALSE, FALSE },
-		{ NAXML_KEY_SCHEMA_NODE_LOCALE_LONG,     TRUE, FALSE, FALSE },
+		{ NAXML_KEY_SCHEMA_NODE_LOCALE_DEFAULT,  TRUE,  TRUE },
+		{ NAXML_KEY_SCHEMA_NODE_LOCALE_SHORT,    TRUE, FALSE },
+		{ NAXML_KEY_SCHEMA_NODE_LOCALE_LONG,     TRUE, FALSE },
 		{ NULL }
 };
 
 NAXMLKeyStr naxml_dump_key_entry_str [] = {
-		{ NAXML_KEY_DUMP_NODE_KEY,               TRUE,  TRUE, FALSE },
-		{ NAXML_KEY_DUMP_NODE_VALUE,             TRUE,  TRUE, FALSE },
+		{ NAXML_KEY_DUMP_NODE_KEY,               TRUE,  TRUE },
+		{ NAXML_KEY_DUMP_NODE_VALUE,             TRUE,  TRUE },
 		{ NULL }
 };
@@ -62,13 +62,14 @@ G_BEGIN_DECLS
 
 /* this structure is statically allocated (cf. naxml-keys.c)
  * and let us check the validity of each element node
+ *
+ * it is only read, so that several files may be imported concurrently;
+ * the elements already found are recorded by the reader itself
  */
 typedef struct {
-	gchar   *key;						/* static data */
+	gchar   *key;
 	gboolean v1;
 	gboolean v2;
-
-	gboolean reader_found;				/* dynamic data */
 }
 	NAXMLKeyStr;
 
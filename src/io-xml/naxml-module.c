@@ -31,9 +31,12 @@
 #include <config.h>
 #endif
 
+#include <libxml/parser.h>
+
 #include <api/na-extension.h>
 
 #include "naxml-provider.h"
+#include "naxml-reader.h"
 
 /* the count of GType types provided by this extension
  * each new GType type must
@@ -56,6 +59,16 @@ na_extension_startup( GTypeModule *module )
 
 	naxml_provider_register_type( module );
 
+	/* the reader is instanciated by the importer worker threads, while
+	 * its lazy type registration is not thread-safe
+	 */
+	naxml_reader_get_type();
+
+	/* libxml2 must be initialized from the main thread before any
+	 * document be parsed by the importer worker threads
+	 */
+	xmlInitParser();
+
 	return( TRUE );
 }
 
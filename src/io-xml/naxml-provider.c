@@ -211,6 +211,7 @@ iimporter_iface_init( NAIImporterInterface *iface )
 
 	iface->get_version = iimporter_get_version;
 	iface->import_from_uri = naxml_reader_import_from_uri;
+	iface->probe = naxml_reader_probe;
 }
 
 static guint
@@ -232,6 +233,7 @@ iexporter_iface_init( NAIExporterInterface *iface )
 	iface->free_formats = iexporter_free_formats;
 	iface->to_file = naxml_writer_export_to_file;
 	iface->to_buffer = naxml_writer_export_to_buffer;
+	iface->items_to_file = naxml_writer_export_items_to_file;
 }
 
 static guint
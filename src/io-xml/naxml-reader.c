@@ -33,6 +33,7 @@
 
 #include <glib/gi18n.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 #include <string.h>
 
 #include <api/na-core-utils.h>
@@ -63,6 +64,7 @@ typedef struct {
 	guint   ( *fn_root_parms )     ( NAXMLReader *, xmlNode * );
 	guint   ( *fn_list_parms )     ( NAXMLReader *, xmlNode * );
 	guint   ( *fn_element_parms )  ( NAXMLReader *, xmlNode * );
+	gchar * ( *fn_element_id )     ( NAXMLReader *, xmlNode * );
 	guint   ( *fn_element_content )( NAXMLReader *, xmlNode * );
 	gchar * ( *fn_get_value )      ( NAXMLReader *, xmlNode *, const NADataDef *def );
 }
@@ -71,6 +73,10 @@ typedef struct {
 /* private instance data
  * main naxml_reader_import_from_uri() function is called once for each file
  * to import. We thus have one NAXMLReader object per import operation.
+ *
+ * The file is read as a stream: only the element nodes of the item being
+ * currently imported are kept in memory (as private copies), the item
+ * being built as soon as an element node for another item is found.
  */
 struct _NAXMLReaderPrivate {
 	gboolean                         dispose_has_run;
@@ -82,16 +88,26 @@ struct _NAXMLReaderPrivate {
 
 	/* data dynamically set during the import operation
 	 */
+	RootNodeStr                     *root_node_str;
+	gboolean                         parse_error;
+	GList                           *items;
+	GHashTable                      *built_ids;
+	gchar                           *list_id;
+
+	/* following values are reset for each imported item
+	 * (cf. reset_item_data())
+	 */
+	NAObjectItem                    *imported;
 	gboolean                         type_found;
 	GList                           *nodes;
 	GList                           *dealt;
-	RootNodeStr                     *root_node_str;
 	gchar                           *item_id;
 
 	/* following values are reset and reused while iterating on each
 	 * element nodes of the imported item (cf. reset_node_data())
 	 */
 	gboolean                         node_ok;
+	guint                            found;
 };
 
 extern NAXMLKeyStr naxml_schema_key_schema_str[];
@@ -107,12 +123,15 @@ static void          instance_finalize( GObject *object );
 
 static NAXMLReader  *reader_new( void );
 
+static gchar        *schema_get_element_id( NAXMLReader *reader, xmlNode *node );
 static guint         schema_parse_schema_content( NAXMLReader *reader, xmlNode *node );
 static void          schema_check_for_id( NAXMLReader *reader, xmlNode *iter );
+static gchar        *schema_get_id_from_path( NAXMLReader *reader, const xmlChar *text, guint idx );
 static void          schema_check_for_type( NAXMLReader *reader, xmlNode *iter );
 static gchar        *schema_read_value( NAXMLReader *reader, xmlNode *node, const NADataDef *def );
 
 static guint         dump_parse_list_parms( NAXMLReader *reader, xmlNode *node );
+static gchar        *dump_get_element_id( NAXMLReader *reader, xmlNode *node );
 static guint         dump_parse_entry_content( NAXMLReader *reader, xmlNode *node );
 static void          dump_check_for_type( NAXMLReader *reader, xmlNode *key_node );
 static gchar        *dump_read_value( NAXMLReader *reader, xmlNode *node, const NADataDef *def );
@@ -127,6 +146,7 @@ static RootNodeStr st_root_node_str[] = {
 			NULL,
 			NULL,
 			NULL,
+			schema_get_element_id,
 			schema_parse_schema_content,
 			schema_read_value },
 
@@ -138,6 +158,7 @@ static RootNodeStr st_root_node_str[] = {
 			NULL,
 			dump_parse_list_parms,
 			NULL,
+			dump_get_element_id,
 			dump_parse_entry_content,
 			dump_read_value },
 
@@ -145,6 +166,7 @@ static RootNodeStr st_root_node_str[] = {
 };
 
 #define ERR_ITEM_ID_NOT_FOUND		_( "Item ID not found." )
+#define ERR_ITEM_ID_DUPLICATE		_( "Item %s already imported, its elements found again are ignored." )
 #define ERR_MENU_UNWAITED			_( "Unwaited key path %s while importing a menu." )
 #define ERR_NODE_ALREADY_FOUND		_( "Element %s at line %d already found, ignored." )
 #define ERR_NODE_INVALID_ID			_( "Invalid item ID: waited for %s, found %s at line %d." )
@@ -163,8 +185,13 @@ static void          read_done_action_load_profile( NAXMLReader *reader, const g
 static void          read_done_profile_set_localized_label( NAXMLReader *reader, NAObjectProfile *profile );
 
 static guint         reader_parse_xmldoc( NAXMLReader *reader );
-static guint         iter_on_root_children( NAXMLReader *reader, xmlNode *root );
-static guint         iter_on_list_children( NAXMLReader *reader, xmlNode *first );
+static guint         iter_on_root_children( NAXMLReader *reader, xmlTextReaderPtr stream );
+static guint         iter_on_list_children( NAXMLReader *reader, xmlTextReaderPtr stream );
+static guint         read_element_node( NAXMLReader *reader, xmlNode *node );
+static void          build_item( NAXMLReader *reader );
+static void          reset_item_data( NAXMLReader *reader );
+static int           stream_first_child( NAXMLReader *reader, xmlTextReaderPtr stream );
+static int           stream_next_child( NAXMLReader *reader, xmlTextReaderPtr stream, int depth );
 
 static gchar        *slist_to_string( GSList *slist );
 static gchar        *build_key_node_list( NAXMLKeyStr *strlist );
@@ -245,10 +272,16 @@ instance_init( GTypeInstance *instance, gpointer klass )
 	self->private->dispose_has_run = FALSE;
 	self->private->importer = NULL;
 	self->private->parms = NULL;
+	self->private->root_node_str = NULL;
+	self->private->parse_error = FALSE;
+	self->private->items = NULL;
+	self->private->built_ids = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+	self->private->list_id = NULL;
+	self->private->imported = NULL;
 	self->private->type_found = FALSE;
 	self->private->nodes = NULL;
 	self->private->dealt = NULL;
-	self->private->root_node_str = NULL;
+	self->private->item_id = NULL;
 }
 
 static void
@@ -265,8 +298,11 @@ instance_dispose( GObject *object )
 
 		self->private->dispose_has_run = TRUE;
 
-		g_list_free( self->private->nodes );
-		g_list_free( self->private->dealt );
+		reset_item_data( self );
+
+		g_list_foreach( self->private->items, ( GFunc ) g_object_unref, NULL );
+		g_list_free( self->private->items );
+		self->private->items = NULL;
 
 		/* chain up to the parent class */
 		if( G_OBJECT_CLASS( st_parent_class )->dispose ){
@@ -285,7 +321,8 @@ instance_finalize( GObject *object )
 	g_return_if_fail( NAXML_IS_READER( object ));
 	self = NAXML_READER( object );
 
-	g_free( self->private->item_id );
+	g_free( self->private->list_id );
+	g_hash_table_destroy( self->private->built_ids );
 
 	reset_node_data( self );
 
@@ -308,7 +345,7 @@ reader_new( void )
  * @instance: the #NAIImporter provider.
  * @parms: a #NAIImporterImportFromUriParmsv2 structure.
  *
- * Imports an item.
+ * Imports the items found in the file.
  *
  * Returns: the import operation code.
  *
@@ -316,6 +353,10 @@ reader_new( void )
  *  then we do not return any error message at all, but just the 'unwilling to'
  *  code.
  *
+ * The file is read as a stream, so its size is not limited. The first
+ * imported item is returned in @parms->imported, the following ones (e.g.
+ * when importing a whole gconftool-2 dump) in @parms->others.
+ *
  * Starting with N-A 3.2, we only honor the version 2 of #NAIImporter interface,
  * thus no more checking here against possible duplicate identifiers.
  */
@@ -326,6 +367,7 @@ naxml_reader_import_from_uri( const NAIImporter *instance, void *parms_ptr )
 	NAXMLReader *reader;
 	NAIImporterImportFromUriParmsv2* parms;
 	guint code;
+	GList *items, *it;
 
 	g_debug( "%s: instance=%p, parms=%p", thisfn, ( void * ) instance, parms_ptr );
 
@@ -333,8 +375,9 @@ naxml_reader_import_from_uri( const NAIImporter *instance, void *parms_ptr )
 
 	parms = ( NAIImporterImportFromUriParmsv2 * ) parms_ptr;
 	parms->imported = NULL;
+	parms->others = NULL;
 
-	if( !na_core_utils_file_is_loadable( parms->uri )){
+	if( !parms->data && !na_core_utils_file_is_streamable( parms->uri )){
 		return( IMPORTER_CODE_NOT_LOADABLE );
 	}
 
@@ -348,19 +391,57 @@ naxml_reader_import_from_uri( const NAIImporter *instance, void *parms_ptr )
 		na_core_utils_slist_add_message( &reader->private->parms->messages, ERR_NOT_IOXML );
 	}
 
-	g_object_unref( reader );
-
+	/* take ownership of the imported items, if any
+	 */
+	items = NULL;
 	if( code == IMPORTER_CODE_OK ){
-		na_object_dump( parms->imported );
+		items = g_list_reverse( reader->private->items );
+		reader->private->items = NULL;
+	}
+
+	g_object_unref( reader );
 
-	} else if( parms->imported ){
-		g_object_unref( parms->imported );
-		parms->imported = NULL;
+	if( items ){
+		for( it = items ; it ; it = it->next ){
+			na_object_dump( it->data );
+		}
+		parms->imported = NA_OBJECT_ITEM( items->data );
+		parms->others = g_list_delete_link( items, items );
 	}
 
 	return( code );
 }
 
+/**
+ * naxml_reader_probe:
+ * @instance: the #NAIImporter provider.
+ * @uri: the URI of the file to be imported.
+ * @data: the first bytes of the file.
+ * @length: the length of @data.
+ *
+ * Returns: %TRUE if one of the root nodes we know of is found in @data.
+ *
+ * The root node is most probably found in the first bytes of the
+ * document, just after the XML declaration.
+ */
+gboolean
+naxml_reader_probe( const NAIImporter *instance, const gchar *uri, const gchar *data, gsize length )
+{
+	RootNodeStr *istr;
+	gboolean found;
+	gchar *tag;
+
+	found = FALSE;
+
+	for( istr = st_root_node_str ; istr->root_key && !found ; istr++ ){
+		tag = g_strdup_printf( "<%s", istr->root_key );
+		found = ( g_strstr_len( data, length, tag ) != NULL );
+		g_free( tag );
+	}
+
+	return( found );
+}
+
 /*
  * This is only used when trying to import an item from an URI.
  *
@@ -370,6 +451,15 @@ naxml_reader_import_from_uri( const NAIImporter *instance, void *parms_ptr )
  * At import time, it is worthless to say that there is, e.g. a badly formed
  * xml file, as we are not even sure that we are trying to import a .xml.
  * So just keep ride of error messages here.
+ *
+ * The document is pulled through a xmlTextReader rather than loaded as a
+ * whole tree: only the root node, the list node and the current element
+ * node are built by libxml2 at any time. When the caller has already
+ * loaded the file, the document is read from memory.
+ *
+ * Note that we do not call xmlCleanupParser() here, as this would release
+ * the global state of libxml2 while other parts of the process may still
+ * be using it.
  */
 static guint
 reader_parse_xmldoc( NAXMLReader *reader )
@@ -377,46 +467,77 @@ reader_parse_xmldoc( NAXMLReader *reader )
 	RootNodeStr *istr;
 	gboolean found;
 	guint code;
+	xmlTextReaderPtr stream;
+	xmlNode *root_node;
+
+	code = IMPORTER_CODE_NOT_WILLING_TO;
+	root_node = NULL;
+	if( reader->private->parms->data && reader->private->parms->length <= G_MAXINT ){
+		stream = xmlReaderForMemory(
+				reader->private->parms->data, ( int ) reader->private->parms->length,
+				reader->private->parms->uri, NULL, 0 );
+	} else {
+		stream = xmlReaderForFile( reader->private->parms->uri, NULL, 0 );
+	}
 
-	xmlDoc *doc = xmlParseFile( reader->private->parms->uri );
+	if( stream ){
 
-	if( !doc ){
-		xmlErrorPtr error = xmlGetLastError();
-		xmlResetError( error );
-		code = IMPORTER_CODE_NOT_WILLING_TO;
+		/* the first element node of the document is its root
+		 */
+		while( xmlTextReaderRead( stream ) == 1 ){
+			if( xmlTextReaderNodeType( stream ) == XML_READER_TYPE_ELEMENT ){
+				root_node = xmlTextReaderCurrentNode( stream );
+				break;
+			}
+		}
 
-	} else {
-		xmlNode *root_node = xmlDocGetRootElement( doc );
+		if( root_node ){
+			istr = st_root_node_str;
+			found = FALSE;
 
-		istr = st_root_node_str;
-		found = FALSE;
+			while( istr->root_key && !found ){
+				if( !strxcmp( root_node->name, istr->root_key )){
+					found = TRUE;
+					reader->private->root_node_str = istr;
+					code = iter_on_root_children( reader, stream );
+				}
+				istr++;
+			}
 
-		while( istr->root_key && !found ){
-			if( !strxcmp( root_node->name, istr->root_key )){
-				found = TRUE;
-				reader->private->root_node_str = istr;
-				code = iter_on_root_children( reader, root_node );
+			if( !found ){
+				gchar *node_list = build_root_node_list();
+				g_free( node_list );
+				na_core_utils_slist_free( reader->private->parms->messages );
+				reader->private->parms->messages = NULL;
 			}
-			istr++;
 		}
 
-		if( !found ){
-			gchar *node_list = build_root_node_list();
-			g_free( node_list );
-			na_core_utils_slist_free( reader->private->parms->messages );
-			reader->private->parms->messages = NULL;
-			code = IMPORTER_CODE_NOT_WILLING_TO;
-		}
+		xmlFreeTextReader( stream );
+	}
+
+	/* a document which is not well-formed is not imported at all,
+	 * even if some items have already been read
+	 */
+	if( !root_node || reader->private->parse_error ){
+		xmlErrorPtr error = xmlGetLastError();
+		xmlResetError( error );
+		na_core_utils_slist_free( reader->private->parms->messages );
+		reader->private->parms->messages = NULL;
+		code = IMPORTER_CODE_NOT_WILLING_TO;
+	}
 
-		xmlFreeDoc (doc);
+	/* if we do not have any error, check that we have at least one item
+	 */
+	if( code == IMPORTER_CODE_OK && !reader->private->items ){
+		na_core_utils_slist_add_message( &reader->private->parms->messages, ERR_ITEM_ID_NOT_FOUND );
+		code = IMPORTER_CODE_NO_ITEM_ID;
 	}
 
-	xmlCleanupParser();
 	return( code );
 }
 
 /*
- * Parse an XML tree when importing an URI.
+ * Parse an XML stream when importing an URI.
  *
  * We are almost sure here that the imported file is a well-formed XML
  * document, with a known root document node. Starting from here,we should
@@ -428,34 +549,35 @@ reader_parse_xmldoc( NAXMLReader *reader )
  * 'next_child'
  * e.g. for a <gconfentryfile> root node, we must have one and only one
  * <entrylist> child.
+ *
+ * On entry, the stream is positioned on the root node.
  */
 static guint
-iter_on_root_children( NAXMLReader *reader, xmlNode *root )
+iter_on_root_children( NAXMLReader *reader, xmlTextReaderPtr stream )
 {
 	static const gchar *thisfn = "naxml_reader_iter_on_root_children";
-	xmlNodePtr iter;
+	xmlNode *iter;
 	gboolean found;
 	guint code;
+	int ret;
 
-	g_debug( "%s: reader=%p, root=%p", thisfn, ( void * ) reader, ( void * ) root );
+	g_debug( "%s: reader=%p, stream=%p", thisfn, ( void * ) reader, ( void * ) stream );
 
 	code = IMPORTER_CODE_OK;
 
 	/* deal with properties attached to the root node
 	 */
 	if( reader->private->root_node_str->fn_root_parms ){
-		code = ( *reader->private->root_node_str->fn_root_parms )( reader, root );
+		code = ( *reader->private->root_node_str->fn_root_parms )( reader, xmlTextReaderCurrentNode( stream ));
 	}
 
 	/* iter through the first level of children (list)
 	 * we must have only one occurrence of this first 'list' child
 	 */
 	found = FALSE;
-	for( iter = root->children ; iter && code == IMPORTER_CODE_OK ; iter = iter->next ){
+	for( ret = stream_first_child( reader, stream ) ; ret == 1 && code == IMPORTER_CODE_OK ; ret = stream_next_child( reader, stream, 0 )){
 
-		if( iter->type != XML_ELEMENT_NODE ){
-			continue;
-		}
+		iter = xmlTextReaderCurrentNode( stream );
 
 		if( strxcmp( iter->name, reader->private->root_node_str->list_key )){
 			na_core_utils_slist_add_message( &reader->private->parms->messages,
@@ -470,23 +592,28 @@ iter_on_root_children( NAXMLReader *reader, xmlNode *root )
 		}
 
 		found = TRUE;
-		code = iter_on_list_children( reader, iter );
+		code = iter_on_list_children( reader, stream );
 	}
 
 	return( code );
 }
 
 /*
- * Parse an XML tree when importing an URI.
+ * Parse an XML stream when importing an URI.
  *
  * iter on 'schema/entry' element nodes
- * each node should correspond to an elementary data of the imported item
+ * each node should correspond to an elementary data of an imported item
  * other nodes are warned (and ignored)
  *
- * we have to iterate a first time through all nodes to be sure to find
- * a potential 'type' indication - this is needed in order to allocate an
- * action or a menu - if not found at the end of this first pass, we default
- * to allocate an action
+ * each element node is first identified as belonging to an item: as long
+ * as this is the same item, the node is checked and kept ; when another
+ * item is found, the current one is built from the kept nodes, which are
+ * then released - the nodes of an item are thus expected to be contiguous
+ *
+ * we so iterate a first time through all nodes of an item to be sure to
+ * find a potential 'type' indication - this is needed in order to allocate
+ * an action or a menu - if not found at the end of this first pass, we
+ * default to allocate an action
  *
  * this first pass is also used to check nodes
  *
@@ -505,33 +632,34 @@ iter_on_root_children( NAXMLReader *reader, xmlNode *root )
  *      is actually relevant with the to-be-imported item
  *
  * each schema 'applyto' node let us identify a data and its value
+ *
+ * On entry, the stream is positioned on the list node.
  */
 static guint
-iter_on_list_children( NAXMLReader *reader, xmlNode *list )
+iter_on_list_children( NAXMLReader *reader, xmlTextReaderPtr stream )
 {
 	static const gchar *thisfn = "naxml_reader_iter_on_list_children";
 	guint code;
 	xmlNode *iter;
+	int ret;
 
-	g_debug( "%s: reader=%p, list=%p", thisfn, ( void * ) reader, ( void * ) list );
+	g_debug( "%s: reader=%p, stream=%p", thisfn, ( void * ) reader, ( void * ) stream );
 
 	code = IMPORTER_CODE_OK;
 
 	/* deal with properties attached to the list node
 	 */
 	if( reader->private->root_node_str->fn_list_parms ){
-		code = ( *reader->private->root_node_str->fn_list_parms )( reader, list );
+		code = ( *reader->private->root_node_str->fn_list_parms )( reader, xmlTextReaderCurrentNode( stream ));
 	}
 
 	/* each occurrence should correspond to an elementary data
-	 * we run first to determine the type, and allocate the object
-	 * we then rely on NAIFactoryProvider to actually read the data
+	 * we only expand one element node at a time, keeping a copy of it
+	 * until its item is built
 	 */
-	for( iter = list->children ; iter && code == IMPORTER_CODE_OK ; iter = iter->next ){
+	for( ret = stream_first_child( reader, stream ) ; ret == 1 && code == IMPORTER_CODE_OK ; ret = stream_next_child( reader, stream, 1 )){
 
-		if( iter->type != XML_ELEMENT_NODE ){
-			continue;
-		}
+		iter = xmlTextReaderCurrentNode( stream );
 
 		if( strxcmp( iter->name, reader->private->root_node_str->element_key )){
 			na_core_utils_slist_add_message( &reader->private->parms->messages,
@@ -540,59 +668,235 @@ iter_on_list_children( NAXMLReader *reader, xmlNode *list )
 			continue;
 		}
 
-		reset_node_data( reader );
-
-		if( reader->private->root_node_str->fn_element_parms ){
-			code = ( *reader->private->root_node_str->fn_element_parms )( reader, iter );
-			if( code != IMPORTER_CODE_OK ){
-				continue;
-			}
+		iter = xmlTextReaderExpand( stream );
+		if( !iter ){
+			reader->private->parse_error = TRUE;
+			break;
 		}
 
-		if( reader->private->root_node_str->fn_element_content ){
-			code = ( *reader->private->root_node_str->fn_element_content )( reader, iter );
-			if( code != IMPORTER_CODE_OK ){
-				continue;
-			}
+		code = read_element_node( reader, xmlCopyNode( iter, 1 ));
+	}
+
+	/* build the last item of the list
+	 */
+	if( code == IMPORTER_CODE_OK && !reader->private->parse_error ){
+		if( reader->private->nodes || reader->private->imported ){
+			build_item( reader );
 		}
+	}
+
+	reset_item_data( reader );
+
+	return( code );
+}
+
+/*
+ * @node: a private copy of an element node, which is owned by this
+ *  function, and will be released when its item will have been built.
+ */
+static guint
+read_element_node( NAXMLReader *reader, xmlNode *node )
+{
+	static const gchar *thisfn = "naxml_reader_read_element_node";
+	guint code;
+	gchar *id;
 
-		if( reader->private->node_ok ){
-			reader->private->nodes = g_list_prepend( reader->private->nodes, iter );
+	code = IMPORTER_CODE_OK;
+	id = NULL;
+
+	if( reader->private->root_node_str->fn_element_id ){
+		id = ( *reader->private->root_node_str->fn_element_id )( reader, node );
+		if( !id ){
+			g_debug( "%s: unable to identify the item of the element at line %u, ignored", thisfn, node->line );
+			xmlFreeNode( node );
+			return( code );
 		}
 	}
 
-	/* if we do not have any error, check that we have at least a not empty id
+	/* a new item begins: build the previous one
 	 */
+	if( id && reader->private->item_id && strcmp( id, reader->private->item_id ) != 0 ){
+		build_item( reader );
+	}
+
+	if( id && !reader->private->item_id ){
+		reader->private->item_id = g_strdup( id );
+	}
+
+	g_free( id );
+
 	if( code == IMPORTER_CODE_OK ){
-		if( !reader->private->item_id || !strlen( reader->private->item_id )){
-			na_core_utils_slist_add_message( &reader->private->parms->messages, ERR_ITEM_ID_NOT_FOUND );
-			code = IMPORTER_CODE_NO_ITEM_ID;
+		reset_node_data( reader );
+
+		if( reader->private->root_node_str->fn_element_parms ){
+			code = ( *reader->private->root_node_str->fn_element_parms )( reader, node );
 		}
 	}
 
-	/* if type not found, then suppose that we have an action
+	if( code == IMPORTER_CODE_OK && reader->private->root_node_str->fn_element_content ){
+		code = ( *reader->private->root_node_str->fn_element_content )( reader, node );
+	}
+
+	if( code == IMPORTER_CODE_OK && reader->private->node_ok ){
+		reader->private->nodes = g_list_prepend( reader->private->nodes, node );
+
+	} else {
+		xmlFreeNode( node );
+	}
+
+	return( code );
+}
+
+/*
+ * all the element nodes of an item have been read: allocate the item (if
+ * not already done) and load its data, then release the nodes
+ *
+ * an invalid item is reported and skipped, so that it does not prevent
+ * the other items of the stream to be imported
+ */
+static void
+build_item( NAXMLReader *reader )
+{
+	static const gchar *thisfn = "naxml_reader_build_item";
+	gboolean ok;
+
+	ok = TRUE;
+
+	/* check that we have a not empty id
 	 */
-	if( code == IMPORTER_CODE_OK ){
+	if( !reader->private->item_id || !strlen( reader->private->item_id )){
+		na_core_utils_slist_add_message( &reader->private->parms->messages, ERR_ITEM_ID_NOT_FOUND );
+		ok = FALSE;
+	}
+
+	/* an item whose elements are not contiguous would be imported twice
+	 */
+	if( ok && g_hash_table_lookup_extended( reader->private->built_ids, reader->private->item_id, NULL, NULL )){
+		na_core_utils_slist_add_message( &reader->private->parms->messages, ERR_ITEM_ID_DUPLICATE, reader->private->item_id );
+		ok = FALSE;
+	}
 
-		if( !reader->private->type_found ){
-			reader->private->parms->imported = NA_OBJECT_ITEM( na_object_action_new());
+	/* type found but unknown: the error has already been reported
+	 * if type not found, then suppose that we have an action
+	 */
+	if( ok ){
+		if( !reader->private->imported ){
+			if( reader->private->type_found ){
+				g_debug( "%s: item %s has an unknown type, ignored", thisfn, reader->private->item_id );
+				ok = FALSE;
+
+			} else {
+				reader->private->imported = NA_OBJECT_ITEM( na_object_action_new());
+			}
 		}
 	}
 
 	/* now load the data
 	 */
-	if( code == IMPORTER_CODE_OK ){
+	if( ok ){
 
-		na_object_set_id( reader->private->parms->imported, reader->private->item_id );
+		na_object_set_id( reader->private->imported, reader->private->item_id );
 
 		na_ifactory_provider_read_item(
 				NA_IFACTORY_PROVIDER( reader->private->importer ),
 				reader,
-				NA_IFACTORY_OBJECT( reader->private->parms->imported ),
+				NA_IFACTORY_OBJECT( reader->private->imported ),
 				&reader->private->parms->messages );
+
+		reader->private->items = g_list_prepend( reader->private->items, reader->private->imported );
+		reader->private->imported = NULL;
+
+		g_hash_table_insert( reader->private->built_ids, g_strdup( reader->private->item_id ), NULL );
 	}
 
-	return( code );
+	reset_item_data( reader );
+}
+
+/*
+ * release the data of the current item, so that we are ready for the next
+ * one - the item itself is only unreffed if it has not been built
+ */
+static void
+reset_item_data( NAXMLReader *reader )
+{
+	if( reader->private->imported ){
+		g_object_unref( reader->private->imported );
+		reader->private->imported = NULL;
+	}
+
+	g_list_foreach( reader->private->nodes, ( GFunc ) xmlFreeNode, NULL );
+	g_list_free( reader->private->nodes );
+	reader->private->nodes = NULL;
+
+	g_list_free( reader->private->dealt );
+	reader->private->dealt = NULL;
+
+	g_free( reader->private->item_id );
+	reader->private->item_id = NULL;
+
+	reader->private->type_found = FALSE;
+}
+
+/*
+ * position the stream on the first element child of the current node
+ *
+ * Returns: 1 if such a child has been found, 0 if the current node has
+ * no element child, -1 on error.
+ */
+static int
+stream_first_child( NAXMLReader *reader, xmlTextReaderPtr stream )
+{
+	int depth;
+	int ret;
+
+	if( xmlTextReaderIsEmptyElement( stream )){
+		return( 0 );
+	}
+
+	depth = xmlTextReaderDepth( stream );
+	ret = xmlTextReaderRead( stream );
+
+	while( ret == 1 && xmlTextReaderDepth( stream ) > depth ){
+		if( xmlTextReaderNodeType( stream ) == XML_READER_TYPE_ELEMENT ){
+			return( 1 );
+		}
+		ret = xmlTextReaderNext( stream );
+	}
+
+	if( ret < 0 ){
+		reader->private->parse_error = TRUE;
+	}
+
+	return( ret < 0 ? ret : 0 );
+}
+
+/*
+ * skip the current node and its subtree, positioning the stream on the
+ * next element sibling, i.e. the next element child of the parent node
+ * which is at @depth
+ *
+ * Returns: 1 if such a sibling has been found, 0 at the end of the parent
+ * node, -1 on error.
+ */
+static int
+stream_next_child( NAXMLReader *reader, xmlTextReaderPtr stream, int depth )
+{
+	int ret;
+
+	ret = xmlTextReaderNext( stream );
+
+	while( ret == 1 && xmlTextReaderDepth( stream ) > depth ){
+		if( xmlTextReaderNodeType( stream ) == XML_READER_TYPE_ELEMENT ){
+			return( 1 );
+		}
+		ret = xmlTextReaderNext( stream );
+	}
+
+	if( ret < 0 ){
+		reader->private->parse_error = TRUE;
+	}
+
+	return( ret < 0 ? ret : 0 );
 }
 
 void
@@ -618,7 +922,7 @@ naxml_reader_read_start( const NAIFactoryProvider *provider, void *reader_data,
 static void
 read_start_profile_attach_profile( NAXMLReader *reader, NAObjectProfile *profile )
 {
-	na_object_attach_profile( reader->private->parms->imported, profile );
+	na_object_attach_profile( reader->private->imported, profile );
 }
 
 /*
@@ -828,11 +1132,11 @@ read_done_action_read_profiles( NAXMLReader *reader, NAObjectAction *action )
 	gchar *profile_id;
 	NAObjectProfile *profile;
 
-	if( !na_object_get_items_count( reader->private->parms->imported )){
+	if( !na_object_get_items_count( reader->private->imported )){
 
 		/* first attach potential ordered profiles
 		 */
-		order = na_object_get_items_slist( reader->private->parms->imported );
+		order = na_object_get_items_slist( reader->private->imported );
 		for( ip = order ; ip ; ip = ip->next ){
 			read_done_action_load_profile( reader, ( const gchar * ) ip->data );
 		}
@@ -888,7 +1192,7 @@ read_done_action_get_next_profile_id( NAXMLReader *reader )
 			profile_id = g_path_get_basename( name );
 			g_free( name );
 
-			if( na_object_get_item( reader->private->parms->imported, profile_id )){
+			if( na_object_get_item( reader->private->imported, profile_id )){
 				g_free( profile_id );
 				profile_id = NULL;
 			}
@@ -943,6 +1247,28 @@ read_done_profile_set_localized_label( NAXMLReader *reader, NAObjectProfile *pro
 	g_free( descname );
 }
 
+/*
+ * the item a schema belongs to is identified by its 'applyto' key
+ */
+static gchar *
+schema_get_element_id( NAXMLReader *reader, xmlNode *schema )
+{
+	gchar *id;
+	xmlNode *applyto;
+	xmlChar *text;
+
+	id = NULL;
+	applyto = search_for_child_node( schema, NAXML_KEY_SCHEMA_NODE_APPLYTO );
+
+	if( applyto ){
+		text = xmlNodeGetContent( applyto );
+		id = schema_get_id_from_path( reader, text, 0 );
+		xmlFree( text );
+	}
+
+	return( id );
+}
+
 /*
  * 'key' and 'applyto' keys: check the id
  * 'applyto' key: check for type
@@ -956,7 +1282,7 @@ schema_parse_schema_content( NAXMLReader *reader, xmlNode *schema )
 	xmlNode *iter;
 	NAXMLKeyStr *str;
 	int i;
-	guint code;
+	guint code, found;
 
 	code = IMPORTER_CODE_OK;
 
@@ -983,7 +1309,9 @@ schema_parse_schema_content( NAXMLReader *reader, xmlNode *schema )
 			continue;
 		}
 
-		if( str->reader_found ){
+		found = 1 << ( str - naxml_schema_key_schema_str );
+
+		if( reader->private->found & found ){
 			na_core_utils_slist_add_message( &reader->private->parms->messages,
 					ERR_NODE_ALREADY_FOUND,
 					( const char * ) iter->name, iter->line );
@@ -991,7 +1319,7 @@ schema_parse_schema_content( NAXMLReader *reader, xmlNode *schema )
 			continue;
 		}
 
-		str->reader_found = TRUE;
+		reader->private->found |= found;
 
 		/* set the item id the first time, check after
 		 * - until v 2.0 of the exported schemas, both <key> and <applyto>
@@ -1032,12 +1360,13 @@ schema_check_for_id( NAXMLReader *reader, xmlNode *iter )
 	}
 
 	xmlChar *text = xmlNodeGetContent( iter );
-	gchar **path_elts = g_strsplit(( const gchar * ) text, "/", -1 );
-	gchar *id = g_strdup( path_elts[ reader->private->root_node_str->key_length+idx-2 ] );
-	g_strfreev( path_elts );
+	gchar *id = schema_get_id_from_path( reader, text, idx );
 	xmlFree( text );
 
-	if( reader->private->item_id ){
+	if( !id ){
+		reader->private->node_ok = FALSE;
+
+	} else if( reader->private->item_id ){
 		if( strcmp( reader->private->item_id, id ) != 0 ){
 			na_core_utils_slist_add_message( &reader->private->parms->messages,
 					ERR_NODE_INVALID_ID,
@@ -1051,6 +1380,30 @@ schema_check_for_id( NAXMLReader *reader, xmlNode *iter )
 	g_free( id );
 }
 
+/*
+ * extract the item id from a 'key' or 'applyto' path
+ * returns a newly allocated string, or %NULL if the path is too short
+ */
+static gchar *
+schema_get_id_from_path( NAXMLReader *reader, const xmlChar *text, guint idx )
+{
+	gchar *id;
+	gchar **path_elts;
+	guint i;
+
+	id = NULL;
+	i = reader->private->root_node_str->key_length+idx-2;
+	path_elts = g_strsplit(( const gchar * ) text, "/", -1 );
+
+	if( g_strv_length( path_elts ) > i ){
+		id = g_strdup( path_elts[i] );
+	}
+
+	g_strfreev( path_elts );
+
+	return( id );
+}
+
 /*
  * check 'applyto' key for 'Type'
  */
@@ -1066,10 +1419,10 @@ schema_check_for_type( NAXMLReader *reader, xmlNode *iter )
 		gchar *type = get_value_from_child_node( iter->parent, NAXML_KEY_SCHEMA_NODE_DEFAULT );
 
 		if( !strcmp( type, NAGP_VALUE_TYPE_ACTION )){
-			reader->private->parms->imported = NA_OBJECT_ITEM( na_object_action_new());
+			reader->private->imported = NA_OBJECT_ITEM( na_object_action_new());
 
 		} else if( !strcmp( type, NAGP_VALUE_TYPE_MENU )){
-			reader->private->parms->imported = NA_OBJECT_ITEM( na_object_menu_new());
+			reader->private->imported = NA_OBJECT_ITEM( na_object_menu_new());
 
 		} else {
 			na_core_utils_slist_add_message( &reader->private->parms->messages, ERR_NODE_UNKNOWN_TYPE, type, iter->line );
@@ -1099,8 +1452,11 @@ schema_read_value( NAXMLReader *reader, xmlNode *node, const NADataDef *def )
 }
 
 /*
- * first run: do nothing
- * second run: get the id
+ * get the id from the base of the list
+ *
+ * when the base is the configurations path itself, the file is a dump of
+ * the whole configuration (e.g. gconftool-2 --dump) ; the id is then
+ * taken from each entry key (see dump_get_element_id())
  */
 static guint
 dump_parse_list_parms( NAXMLReader *reader, xmlNode *node )
@@ -1109,13 +1465,57 @@ dump_parse_list_parms( NAXMLReader *reader, xmlNode *node )
 
 	code = IMPORTER_CODE_OK;
 
+	g_free( reader->private->list_id );
+	reader->private->list_id = NULL;
+
 	xmlChar *path = xmlGetProp( node, ( const xmlChar * ) NAXML_KEY_DUMP_LIST_PARM_BASE );
-	reader->private->item_id = g_path_get_basename(( const gchar * ) path );
+	if( path && strxcmp( path, NAGP_CONFIGURATIONS_PATH )){
+		reader->private->list_id = g_path_get_basename(( const gchar * ) path );
+	}
 	xmlFree( path );
 
 	return( code );
 }
 
+/*
+ * when the list base identifies the item, all entries belong to it
+ *
+ * else the key of the entry is relative to the configurations path, and
+ * is prefixed with the item id ; this prefix is removed from the key, so
+ * that the entry may thereafter be handled as if it had been exported
+ * for this single item
+ */
+static gchar *
+dump_get_element_id( NAXMLReader *reader, xmlNode *entry )
+{
+	gchar *id;
+	xmlNode *key_node;
+	xmlChar *key;
+	gchar *sep;
+
+	if( reader->private->list_id ){
+		return( g_strdup( reader->private->list_id ));
+	}
+
+	id = NULL;
+	key_node = search_for_child_node( entry, NAXML_KEY_DUMP_NODE_KEY );
+
+	if( key_node ){
+		key = xmlNodeGetContent( key_node );
+		sep = key ? strchr(( const gchar * ) key, '/' ) : NULL;
+
+		if( sep && sep > ( gchar * ) key ){
+			id = g_strndup(( const gchar * ) key, sep - ( gchar * ) key );
+			xmlNodeSetContent( key_node, NULL );
+			xmlNodeAddContent( key_node, ( const xmlChar * ) sep+1 );
+		}
+
+		xmlFree( key );
+	}
+
+	return( id );
+}
+
 /*
  * first_run: only search for a 'Type' key, and allocate the item
  * second run: load data
@@ -1126,7 +1526,7 @@ dump_parse_entry_content( NAXMLReader *reader, xmlNode *entry )
 	xmlNode *iter;
 	NAXMLKeyStr *str;
 	int i;
-	guint code;
+	guint code, found;
 
 	code = IMPORTER_CODE_OK;
 
@@ -1153,7 +1553,9 @@ dump_parse_entry_content( NAXMLReader *reader, xmlNode *entry )
 			continue;
 		}
 
-		if( str->reader_found ){
+		found = 1 << ( str - naxml_dump_key_entry_str );
+
+		if( reader->private->found & found ){
 			na_core_utils_slist_add_message( &reader->private->parms->messages,
 					ERR_NODE_ALREADY_FOUND,
 					( const char * ) iter->name, iter->line );
@@ -1161,7 +1563,7 @@ dump_parse_entry_content( NAXMLReader *reader, xmlNode *entry )
 			continue;
 		}
 
-		str->reader_found = TRUE;
+		reader->private->found |= found;
 
 		/* search for the type of the item
 		 */
@@ -1191,10 +1593,10 @@ dump_check_for_type( NAXMLReader *reader, xmlNode *key_node )
 		gchar *type = get_value_from_child_child_node( key_node->parent, NAXML_KEY_DUMP_NODE_VALUE, NAXML_KEY_DUMP_NODE_VALUE_TYPE_STRING );
 
 		if( !strcmp( type, NAGP_VALUE_TYPE_ACTION )){
-			reader->private->parms->imported = NA_OBJECT_ITEM( na_object_action_new());
+			reader->private->imported = NA_OBJECT_ITEM( na_object_action_new());
 
 		} else if( !strcmp( type, NAGP_VALUE_TYPE_MENU )){
-			reader->private->parms->imported = NA_OBJECT_ITEM( na_object_menu_new());
+			reader->private->imported = NA_OBJECT_ITEM( na_object_menu_new());
 
 		} else {
 			na_core_utils_slist_add_message( &reader->private->parms->messages, ERR_NODE_UNKNOWN_TYPE, type, key_node->line );
@@ -1395,16 +1797,7 @@ is_profile_path( NAXMLReader *reader, xmlChar *text )
 static void
 reset_node_data( NAXMLReader *reader )
 {
-	int i;
-
-	for( i=0 ; naxml_schema_key_schema_str[i].key ; ++i ){
-		naxml_schema_key_schema_str[i].reader_found = FALSE;
-	}
-
-	for( i=0 ; naxml_dump_key_entry_str[i].key ; ++i ){
-		naxml_dump_key_entry_str[i].reader_found = FALSE;
-	}
-
+	reader->private->found = 0;
 	reader->private->node_ok = TRUE;
 }
 
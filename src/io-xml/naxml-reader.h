@@ -78,6 +78,7 @@ typedef struct {
 GType        naxml_reader_get_type( void );
 
 guint        naxml_reader_import_from_uri( const NAIImporter *instance, void *parms_ptr );
+gboolean     naxml_reader_probe( const NAIImporter *instance, const gchar *uri, const gchar *data, gsize length );
 
 void         naxml_reader_read_start( const NAIFactoryProvider *provider, void *reader_data, const NAIFactoryObject *object, GSList **messages  );
 NADataBoxed *naxml_reader_read_data ( const NAIFactoryProvider *provider, void *reader_data, const NAIFactoryObject *object, const NADataDef *def, GSList **messages );
@@ -34,6 +34,7 @@
 #include <gio/gio.h>
 #include <libintl.h>
 #include <libxml/tree.h>
+#include <libxml/xmlwriter.h>
 #include <string.h>
 
 #include <api/na-core-utils.h>
@@ -57,26 +58,34 @@ struct _NAXMLWriterClassPrivate {
 };
 
 /* private instance data
+ *
+ * The XML document is not built in memory, but directly streamed by a
+ * xmlTextWriter either to a GOutputStream, or to a GString when exporting
+ * to a buffer.
  */
 struct _NAXMLWriterPrivate {
 	gboolean         dispose_has_run;
 	NAIExporter     *provider;
 	NAObjectItem    *exported;
 	GSList          *messages;
+	ExportFormatFn  *fn_str;
 
-	/* positionning these at document level
+	/* whether several items are exported in the same document
 	 */
-	xmlDocPtr        doc;
-	ExportFormatFn  *fn_str;
-	gchar           *buffer;
+	gboolean         multi;
+	gchar           *item_id;
 
-	xmlNodePtr       root_node;
-	xmlNodePtr       list_node;
+	/* the output
+	 */
+	xmlTextWriterPtr xml;
+	GOutputStream   *stream;
+	GString         *string;
+	GError          *error;
 
-	/* nodes created in write_data_schema_v2(), used in write_data_schema_v1()
+	/* whether write_data_schema_v2_element() has left a <locale> element
+	 * opened, so that write_data_schema_v1_element() may complete it
 	 */
-	xmlNodePtr       schema_node;
-	xmlNodePtr       locale_node;
+	gboolean         locale_opened;
 };
 
 /* the association between an export format and the functions
@@ -106,14 +115,19 @@ static void            write_data_schema_v1( NAXMLWriter *writer, const NAObject
 static void            write_data_schema_v1_element( NAXMLWriter *writer, const NADataDef *def );
 static void            write_type_schema_v1( NAXMLWriter *writer, const NAObjectItem *object, const NADataDef *def, const gchar *value );
 static void            write_data_schema_v2( NAXMLWriter *writer, const NAObjectId *object, const NADataBoxed *boxed, const NADataDef *def );
+static void            write_data_schema_start( NAXMLWriter *writer, const NAObjectId *object, const NADataBoxed *boxed, const NADataDef *def );
 static void            write_data_schema_v2_element( NAXMLWriter *writer, const NADataDef *def, const gchar *object_id, const gchar *value_str );
+static void            write_data_schema_end( NAXMLWriter *writer );
 static void            write_type_schema_v2( NAXMLWriter *writer, const NAObjectItem *object, const NADataDef *def, const gchar *value );
 static void            write_list_attribs_dump( NAXMLWriter *writer, const NAObjectItem *object );
 static void            write_data_dump( NAXMLWriter *writer, const NAObjectId *object, const NADataBoxed *boxed, const NADataDef *def );
 static void            write_data_dump_element( NAXMLWriter *writer, const NADataDef *def, const NADataBoxed *boxed, const gchar *entry, const gchar *value_str );
 static void            write_type_dump( NAXMLWriter *writer, const NAObjectItem *object, const NADataDef *def, const gchar *value );
 
-static xmlDocPtr       build_xml_doc( NAXMLWriter *writer );
+static guint           writer_export_items( NAXMLWriter *writer, GList *items );
+static int             writer_output_write( NAXMLWriter *writer, const char *buffer, int len );
+static int             writer_output_close( NAXMLWriter *writer );
+static void            write_list_start( NAXMLWriter *writer, const NAObjectItem *item );
 static gchar          *convert_to_gconf_slist( const gchar *str );
 static ExportFormatFn *find_export_format_fn( const gchar *format );
 
@@ -121,9 +135,8 @@ static ExportFormatFn *find_export_format_fn( const gchar *format );
 static ExportFormatFn *find_export_format_fn_from_quark( GQuark format );
 #endif
 
-static gchar          *get_output_fname( const NAObjectItem *item, const gchar *folder, const gchar *format );
-static void            output_xml_to_file( const gchar *xml, const gchar *filename, GSList **msg );
-static guint           writer_to_buffer( NAXMLWriter *writer );
+static gchar          *get_output_fname( GList *items, const gchar *folder, const gchar *format );
+static guint           output_xml_to_file( NAXMLWriter *writer, GList *items, const gchar *filename, GSList **msg );
 
 static ExportFormatFn st_export_format_fn[] = {
 
@@ -252,9 +265,8 @@ instance_finalize( GObject *object )
 	g_return_if_fail( NAXML_IS_WRITER( object ));
 	self = NAXML_WRITER( object );
 
-	/* do not release self->private->buffer as the pointer has been
-	 * returned to the caller
-	 */
+	g_free( self->private->item_id );
+	g_clear_error( &self->private->error );
 
 	g_free( self->private );
 
@@ -277,6 +289,7 @@ naxml_writer_export_to_buffer( const NAIExporter *instance, NAIExporterBufferPar
 	static const gchar *thisfn = "naxml_writer_export_to_buffer";
 	NAXMLWriter *writer;
 	guint code;
+	GList *items;
 
 	g_debug( "%s: instance=%p, parms=%p", thisfn, ( void * ) instance, ( void * ) parms );
 
@@ -290,7 +303,6 @@ naxml_writer_export_to_buffer( const NAIExporter *instance, NAIExporterBufferPar
 		writer = NAXML_WRITER( g_object_new( NAXML_WRITER_TYPE, NULL ));
 
 		writer->private->provider = ( NAIExporter * ) instance;
-		writer->private->exported = parms->exported;
 		writer->private->messages = parms->messages;
 #ifdef NA_ENABLE_DEPRECATED
 		if( parms->version == 1 ){
@@ -301,16 +313,19 @@ naxml_writer_export_to_buffer( const NAIExporter *instance, NAIExporterBufferPar
 #else
 		writer->private->fn_str = find_export_format_fn( parms->format );
 #endif
-		writer->private->buffer = NULL;
 
 		if( !writer->private->fn_str ){
 			code = NA_IEXPORTER_CODE_INVALID_FORMAT;
 
 		} else {
-			code = writer_to_buffer( writer );
-			if( code == NA_IEXPORTER_CODE_OK ){
-				parms->buffer = writer->private->buffer;
-			}
+			writer->private->string = g_string_new( "" );
+			items = g_list_prepend( NULL, parms->exported );
+
+			code = writer_export_items( writer, items );
+
+			g_list_free( items );
+			parms->buffer = g_string_free( writer->private->string, code != NA_IEXPORTER_CODE_OK );
+			writer->private->string = NULL;
 		}
 
 		g_object_unref( writer );
@@ -335,6 +350,7 @@ naxml_writer_export_to_file( const NAIExporter *instance, NAIExporterFileParmsv2
 	gchar *filename;
 	guint code;
 	const gchar *format2;
+	GList *items;
 
 	g_debug( "%s: instance=%p, parms=%p", thisfn, ( void * ) instance, ( void * ) parms );
 
@@ -362,26 +378,152 @@ naxml_writer_export_to_file( const NAIExporter *instance, NAIExporterFileParmsv2
 		writer->private->fn_str = find_export_format_fn( parms->format );
 		format2 = parms->format;
 #endif
-		writer->private->buffer = NULL;
 
 		if( !writer->private->fn_str ){
 			code = NA_IEXPORTER_CODE_INVALID_FORMAT;
 
 		} else {
-			code = writer_to_buffer( writer );
+			items = g_list_prepend( NULL, parms->exported );
+			filename = get_output_fname( items, parms->folder, format2 );
+
+			if( filename ){
+				parms->basename = g_path_get_basename( filename );
+				code = output_xml_to_file(
+						writer, items, filename, parms->messages ? &writer->private->messages : NULL );
+				g_free( filename );
+			}
+
+			g_list_free( items );
+		}
+
+		g_object_unref( writer );
+	}
+
+	g_debug( "%s: returning code=%u", thisfn, code );
+	return( code );
+}
+
+/**
+ * naxml_writer_export_items_to_file:
+ * @instance: this #NAIExporter instance.
+ * @parms: a #NAIExporterItemsParmsv2 structure.
+ *
+ * Export all the specified items to one newly created file, as a single
+ * XML document (see naxml_writer_export_to_stream()).
+ *
+ * Returns: the export operation code.
+ */
+guint
+naxml_writer_export_items_to_file( const NAIExporter *instance, NAIExporterItemsParmsv2 *parms )
+{
+	static const gchar *thisfn = "naxml_writer_export_items_to_file";
+	NAXMLWriter *writer;
+	gchar *filename;
+	guint code;
+	GList *it;
+
+	g_debug( "%s: instance=%p, parms=%p", thisfn, ( void * ) instance, ( void * ) parms );
+
+	code = parms->exported ? NA_IEXPORTER_CODE_OK : NA_IEXPORTER_CODE_INVALID_ITEM;
+
+	for( it = parms->exported ; it && code == NA_IEXPORTER_CODE_OK ; it = it->next ){
+		if( !NA_IS_OBJECT_ITEM( it->data )){
+			code = NA_IEXPORTER_CODE_INVALID_ITEM;
+		}
+	}
 
-			if( code == NA_IEXPORTER_CODE_OK ){
-				filename = get_output_fname( parms->exported, parms->folder, format2 );
+	if( code == NA_IEXPORTER_CODE_OK ){
+		writer = NAXML_WRITER( g_object_new( NAXML_WRITER_TYPE, NULL ));
 
-				if( filename ){
-					parms->basename = g_path_get_basename( filename );
-					output_xml_to_file(
-							writer->private->buffer, filename, parms->messages ? &writer->private->messages : NULL );
-					g_free( filename );
-				}
+		writer->private->provider = ( NAIExporter * ) instance;
+		writer->private->messages = parms->messages;
+		writer->private->fn_str = find_export_format_fn( parms->format );
+
+		if( !writer->private->fn_str ){
+			code = NA_IEXPORTER_CODE_INVALID_FORMAT;
+
+		} else {
+			filename = get_output_fname( parms->exported, parms->folder, parms->format );
+
+			if( filename ){
+				parms->basename = g_path_get_basename( filename );
+				code = output_xml_to_file(
+						writer, parms->exported, filename, &writer->private->messages );
+				g_free( filename );
 			}
+		}
 
-			g_free( writer->private->buffer );
+		parms->messages = writer->private->messages;
+		g_object_unref( writer );
+	}
+
+	g_debug( "%s: returning code=%u", thisfn, code );
+	return( code );
+}
+
+/**
+ * naxml_writer_export_to_stream:
+ * @instance: this #NAIExporter instance.
+ * @items: a #GList of #NAObjectItem -derived objects to be exported.
+ * @format: the export format.
+ * @stream: the #GOutputStream to write the XML document to.
+ * @messages: a pointer to a #GSList list of localized strings, or %NULL.
+ *
+ * Export the specified items as one XML document, which is written to
+ * @stream as it is built.
+ *
+ * When there is more than one item, all items share the same schemas or
+ * entries list, which makes the document suitable for an import of all
+ * the items in one pass. In particular, a GConf dump is then relative to
+ * the configurations path, as gconftool-2 --dump would write it.
+ *
+ * The @stream is left opened.
+ *
+ * Returns: the export operation code.
+ */
+guint
+naxml_writer_export_to_stream( const NAIExporter *instance, GList *items, const gchar *format, GOutputStream *stream, GSList **messages )
+{
+	static const gchar *thisfn = "naxml_writer_export_to_stream";
+	NAXMLWriter *writer;
+	guint code;
+	GList *it;
+
+	g_debug( "%s: instance=%p, items=%p (count=%d), format=%s, stream=%p, messages=%p",
+			thisfn, ( void * ) instance, ( void * ) items, g_list_length( items ), format, ( void * ) stream, ( void * ) messages );
+
+	g_return_val_if_fail( G_IS_OUTPUT_STREAM( stream ), NA_IEXPORTER_CODE_INVALID_TARGET );
+
+	code = items ? NA_IEXPORTER_CODE_OK : NA_IEXPORTER_CODE_INVALID_ITEM;
+
+	for( it = items ; it && code == NA_IEXPORTER_CODE_OK ; it = it->next ){
+		if( !NA_IS_OBJECT_ITEM( it->data )){
+			code = NA_IEXPORTER_CODE_INVALID_ITEM;
+		}
+	}
+
+	if( code == NA_IEXPORTER_CODE_OK ){
+		writer = NAXML_WRITER( g_object_new( NAXML_WRITER_TYPE, NULL ));
+
+		writer->private->provider = ( NAIExporter * ) instance;
+		writer->private->messages = messages ? *messages : NULL;
+		writer->private->fn_str = find_export_format_fn( format );
+
+		if( !writer->private->fn_str ){
+			code = NA_IEXPORTER_CODE_INVALID_FORMAT;
+
+		} else {
+			writer->private->stream = stream;
+			code = writer_export_items( writer, items );
+
+			if( writer->private->error ){
+				writer->private->messages = g_slist_append( writer->private->messages,
+						g_strdup_printf( "%s: %s", thisfn, writer->private->error->message ));
+			}
+		}
+
+		if( messages ){
+			*messages = writer->private->messages;
 		}
 
 		g_object_unref( writer );
@@ -391,21 +533,123 @@ naxml_writer_export_to_file( const NAIExporter *instance, NAIExporterFileParmsv2
 	return( code );
 }
 
-static xmlDocPtr
-build_xml_doc( NAXMLWriter *writer )
+/*
+ * stream the XML document
+ *
+ * when exporting only one item, we have one list element for this item,
+ * as up to 3.2 ; else all items are written in the same list element
+ */
+static guint
+writer_export_items( NAXMLWriter *writer, GList *items )
 {
-	writer->private->doc = xmlNewDoc( BAD_CAST( "1.0" ));
+	static const gchar *thisfn = "naxml_writer_writer_export_items";
+	xmlOutputBufferPtr output;
+	GList *it;
+	guint code;
+
+	code = NA_IEXPORTER_CODE_OK;
+	writer->private->multi = ( items && items->next );
 
-	writer->private->root_node = xmlNewNode( NULL, BAD_CAST( writer->private->fn_str->root_node ));
-	xmlDocSetRootElement( writer->private->doc, writer->private->root_node );
+	output = xmlOutputBufferCreateIO(
+			( xmlOutputWriteCallback ) writer_output_write,
+			( xmlOutputCloseCallback ) writer_output_close,
+			writer, NULL );
+	writer->private->xml = output ? xmlNewTextWriter( output ) : NULL;
 
-	na_ifactory_provider_write_item(
-			NA_IFACTORY_PROVIDER( writer->private->provider ),
-			writer,
-			NA_IFACTORY_OBJECT( writer->private->exported ),
-			writer->private->messages ? & writer->private->messages : NULL );
+	if( !writer->private->xml ){
+		g_warning( "%s: unable to allocate a new xmlTextWriter", thisfn );
+		return( NA_IEXPORTER_CODE_ERROR );
+	}
+
+	xmlTextWriterSetIndent( writer->private->xml, 1 );
+	xmlTextWriterSetIndentString( writer->private->xml, BAD_CAST( "  " ));
+	xmlTextWriterStartDocument( writer->private->xml, "1.0", "UTF-8", NULL );
+	xmlTextWriterStartElement( writer->private->xml, BAD_CAST( writer->private->fn_str->root_node ));
+
+	if( writer->private->multi ){
+		write_list_start( writer, NULL );
+	}
+
+	for( it = items ; it && !writer->private->error ; it = it->next ){
+		writer->private->exported = NA_OBJECT_ITEM( it->data );
+		g_free( writer->private->item_id );
+		writer->private->item_id = na_object_get_id( writer->private->exported );
+
+		if( !writer->private->multi ){
+			write_list_start( writer, writer->private->exported );
+		}
+
+		na_ifactory_provider_write_item(
+				NA_IFACTORY_PROVIDER( writer->private->provider ),
+				writer,
+				NA_IFACTORY_OBJECT( writer->private->exported ),
+				writer->private->messages ? & writer->private->messages : NULL );
+
+		if( !writer->private->multi ){
+			xmlTextWriterEndElement( writer->private->xml );
+		}
+	}
+
+	/* this closes all opened elements, then flushes the output
+	 */
+	xmlTextWriterEndDocument( writer->private->xml );
+	xmlFreeTextWriter( writer->private->xml );
+	writer->private->xml = NULL;
 
-	return( writer->private->doc );
+	if( writer->private->error ){
+		g_warning( "%s: %s", thisfn, writer->private->error->message );
+		code = NA_IEXPORTER_CODE_UNABLE_TO_WRITE;
+	}
+
+	return( code );
+}
+
+/*
+ * xmlOutputWriteCallback: called by libxml2 each time its output buffer
+ * has to be flushed
+ */
+static int
+writer_output_write( NAXMLWriter *writer, const char *buffer, int len )
+{
+	gsize written;
+
+	if( writer->private->error ){
+		return( -1 );
+	}
+
+	if( writer->private->stream ){
+		if( !g_output_stream_write_all( writer->private->stream, buffer, len, &written, NULL, &writer->private->error )){
+			return( -1 );
+		}
+
+	} else {
+		g_string_append_len( writer->private->string, buffer, len );
+	}
+
+	return( len );
+}
+
+/*
+ * xmlOutputCloseCallback: the output is owned by the caller
+ */
+static int
+writer_output_close( NAXMLWriter *writer )
+{
+	return( 0 );
+}
+
+/*
+ * open the list element
+ * @item is %NULL when several items are exported in this same list
+ */
+static void
+write_list_start( NAXMLWriter *writer, const NAObjectItem *item )
+{
+	xmlTextWriterStartElement( writer->private->xml, BAD_CAST( writer->private->fn_str->list_node ));
+
+	if( writer->private->fn_str->write_list_attribs_fn ){
+		( *writer->private->fn_str->write_list_attribs_fn )( writer, item );
+	}
 }
 
 guint
@@ -421,12 +665,6 @@ naxml_writer_write_start( const NAIFactoryProvider *provider, void *writer_data,
 
 		writer = NAXML_WRITER( writer_data );
 
-		writer->private->list_node = xmlNewChild( writer->private->root_node, NULL, BAD_CAST( writer->private->fn_str->list_node ), NULL );
-
-		if( writer->private->fn_str->write_list_attribs_fn ){
-			( *writer->private->fn_str->write_list_attribs_fn )( writer, NA_OBJECT_ITEM( object ));
-		}
-
 		groups = na_ifactory_object_get_data_groups( object );
 		write_start_write_type( writer, NA_OBJECT_ITEM( object ), groups );
 		write_start_write_version( writer, NA_OBJECT_ITEM( object ), groups );
@@ -435,7 +673,7 @@ naxml_writer_write_start( const NAIFactoryProvider *provider, void *writer_data,
 	return( NA_IIO_PROVIDER_CODE_OK );
 }
 
-/* at end of write_start (list_node already created)
+/* at end of write_start (list element already opened)
  * explicitly write the 'Type' node
  */
 static void
@@ -444,8 +682,6 @@ write_start_write_type( NAXMLWriter *writer, NAObjectItem *object, const NADataG
 	const NADataDef *def;
 	const gchar *svalue;
 
-	writer->private->schema_node = NULL;
-	writer->private->locale_node = NULL;
 	def = na_data_def_get_data_def( groups, NA_FACTORY_OBJECT_ITEM_GROUP, NAFO_DATA_TYPE );
 	svalue = NA_IS_OBJECT_ACTION( object ) ? NAGP_VALUE_TYPE_ACTION : NAGP_VALUE_TYPE_MENU;
 
@@ -459,8 +695,6 @@ write_start_write_version( NAXMLWriter *writer, NAObjectItem *object, const NADa
 	guint iversion;
 	gchar *svalue;
 
-	writer->private->schema_node = NULL;
-	writer->private->locale_node = NULL;
 	def = na_data_def_get_data_def( groups, NA_FACTORY_OBJECT_ITEM_GROUP, NAFO_DATA_IVERSION );
 	iversion = na_object_get_iversion( object );
 	svalue = g_strdup_printf( "%d", iversion );
@@ -487,9 +721,6 @@ naxml_writer_write_data( const NAIFactoryProvider *provider, void *writer_data,
 
 		writer = NAXML_WRITER( writer_data );
 
-		writer->private->schema_node = NULL;
-		writer->private->locale_node = NULL;
-
 		( *writer->private->fn_str->write_data_fn )( writer, NA_OBJECT_ID( object ), boxed, def );
 	}
 
@@ -505,34 +736,39 @@ naxml_writer_write_done( const NAIFactoryProvider *provider, void *writer_data,
 static void
 write_data_schema_v1( NAXMLWriter *writer, const NAObjectId *object, const NADataBoxed *boxed, const NADataDef *def )
 {
-	write_data_schema_v2( writer, object, boxed, def );
+	write_data_schema_start( writer, object, boxed, def );
 
 	write_data_schema_v1_element( writer, def );
+
+	write_data_schema_end( writer );
 }
 
+/*
+ * complete the <schema> element opened by write_data_schema_v2_element()
+ */
 static void
 write_data_schema_v1_element( NAXMLWriter *writer, const NADataDef *def )
 {
-	if( !writer->private->locale_node ){
-		writer->private->locale_node = xmlNewChild( writer->private->schema_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LOCALE ), NULL );
-		xmlNewProp( writer->private->locale_node, BAD_CAST( "name" ), BAD_CAST( "C" ));
+	if( !writer->private->locale_opened ){
+		xmlTextWriterStartElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LOCALE ));
+		xmlTextWriterWriteAttribute( writer->private->xml, BAD_CAST( "name" ), BAD_CAST( "C" ));
+		writer->private->locale_opened = TRUE;
 	}
 
-	xmlNewChild( writer->private->schema_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_OWNER ), BAD_CAST( PACKAGE_TARNAME ));
-	xmlNewChild( writer->private->locale_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LOCALE_SHORT ), BAD_CAST( gettext( def->short_label )));
-	xmlNewChild( writer->private->locale_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LOCALE_LONG ), BAD_CAST( gettext( def->long_label )));
+	xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LOCALE_SHORT ), BAD_CAST( gettext( def->short_label )));
+	xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LOCALE_LONG ), BAD_CAST( gettext( def->long_label )));
+	xmlTextWriterEndElement( writer->private->xml );
+	writer->private->locale_opened = FALSE;
+
+	xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_OWNER ), BAD_CAST( PACKAGE_TARNAME ));
 }
 
 static void
 write_type_schema_v1( NAXMLWriter *writer, const NAObjectItem *object, const NADataDef *def, const gchar *value )
 {
-	gchar *object_id;
-
-	object_id = na_object_get_id( object );
-	write_data_schema_v2_element( writer, def, object_id, value );
+	write_data_schema_v2_element( writer, def, writer->private->item_id, value );
 	write_data_schema_v1_element( writer, def );
-
-	g_free( object_id );
+	write_data_schema_end( writer );
 }
 
 /*
@@ -542,6 +778,21 @@ write_type_schema_v1( NAXMLWriter *writer, const NAObjectItem *object, const NAD
  */
 static void
 write_data_schema_v2( NAXMLWriter *writer, const NAObjectId *object, const NADataBoxed *boxed, const NADataDef *def )
+{
+	write_data_schema_start( writer, object, boxed, def );
+
+	write_data_schema_end( writer );
+}
+
+/*
+ * <schema>
+ *  <key>/schemas/apps/nautilus-actions/configurations/entry</key>
+ *  <applyto>/apps/nautilus-actions/configurations/item_id/profile_id/entry</applyto>
+ *
+ * the <schema> element is left opened
+ */
+static void
+write_data_schema_start( NAXMLWriter *writer, const NAObjectId *object, const NADataBoxed *boxed, const NADataDef *def )
 {
 	gchar *object_id;
 	gchar *value_str;
@@ -569,10 +820,7 @@ write_data_schema_v2( NAXMLWriter *writer, const NAObjectId *object, const NADat
 	object_id = na_object_get_id( object );
 
 	if( NA_IS_OBJECT_PROFILE( object )){
-		NAObjectItem *action = na_object_get_parent( object );
-		gchar *id = na_object_get_id( action );
-		gchar *tmp = g_strdup_printf( "%s/%s", id, object_id );
-		g_free( id );
+		gchar *tmp = g_strdup_printf( "%s/%s", writer->private->item_id, object_id );
 		g_free( object_id );
 		object_id = tmp;
 	}
@@ -587,39 +835,52 @@ write_data_schema_v2( NAXMLWriter *writer, const NAObjectId *object, const NADat
  * <schema>
  *  <key>/schemas/apps/nautilus-actions/configurations/entry</key>
  *  <applyto>/apps/nautilus-actions/configurations/item_id/profile_id/entry</applyto>
+ *
+ * the <schema> element, and maybe a <locale> one, are left opened
  */
 static void
 write_data_schema_v2_element( NAXMLWriter *writer, const NADataDef *def, const gchar *object_id, const gchar *value_str )
 {
-	xmlChar *content;
-	xmlNodePtr parent_value_node;
+	gchar *content;
 
-	writer->private->schema_node = xmlNewChild( writer->private->list_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE ), NULL );
+	xmlTextWriterStartElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE ));
 
-	content = BAD_CAST( g_build_path( "/", NAGP_SCHEMAS_PATH, def->gconf_entry, NULL ));
-	xmlNewChild( writer->private->schema_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_KEY ), content );
-	xmlFree( content );
+	content = g_build_path( "/", NAGP_SCHEMAS_PATH, def->gconf_entry, NULL );
+	xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_KEY ), BAD_CAST( content ));
+	g_free( content );
 
-	content = BAD_CAST( g_build_path( "/", NAGP_CONFIGURATIONS_PATH, object_id, def->gconf_entry, NULL ));
-	xmlNewChild( writer->private->schema_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_APPLYTO ), content );
-	xmlFree( content );
+	content = g_build_path( "/", NAGP_CONFIGURATIONS_PATH, object_id, def->gconf_entry, NULL );
+	xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_APPLYTO ), BAD_CAST( content ));
+	g_free( content );
 
-	xmlNewChild( writer->private->schema_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_TYPE ), BAD_CAST( na_data_types_get_gconf_dump_key( def->type )));
+	xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_TYPE ), BAD_CAST( na_data_types_get_gconf_dump_key( def->type )));
 	if( def->type == NA_DATA_TYPE_STRING_LIST ){
-		xmlNewChild( writer->private->schema_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LISTTYPE ), BAD_CAST( "string" ));
+		xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LISTTYPE ), BAD_CAST( "string" ));
 	}
 
-	parent_value_node = writer->private->schema_node;
+	writer->private->locale_opened = FALSE;
 
 	if( def->localizable ){
-		writer->private->locale_node = xmlNewChild( writer->private->schema_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LOCALE ), NULL );
-		xmlNewProp( writer->private->locale_node, BAD_CAST( "name" ), BAD_CAST( "C" ));
-		parent_value_node = writer->private->locale_node;
+		xmlTextWriterStartElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_LOCALE ));
+		xmlTextWriterWriteAttribute( writer->private->xml, BAD_CAST( "name" ), BAD_CAST( "C" ));
+		writer->private->locale_opened = TRUE;
+	}
+
+	xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_SCHEMA_NODE_DEFAULT ), BAD_CAST( value_str ));
+}
+
+/*
+ * close the <schema> element
+ */
+static void
+write_data_schema_end( NAXMLWriter *writer )
+{
+	if( writer->private->locale_opened ){
+		xmlTextWriterEndElement( writer->private->xml );
+		writer->private->locale_opened = FALSE;
 	}
 
-	content = xmlEncodeSpecialChars( writer->private->doc, BAD_CAST( value_str ));
-	xmlNewChild( parent_value_node, NULL, BAD_CAST( NAXML_KEY_SCHEMA_NODE_DEFAULT ), content );
-	xmlFree( content );
+	xmlTextWriterEndElement( writer->private->xml );
 }
 
 /*
@@ -630,26 +891,31 @@ write_data_schema_v2_element( NAXMLWriter *writer, const NADataDef *def, const g
 static void
 write_type_schema_v2( NAXMLWriter *writer, const NAObjectItem *object, const NADataDef *def, const gchar *value )
 {
-	gchar *object_id;
-
-	object_id = na_object_get_id( object );
-	write_data_schema_v2_element( writer, def, object_id, value );
-
-	g_free( object_id );
+	write_data_schema_v2_element( writer, def, writer->private->item_id, value );
+	write_data_schema_end( writer );
 }
 
+/*
+ * @object is %NULL when several items are exported in the same list
+ */
 static void
 write_list_attribs_dump( NAXMLWriter *writer, const NAObjectItem *object )
 {
 	gchar *id;
 	gchar *path;
 
-	id = na_object_get_id( object );
-	path = g_build_path( "/", NAGP_CONFIGURATIONS_PATH, id, NULL );
-	xmlNewProp( writer->private->list_node, BAD_CAST( NAXML_KEY_DUMP_LIST_PARM_BASE ), BAD_CAST( path ));
+	if( object ){
+		id = na_object_get_id( object );
+		path = g_build_path( "/", NAGP_CONFIGURATIONS_PATH, id, NULL );
+		g_free( id );
+
+	} else {
+		path = g_strdup( NAGP_CONFIGURATIONS_PATH );
+	}
+
+	xmlTextWriterWriteAttribute( writer->private->xml, BAD_CAST( NAXML_KEY_DUMP_LIST_PARM_BASE ), BAD_CAST( path ));
 
 	g_free( path );
-	g_free( id );
 }
 
 static void
@@ -692,40 +958,48 @@ write_data_dump( NAXMLWriter *writer, const NAObjectId *object, const NADataBoxe
 	g_free( value_str );
 }
 
+/*
+ * when several items are exported in the same list, the key is relative
+ * to the configurations path, and so prefixed with the item id
+ */
 static void
 write_data_dump_element( NAXMLWriter *writer, const NADataDef *def, const NADataBoxed *boxed, const gchar *entry, const gchar *value_str )
 {
-	xmlNodePtr entry_node;
-	xmlNodePtr value_node;
-	xmlNodePtr value_list_node, value_list_value_node;
 	GSList *list, *is;
-	xmlChar *encoded_content;
+	gchar *key;
 
-	entry_node = xmlNewChild( writer->private->list_node, NULL, BAD_CAST( writer->private->fn_str->element_node ), NULL );
+	xmlTextWriterStartElement( writer->private->xml, BAD_CAST( writer->private->fn_str->element_node ));
 
-	xmlNewChild( entry_node, NULL, BAD_CAST( NAXML_KEY_DUMP_NODE_KEY ), BAD_CAST( entry ));
+	if( writer->private->multi ){
+		key = g_strdup_printf( "%s/%s", writer->private->item_id, entry );
+	} else {
+		key = g_strdup( entry );
+	}
+	xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_DUMP_NODE_KEY ), BAD_CAST( key ));
+	g_free( key );
 
-	value_node = xmlNewChild( entry_node, NULL, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE ), NULL );
+	xmlTextWriterStartElement( writer->private->xml, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE ));
 
 	if( def->type == NA_DATA_TYPE_STRING_LIST ){
-		value_list_node = xmlNewChild( value_node, NULL, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE_LIST ), NULL );
-		xmlNewProp( value_list_node, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE_LIST_PARM_TYPE ), BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE_TYPE_STRING ));
-		value_list_value_node = xmlNewChild( value_list_node, NULL, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE ), NULL );
+		xmlTextWriterStartElement( writer->private->xml, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE_LIST ));
+		xmlTextWriterWriteAttribute( writer->private->xml, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE_LIST_PARM_TYPE ), BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE_TYPE_STRING ));
+		xmlTextWriterStartElement( writer->private->xml, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE ));
 		list = ( GSList * ) na_boxed_get_as_void( NA_BOXED( boxed ));
 
 		for( is = list ; is ; is = is->next ){
-			encoded_content = xmlEncodeSpecialChars( writer->private->doc, BAD_CAST(( gchar * ) is->data ));
-			xmlNewChild( value_list_value_node, NULL, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE_TYPE_STRING ), encoded_content );
-			xmlFree( encoded_content );
+			xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( NAXML_KEY_DUMP_NODE_VALUE_TYPE_STRING ), BAD_CAST(( gchar * ) is->data ));
 		}
 
 		na_core_utils_slist_free( list );
+		xmlTextWriterEndElement( writer->private->xml );
+		xmlTextWriterEndElement( writer->private->xml );
 
 	} else {
-		encoded_content = xmlEncodeSpecialChars( writer->private->doc, BAD_CAST( value_str ));
-		xmlNewChild( value_node, NULL, BAD_CAST( na_data_types_get_gconf_dump_key( def->type )), encoded_content );
-		xmlFree( encoded_content );
+		xmlTextWriterWriteElement( writer->private->xml, BAD_CAST( na_data_types_get_gconf_dump_key( def->type )), BAD_CAST( value_str ));
 	}
+
+	xmlTextWriterEndElement( writer->private->xml );
+	xmlTextWriterEndElement( writer->private->xml );
 }
 
 static void
@@ -804,12 +1078,15 @@ find_export_format_fn_from_quark( GQuark format )
 
 /*
  * get_output_fname:
- * @item: the #NAObjectItme-derived object to be exported.
+ * @items: the list of #NAObjectItem-derived objects to be exported.
  * @folder: the URI of the directoy where to write the output XML file.
  * @format: the export format.
  *
  * Returns: a filename suitable for writing the output XML.
  *
+ * The filename is built from the identifier of the item when there is
+ * only one, or from the name of the package else.
+ *
  * As we don't want overwrite already existing files, the candidate
  * filename is incremented until we find an available filename.
  *
@@ -820,20 +1097,22 @@ find_export_format_fn_from_quark( GQuark format )
  * between our test of inexistance and the actual write.
  */
 static gchar *
-get_output_fname( const NAObjectItem *item, const gchar *folder, const gchar *format )
+get_output_fname( GList *items, const gchar *folder, const gchar *format )
 {
 	static const gchar *thisfn = "naxml_writer_get_output_fname";
+	NAObjectItem *item;
 	gchar *item_id;
 	gchar *canonical_fname = NULL;
 	gchar *canonical_ext = NULL;
 	gchar *candidate_fname;
 	gint counter;
 
-	g_return_val_if_fail( NA_IS_OBJECT_ITEM( item ), NULL );
+	g_return_val_if_fail( items && NA_IS_OBJECT_ITEM( items->data ), NULL );
 	g_return_val_if_fail( folder, NULL );
 	g_return_val_if_fail( strlen( folder ), NULL );
 
-	item_id = na_object_get_id( item );
+	item = NA_OBJECT_ITEM( items->data );
+	item_id = items->next ? g_strdup( PACKAGE_TARNAME ) : na_object_get_id( item );
 
 	if( !strcmp( format, NAXML_FORMAT_GCONF_SCHEMA_V1 )){
 		canonical_fname = g_strdup_printf( "config_%s", item_id );
@@ -844,7 +1123,9 @@ get_output_fname( const NAObjectItem *item, const gchar *folder, const gchar *fo
 		canonical_ext = g_strdup( "schema" );
 
 	} else if( !strcmp( format, NAXML_FORMAT_GCONF_ENTRY )){
-		canonical_fname = g_strdup_printf( "%s-%s", NA_IS_OBJECT_ACTION( item ) ? "action" : "menu", item_id );
+		canonical_fname = items->next
+				? g_strdup( item_id )
+				: g_strdup_printf( "%s-%s", NA_IS_OBJECT_ACTION( item ) ? "action" : "menu", item_id );
 		canonical_ext = g_strdup( "xml" );
 
 	} else {
@@ -878,23 +1159,29 @@ get_output_fname( const NAObjectItem *item, const gchar *folder, const gchar *fo
 
 /*
  * output_xml_to_file:
- * @xml: the xml buffer.
+ * @writer: this #NAXMLWriter instance.
+ * @items: the list of #NAObjectItem-derived objects to be exported.
  * @filename: the full path of the output filename as an URI.
  * @msg: a GSList to append messages.
  *
- * Exports an item to the given filename.
+ * Exports the items to the given filename, streaming the XML document
+ * directly to the file. An existing target is only replaced when the
+ * whole document has been successfully written.
+ *
+ * Returns: the export operation code.
  */
-static void
-output_xml_to_file( const gchar *xml, const gchar *filename, GSList **msg )
+static guint
+output_xml_to_file( NAXMLWriter *writer, GList *items, const gchar *filename, GSList **msg )
 {
 	static const gchar *thisfn = "naxml_writer_output_xml_to_file";
 	GFile *file;
 	GFileOutputStream *stream;
+	GCancellable *cancellable;
 	GError *error = NULL;
 	gchar *errmsg;
+	guint code;
 
-	g_return_if_fail( xml );
-	g_return_if_fail( filename && g_utf8_strlen( filename, -1 ));
+	g_return_val_if_fail( filename && g_utf8_strlen( filename, -1 ), NA_IEXPORTER_CODE_INVALID_TARGET );
 
 	g_debug( "%s: filename=%s", thisfn, filename );
 
@@ -912,23 +1199,35 @@ output_xml_to_file( const gchar *xml, const gchar *filename, GSList **msg )
 			g_object_unref( stream );
 		}
 		g_object_unref( file );
-		return;
+		return( NA_IEXPORTER_CODE_INVALID_TARGET );
 	}
 
-	g_output_stream_write( G_OUTPUT_STREAM( stream ), xml, g_utf8_strlen( xml, -1 ), NULL, &error );
-	if( error ){
-		errmsg = g_strdup_printf( "%s: g_output_stream_write: %s", thisfn, error->message );
-		g_warning( "%s", errmsg );
+	writer->private->stream = G_OUTPUT_STREAM( stream );
+	code = writer_export_items( writer, items );
+	writer->private->stream = NULL;
+
+	if( writer->private->error ){
+		errmsg = g_strdup_printf( "%s: g_output_stream_write: %s", thisfn, writer->private->error->message );
 		if( msg ){
 			*msg = g_slist_append( *msg, errmsg );
+		} else {
+			g_free( errmsg );
 		}
-		g_error_free( error );
-		g_object_unref( stream );
-		g_object_unref( file );
-		return;
 	}
 
-	g_output_stream_close( G_OUTPUT_STREAM( stream ), NULL, &error );
+	/* on error, close the stream with an already cancelled GCancellable:
+	 * GIO then drops the replacement, and the target is left untouched
+	 */
+	if( code != NA_IEXPORTER_CODE_OK ){
+		cancellable = g_cancellable_new();
+		g_cancellable_cancel( cancellable );
+		g_output_stream_close( G_OUTPUT_STREAM( stream ), cancellable, NULL );
+		g_object_unref( cancellable );
+
+	} else {
+		g_output_stream_close( G_OUTPUT_STREAM( stream ), NULL, &error );
+	}
+
 	if( error ){
 		errmsg = g_strdup_printf( "%s: g_output_stream_close: %s", thisfn, error->message );
 		g_warning( "%s", errmsg );
@@ -936,32 +1235,11 @@ output_xml_to_file( const gchar *xml, const gchar *filename, GSList **msg )
 			*msg = g_slist_append( *msg, errmsg );
 		}
 		g_error_free( error );
-		g_object_unref( stream );
-		g_object_unref( file );
-		return;
+		code = NA_IEXPORTER_CODE_UNABLE_TO_WRITE;
 	}
 
 	g_object_unref( stream );
 	g_object_unref( file );
-}
-
-static guint
-writer_to_buffer( NAXMLWriter *writer )
-{
-	guint code;
-	xmlDocPtr doc;
-	xmlChar *text;
-	int textlen;
-
-	code = NA_IEXPORTER_CODE_OK;
-	doc = build_xml_doc( writer );
-
-	xmlDocDumpFormatMemoryEnc( doc, &text, &textlen, "UTF-8", 1 );
-	writer->private->buffer = g_strdup(( const gchar * ) text );
-
-	xmlFree( text );
-	xmlFreeDoc (doc);
-	xmlCleanupParser();
 
 	return( code );
 }
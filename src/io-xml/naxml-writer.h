@@ -38,6 +38,8 @@
  * This class exports Nautilus-Actions actions and menus as XML files.
  */
 
+#include <gio/gio.h>
+
 #include <api/na-data-boxed.h>
 #include <api/na-iexporter.h>
 #include <api/na-ifactory-provider.h>
@@ -73,6 +75,8 @@ GType  naxml_writer_get_type( void );
 
 guint  naxml_writer_export_to_buffer( const NAIExporter *instance, NAIExporterBufferParmsv2 *parms );
 guint  naxml_writer_export_to_file  ( const NAIExporter *instance, NAIExporterFileParmsv2 *parms );
+guint  naxml_writer_export_to_stream( const NAIExporter *instance, GList *items, const gchar *format, GOutputStream *stream, GSList **messages );
+guint  naxml_writer_export_items_to_file( const NAIExporter *instance, NAIExporterItemsParmsv2 *parms );
 
 guint  naxml_writer_write_start( const NAIFactoryProvider *writer, void *writer_data, const NAIFactoryObject *object, GSList **messages  );
 guint  naxml_writer_write_data ( const NAIFactoryProvider *writer, void *writer_data, const NAIFactoryObject *object, const NADataBoxed *boxed, GSList **messages );
@@ -121,6 +121,7 @@ static void       on_folder_chooser_selection_changed( GtkFileChooser *chooser,
 static void       assistant_prepare( BaseAssistant *window, GtkAssistant *assistant, GtkWidget *page );
 static void       assist_prepare_confirm( NactAssistantExport *window, GtkAssistant *assistant, GtkWidget *page );
 static void       assistant_apply( BaseAssistant *window, GtkAssistant *assistant );
+static gboolean   assistant_apply_items( NactAssistantExport *window, NAUpdater *updater );
 static void       assist_prepare_exportdone( NactAssistantExport *window, GtkAssistant *assistant, GtkWidget *page );
 static void       free_results( GList *list );
 
@@ -797,6 +798,10 @@ assistant_apply( BaseAssistant *wnd, GtkAssistant *assistant )
 
 	g_return_if_fail( window->private->uri && strlen( window->private->uri ));
 
+	if( assistant_apply_items( window, updater )){
+		return;
+	}
+
 	for( ia = window->private->selected_items ; ia ; ia = ia->next ){
 		str = g_new0( ExportStruct, 1 );
 		window->private->results = g_list_append( window->private->results, str );
@@ -819,11 +824,74 @@ assistant_apply( BaseAssistant *wnd, GtkAssistant *assistant )
 			str->fname = na_exporter_to_file( NA_PIVOT( updater ), str->item, window->private->uri, str->format, &str->msg );
 		}
 
-		g_free( str->format );
 		first = FALSE;
 	}
 }
 
+/*
+ * When several items are to be exported in the same preferred format,
+ * and the exporter is able to, all items are exported to a single file,
+ * through a single exporter call.
+ *
+ * Returns: %TRUE if the items have been exported here.
+ */
+static gboolean
+assistant_apply_items( NactAssistantExport *window, NAUpdater *updater )
+{
+	static const gchar *thisfn = "nact_assistant_export_apply_items";
+	gchar *format;
+	gboolean exported;
+	GList *items, *ia;
+	ExportStruct *str;
+	GSList *msg;
+	gchar *fname;
+
+	exported = FALSE;
+	format = na_settings_get_string( NA_IPREFS_EXPORT_PREFERRED_FORMAT, NULL, NULL );
+	g_return_val_if_fail( format && strlen( format ), FALSE );
+
+	if( g_list_length( window->private->selected_items ) > 1 &&
+		strcmp( format, EXPORTER_FORMAT_ASK ) != 0 &&
+		strcmp( format, EXPORTER_FORMAT_NOEXPORT ) != 0 &&
+		na_exporter_can_export_items( NA_PIVOT( updater ), format )){
+
+		g_debug( "%s: format=%s", thisfn, format );
+		items = NULL;
+
+		for( ia = window->private->selected_items ; ia ; ia = ia->next ){
+			str = g_new0( ExportStruct, 1 );
+			window->private->results = g_list_append( window->private->results, str );
+
+			str->item = NA_OBJECT_ITEM( na_object_get_origin( NA_IDUPLICABLE( ia->data )));
+			str->format = g_strdup( format );
+			items = g_list_prepend( items, str->item );
+		}
+
+		items = g_list_reverse( items );
+		msg = NULL;
+		fname = na_exporter_items_to_file( NA_PIVOT( updater ), items, window->private->uri, format, &msg );
+		g_list_free( items );
+
+		/* all items share the same output file
+		 * messages are attached to the first one
+		 */
+		for( ia = window->private->results ; ia ; ia = ia->next ){
+			str = ( ExportStruct * ) ia->data;
+			str->fname = g_strdup( fname );
+		}
+
+		str = ( ExportStruct * ) window->private->results->data;
+		str->msg = msg;
+
+		g_free( fname );
+		exported = TRUE;
+	}
+
+	g_free( format );
+
+	return( exported );
+}
+
 static void
 assist_prepare_exportdone( NactAssistantExport *window, GtkAssistant *assistant, GtkWidget *page )
 {
@@ -891,7 +959,7 @@ assist_prepare_exportdone( NactAssistantExport *window, GtkAssistant *assistant,
 			/* i18n: action as been successfully exported to <filename> */
 			text = g_strdup_printf( "%s %s", _( "Successfully exported as" ), str->fname );
 
-		} else if( strcmp( str->format, EXPORTER_FORMAT_NOEXPORT ) != 0 ){
+		} else if( !str->format || strcmp( str->format, EXPORTER_FORMAT_NOEXPORT ) != 0 ){
 			errors += 1;
 		}
 
@@ -942,7 +1010,9 @@ free_results( GList *list )
 	for( ir = list ; ir ; ir = ir->next ){
 		str = ( ExportStruct * ) ir->data;
 		g_free( str->fname );
+		g_free( str->format );
 		na_core_utils_slist_free( str->msg );
+		g_free( str );
 	}
 
 	g_list_free( list );
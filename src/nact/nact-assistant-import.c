@@ -506,6 +506,7 @@ on_file_selection_changed( GtkFileChooser *chooser, gpointer user_data )
 
 /*
  * enable forward button if current selection has at least one loadable file
+ * size is not limited here, as some I/O providers are able to stream big files
  */
 static gboolean
 has_loadable_files( GSList *uris )
@@ -521,7 +522,7 @@ has_loadable_files( GSList *uris )
 			continue;
 		}
 
-		if( na_core_utils_file_is_loadable( uri )){
+		if( na_core_utils_file_is_streamable( uri )){
 			loadables += 1;
 		}
 	}
@@ -274,6 +274,8 @@ nact_menubar_file_save_items( BaseWindow *window )
 	NAObjectItem *duplicate;
 	GSList *messages;
 	gchar *msg;
+	guint save_ret;
+	gboolean committed;
 
 	BAR_WINDOW_VOID( window );
 
@@ -304,6 +306,12 @@ nact_menubar_file_save_items( BaseWindow *window )
 		g_signal_emit_by_name( window, TREE_SIGNAL_LEVEL_ZERO_CHANGED, FALSE );
 	}
 
+	/* all deletions and writes are made in one batch, so that the I/O
+	 * providers are able to flush them together, and do not report our
+	 * own modifications back to us
+	 */
+	na_updater_begin_batch( bar->private->updater );
+
 	/* remove deleted items
 	 * so that new actions with same id do not risk to be deleted later
 	 * not deleted items are reinserted in the tree
@@ -329,14 +337,31 @@ nact_menubar_file_save_items( BaseWindow *window )
 	 * above all, it is less costly to check the status here, than to check
 	 * recursively each and every modified item
 	 */
-	new_pivot = NULL;
-
 	for( it = items ; it ; it = it->next ){
 		save_item( window, bar->private->updater, NA_OBJECT_ITEM( it->data ), &messages );
-		duplicate = NA_OBJECT_ITEM( na_object_duplicate( it->data, DUPLICATE_REC ));
-		na_object_reset_origin( it->data, duplicate );
-		na_object_check_status( it->data );
-		new_pivot = g_list_prepend( new_pivot, duplicate );
+	}
+
+	save_ret = na_updater_commit_batch( bar->private->updater, &messages );
+	if( save_ret != NA_IIO_PROVIDER_CODE_OK ){
+		g_warning( "%s: unable to commit the batch: save_ret=%d", thisfn, save_ret );
+	}
+
+	/* items are only marked as saved once the batch has been committed:
+	 * when the commit fails, we cannot know which of the modified items
+	 * have actually been written, so they all stay modified, and the pivot
+	 * is left unchanged; the I/O providers have reported the files they
+	 * were not able to write
+	 */
+	committed = ( save_ret == NA_IIO_PROVIDER_CODE_OK );
+	new_pivot = NULL;
+
+	if( committed ){
+		for( it = items ; it ; it = it->next ){
+			duplicate = NA_OBJECT_ITEM( na_object_duplicate( it->data, DUPLICATE_REC ));
+			na_object_reset_origin( it->data, duplicate );
+			na_object_check_status( it->data );
+			new_pivot = g_list_prepend( new_pivot, duplicate );
+		}
 	}
 
 	if( g_slist_length( messages )){
@@ -347,10 +372,12 @@ nact_menubar_file_save_items( BaseWindow *window )
 		messages = NULL;
 	}
 
-	na_pivot_set_new_items( NA_PIVOT( bar->private->updater ), g_list_reverse( new_pivot ));
+	if( committed ){
+		na_pivot_set_new_items( NA_PIVOT( bar->private->updater ), g_list_reverse( new_pivot ));
+	}
 	na_object_free_items( items );
 	nact_main_window_block_reload( NACT_MAIN_WINDOW( window ));
-	g_signal_emit_by_name( window, TREE_SIGNAL_MODIFIED_STATUS_CHANGED, FALSE );
+	g_signal_emit_by_name( window, TREE_SIGNAL_MODIFIED_STATUS_CHANGED, !committed );
 }
 
 /*
@@ -45,6 +45,7 @@
 
 #include <core/na-pivot.h>
 #include <core/na-about.h>
+#include <core/na-gconf-migration.h>
 #include <core/na-selected-info.h>
 #include <core/na-tokens.h>
 
@@ -64,6 +65,7 @@ struct _NautilusActionsPrivate {
 	gulong    items_changed_handler;
 	gulong    settings_changed_handler;
 	NATimeout change_timeout;
+	gboolean  reload_needed;
 };
 
 static GObjectClass *st_parent_class  = NULL;
@@ -104,6 +106,7 @@ static void              execute_about( NautilusMenuItem *item, NautilusActions
 
 static void              on_pivot_items_changed_handler( NAPivot *pivot, NautilusActions *plugin );
 static void              on_settings_key_changed_handler( const gchar *group, const gchar *key, gconstpointer new_value, gboolean mandatory, NautilusActions *plugin );
+static void              on_gconf_migration_done( NautilusActions *plugin );
 static void              on_change_event_timeout( NautilusActions *plugin );
 
 GType
@@ -183,6 +186,7 @@ instance_init( GTypeInstance *instance, gpointer klass )
 	self->private->change_timeout.handler = ( NATimeoutFunc ) on_change_event_timeout;
 	self->private->change_timeout.user_data = self;
 	self->private->change_timeout.source_id = 0;
+	self->private->reload_needed = FALSE;
 }
 
 /*
@@ -215,11 +219,23 @@ instance_constructed( GObject *object )
 
 		g_debug( "%s: object=%p (%s)", thisfn, ( void * ) object, G_OBJECT_TYPE_NAME( object ));
 
+		/* pwi 2011-01-05
+		 * run GConf migration tools before allocating a new NAPivot
+		 *
+		 * the migration is only run once per version, and does not block
+		 * Nautilus start-up: the GConf I/O provider is not read while the
+		 * migration is running, and the items are reloaded when it ends
+		 */
+		if( na_gconf_migration_run_async(( NAGConfMigrationDoneFn ) on_gconf_migration_done, object )){
+			g_object_ref( object );
+		}
+
 		priv->pivot = na_pivot_new();
 
 		/* setup NAPivot properties before loading items
 		 */
 		na_pivot_set_loadable( priv->pivot, !PIVOT_LOAD_DISABLED & !PIVOT_LOAD_INVALID );
+		na_pivot_set_read_only( priv->pivot, TRUE );
 		na_pivot_load_items( priv->pivot );
 
 		/* register against NAPivot to be notified of items changes
@@ -1011,6 +1027,10 @@ execute_about( NautilusMenuItem *item, NautilusActions *plugin )
  *
  * Only when NAPivot has finished with reloading its items list, then we
  * inform the file manager that its items list has changed.
+ *
+ * As our NAPivot is read-only, it keeps itself up to date when i/o
+ * providers signal a modification: we only have to reload the items
+ * when a runtime preference has changed.
  */
 
 /* signal emitted by NAPivot at the end of a burst of 'item-changed' signals
@@ -1039,19 +1059,41 @@ on_settings_key_changed_handler( const gchar *group, const gchar *key, gconstpoi
 
 	if( !plugin->private->dispose_has_run ){
 
+		plugin->private->reload_needed = TRUE;
+		na_timeout_event( &plugin->private->change_timeout );
+	}
+}
+
+/*
+ * the GConf migration has terminated: the items have to be reloaded
+ * the reference taken when starting the migration is released here
+ */
+static void
+on_gconf_migration_done( NautilusActions *plugin )
+{
+	g_return_if_fail( NAUTILUS_IS_ACTIONS( plugin ));
+
+	if( !plugin->private->dispose_has_run ){
+
+		plugin->private->reload_needed = TRUE;
 		na_timeout_event( &plugin->private->change_timeout );
 	}
+
+	g_object_unref( plugin );
 }
 
 /*
- * automatically reloads the items, then signal the file manager.
+ * automatically reloads the items if needed, then signal the file manager.
  */
 static void
 on_change_event_timeout( NautilusActions *plugin )
 {
 	static const gchar *thisfn = "nautilus_actions_on_change_event_timeout";
-	g_debug( "%s: timeout expired", thisfn );
+	g_debug( "%s: timeout expired, reload_needed=%s", thisfn, plugin->private->reload_needed ? "True":"False" );
 
-	na_pivot_load_items( plugin->private->pivot );
+	if( plugin->private->reload_needed ){
+		na_pivot_load_items( plugin->private->pivot );
+		plugin->private->reload_needed = FALSE;
+	}
 	nautilus_menu_provider_emit_items_updated_signal( NAUTILUS_MENU_PROVIDER( plugin ));
 }
@@ -0,0 +1,205 @@
+/*
+ * Nautilus-Actions
+ * A Nautilus extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2014 Pierre Wieser and others (see AUTHORS)
+ *
+ * Nautilus-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * Nautilus-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nautilus-Actions; see the file COPYING. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@gnome-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib-object.h>
+#include <glib/gprintf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <api/na-boxed.h>
+#include <api/na-core-utils.h>
+#include <api/na-data-types.h>
+
+/* a sample of the list values found in imported catalogs
+ */
+static const gchar *lists[] = {
+		"text/plain;image/*;inode/directory;",
+		"*",
+		"[file,sftp,smb]",
+		" [ file , sftp ] ",
+		"  a ; b ;  ",
+		"a;;b",
+		";;",
+		"[]",
+		"[",
+		"",
+		"/home/pierre;/usr/share/applications;/home/pierre;",
+		NULL
+};
+
+static const gchar *uint_lists[] = {
+		"1;2;3",
+		"[10,20,30]",
+		"4;;5;",
+		"",
+		NULL
+};
+
+/* the reference implementation, as it was before the zero-copy parser
+ */
+static gchar **
+string_to_array( const gchar *string )
+{
+	gchar *sdup;
+	gchar **array;
+
+	array = NULL;
+
+	if( string && strlen( string )){
+		sdup = g_strstrip( g_strdup( string ));
+
+		if( sdup[0] == '[' && sdup[strlen(sdup)-1] == ']' ){
+			sdup[0] = ' ';
+			sdup[strlen(sdup)-1] = ' ';
+			sdup = g_strstrip( sdup );
+			array = g_strsplit( sdup, ",", -1 );
+
+		} else {
+			if( g_str_has_suffix( string, ";" )){
+				sdup[strlen(sdup)-1] = ' ';
+				sdup = g_strstrip( sdup );
+			}
+			array = g_strsplit( sdup, ";", -1 );
+		}
+		g_free( sdup );
+	}
+
+	return( array );
+}
+
+static gboolean
+check_string_list( const gchar *string )
+{
+	NABoxed *boxed;
+	GSList *list, *expected, *it, *ie;
+	gchar **array, **i;
+	gboolean ok;
+
+	boxed = na_boxed_new_from_string( NA_DATA_TYPE_STRING_LIST, string );
+	list = na_boxed_get_string_list( boxed );
+
+	expected = NULL;
+	array = string_to_array( string );
+	for( i = array ; i && *i ; ++i ){
+		if( !na_core_utils_slist_count( expected, *i )){
+			expected = g_slist_append( expected, g_strdup( *i ));
+		}
+	}
+	g_strfreev( array );
+
+	ok = ( g_slist_length( list ) == g_slist_length( expected ));
+	for( it = list, ie = expected ; ok && it && ie ; it = it->next, ie = ie->next ){
+		ok = ( strcmp( it->data, ie->data ) == 0 );
+	}
+	g_printf( "%s string_list '%s'\n", ok ? "ok  " : "FAIL", string );
+
+	na_core_utils_slist_free( expected );
+	na_core_utils_slist_free( list );
+	g_object_unref( boxed );
+
+	return( ok );
+}
+
+static gboolean
+check_uint_list( const gchar *string )
+{
+	NABoxed *boxed;
+	GList *list, *it;
+	gchar **array, **i;
+	gboolean ok;
+
+	boxed = na_boxed_new_from_string( NA_DATA_TYPE_UINT_LIST, string );
+	list = na_boxed_get_uint_list( boxed );
+
+	array = string_to_array( string );
+	ok = ( g_list_length( list ) == ( array ? g_strv_length( array ) : 0 ));
+	for( it = list, i = array ; ok && it && i && *i ; it = it->next, ++i ){
+		ok = ( GPOINTER_TO_UINT( it->data ) == ( guint ) atoi( *i ));
+	}
+	g_strfreev( array );
+	g_printf( "%s uint_list   '%s'\n", ok ? "ok  " : "FAIL", string );
+
+	g_list_free( list );
+	g_object_unref( boxed );
+
+	return( ok );
+}
+
+/* parse the sample as many times as a large catalog would do
+ */
+static void
+bench( guint count )
+{
+	GTimer *timer;
+	NABoxed *boxed;
+	guint i;
+	gint j;
+
+	timer = g_timer_new();
+
+	for( i = 0 ; i < count ; ++i ){
+		for( j = 0 ; lists[j] ; ++j ){
+			boxed = na_boxed_new_from_string( NA_DATA_TYPE_STRING_LIST, lists[j] );
+			g_object_unref( boxed );
+		}
+	}
+
+	g_printf( "\n%u string lists parsed in %.3f s\n", count*( g_strv_length(( gchar ** ) lists )), g_timer_elapsed( timer, NULL ));
+	g_timer_destroy( timer );
+}
+
+int
+main( int argc, char** argv )
+{
+	gboolean ok;
+	gint i;
+
+#if !GLIB_CHECK_VERSION( 2,36, 0 )
+	g_type_init();
+#endif
+
+	g_printf( "NABoxed list parsing test.\n\n" );
+
+	ok = TRUE;
+
+	for( i = 0 ; lists[i] ; ++i ){
+		ok &= check_string_list( lists[i] );
+	}
+	for( i = 0 ; uint_lists[i] ; ++i ){
+		ok &= check_uint_list( uint_lists[i] );
+	}
+
+	bench( argc > 1 ? atoi( argv[1] ) : 10000 );
+
+	return( ok ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,302 @@
+/*
+ * Nautilus-Actions
+ * A Nautilus extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2014 Pierre Wieser and others (see AUTHORS)
+ *
+ * Nautilus-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * Nautilus-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nautilus-Actions; see the file COPYING. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@gnome-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <io-desktop/nadp-parser.h>
+
+/* Differential test of the .desktop parser against GKeyFile.
+ *
+ * Each sample of the corpus is loaded both by GKeyFile and by the
+ * parser, and every value is read back through all the accessors; the
+ * two implementations must agree on the values as well as on the
+ * errors. Additional .desktop files may be given on the command line.
+ */
+
+static const gchar *samples[] = {
+		"[Desktop Entry]\nType=Action\nName=My action\nName[fr]=Mon action\nName[C]=C action\n"
+		"Profiles=profile-zero;\nEnabled = false\n\n[X-Action-Profile profile-zero]\nExec=zenity --info\n",
+
+		"# a comment\n\n  [Desktop Entry]  \r\n  Name = spaces around  \r\nHidden=true\r\n",
+
+		"[Desktop Entry]\nName=first\nName=second\n[Other]\nKey=one\n[Desktop Entry]\nName=third\n",
+
+		"[Desktop Entry]\nEscapes=a\\sb\\nc\\td\\re\\\\f\nList=a\\;b;c;;d\\\\;\nBad=a\\xb\nEnd=abc\\\n",
+
+		"[Desktop Entry]\nEmpty=\nSemi=;\nSemis=;;\nTrailing=a;b;\nNoTrailing=a;b\n",
+
+		"[Desktop Entry]\nT1=true\nT2=1\nF1=false\nF2=0\nT3=true  \nX=yes\nX2=True\n",
+
+		"[Desktop Entry]\nI1=42\nI2=-7\nI3=12abc\nI4=\nI5=99999999999999999999\nI6=8 \nI7= 9\n",
+
+		"[Desktop Entry]\nKey With Spaces=value\nName[fr_FR@euro]=euro\nName[sr@Latn]=latin\nName[]=empty\n",
+
+		"Key=before any group\n[Desktop Entry]\n",
+
+		"[Desktop Entry]\nthis is not a key value pair\n",
+
+		"[Desktop Entry]\n=no key\n",
+
+		"[Desk[top]\nKey=value\n",
+
+		"[]\nKey=value\n",
+
+		"[Desktop Entry]\nEncoding=ISO-8859-1\n",
+
+		"[Desktop Entry]\nEncoding=utf-8\nName=ok\n",
+
+		"[Desktop Entry]\nName=no final newline",
+
+		"[Desktop Entry]\nInvalid=\xff\xfe\nList=\xc3\xa9;\xff;\n",
+
+		"[Desktop Entry]\nName[fr]=bad \\x translation\nName=fallback\n",
+
+		"",
+
+		"\n\n# only comments\n",
+
+		NULL
+};
+
+static gboolean
+same_error( const gchar *what, const gchar *key, GError *e1, GError *e2 )
+{
+	gboolean ok;
+
+	ok = (( !e1 && !e2 ) || ( e1 && e2 && e1->domain == e2->domain && e1->code == e2->code ));
+
+	if( !ok ){
+		g_printf( "FAIL %s '%s': GKeyFile error=%d, parser error=%d\n",
+				what, key, e1 ? e1->code : -1, e2 ? e2->code : -1 );
+	}
+
+	if( e1 ){
+		g_error_free( e1 );
+	}
+	if( e2 ){
+		g_error_free( e2 );
+	}
+
+	return( ok );
+}
+
+static gboolean
+same_string( const gchar *what, const gchar *key, gchar *s1, gchar *s2 )
+{
+	gboolean ok;
+
+	ok = ( g_strcmp0( s1, s2 ) == 0 );
+
+	if( !ok ){
+		g_printf( "FAIL %s '%s': GKeyFile='%s', parser='%s'\n", what, key, s1, s2 );
+	}
+
+	g_free( s1 );
+	g_free( s2 );
+
+	return( ok );
+}
+
+static gboolean
+same_strv( const gchar *what, const gchar *key, gchar **v1, gchar **v2 )
+{
+	gboolean ok;
+	guint i;
+
+	ok = (( !v1 && !v2 ) || ( v1 && v2 && g_strv_length( v1 ) == g_strv_length( v2 )));
+
+	for( i = 0 ; ok && v1 && v1[i] ; ++i ){
+		ok = ( strcmp( v1[i], v2[i] ) == 0 );
+	}
+
+	if( !ok ){
+		g_printf( "FAIL %s '%s'\n", what, key );
+	}
+
+	g_strfreev( v1 );
+	g_strfreev( v2 );
+
+	return( ok );
+}
+
+/*
+ * the base key of a localized key, e.g. 'Name' for 'Name[fr]'
+ */
+static gchar *
+base_key( const gchar *key )
+{
+	const gchar *bracket;
+
+	bracket = strchr( key, '[' );
+
+	return( bracket ? g_strndup( key, bracket-key ) : g_strdup( key ));
+}
+
+static gboolean
+check_key( GKeyFile *key_file, NadpParser *parser, const gchar *group, const gchar *key )
+{
+	gboolean ok;
+	GError *e1, *e2;
+	gchar *s1, *s2, *base;
+	gchar **v1, **v2;
+	gboolean b1, b2;
+	gint i1, i2;
+
+	ok = TRUE;
+
+	e1 = NULL; e2 = NULL;
+	b1 = g_key_file_has_key( key_file, group, key, &e1 );
+	b2 = nadp_parser_has_key( parser, group, key, &e2 );
+	ok &= ( b1 == b2 );
+	ok &= same_error( "has_key", key, e1, e2 );
+
+	e1 = NULL; e2 = NULL;
+	s1 = g_key_file_get_string( key_file, group, key, &e1 );
+	s2 = nadp_parser_get_string( parser, group, key, &e2 );
+	ok &= same_string( "get_string", key, s1, s2 );
+	ok &= same_error( "get_string", key, e1, e2 );
+
+	e1 = NULL; e2 = NULL;
+	v1 = g_key_file_get_string_list( key_file, group, key, NULL, &e1 );
+	v2 = nadp_parser_get_string_list( parser, group, key, NULL, &e2 );
+	ok &= same_strv( "get_string_list", key, v1, v2 );
+	ok &= same_error( "get_string_list", key, e1, e2 );
+
+	e1 = NULL; e2 = NULL;
+	b1 = g_key_file_get_boolean( key_file, group, key, &e1 );
+	b2 = nadp_parser_get_boolean( parser, group, key, &e2 );
+	ok &= ( b1 == b2 );
+	ok &= same_error( "get_boolean", key, e1, e2 );
+
+	e1 = NULL; e2 = NULL;
+	i1 = g_key_file_get_integer( key_file, group, key, &e1 );
+	i2 = nadp_parser_get_integer( parser, group, key, &e2 );
+	ok &= ( i1 == i2 );
+	ok &= same_error( "get_integer", key, e1, e2 );
+
+	base = base_key( key );
+	e1 = NULL; e2 = NULL;
+	s1 = g_key_file_get_locale_string( key_file, group, base, NULL, &e1 );
+	s2 = nadp_parser_get_locale_string( parser, group, base, &e2 );
+	ok &= same_string( "get_locale_string", base, s1, s2 );
+	ok &= same_error( "get_locale_string", base, e1, e2 );
+	g_free( base );
+
+	return( ok );
+}
+
+static gboolean
+check_data( const gchar *name, const gchar *data, gsize length )
+{
+	GKeyFile *key_file;
+	NadpParser *parser;
+	GError *e1, *e2;
+	gboolean loaded, ok;
+	gchar **groups1, **groups2, **keys;
+	guint ig, ik;
+
+	e1 = NULL;
+	key_file = g_key_file_new();
+	loaded = g_key_file_load_from_data( key_file, data, length, G_KEY_FILE_NONE, &e1 );
+
+	e2 = NULL;
+	parser = nadp_parser_new( data, length, &e2 );
+
+	ok = ( loaded == ( parser != NULL ));
+	ok &= same_error( "load", name, e1, e2 );
+
+	if( ok && loaded ){
+		groups1 = g_key_file_get_groups( key_file, NULL );
+		groups2 = nadp_parser_get_groups( parser, NULL );
+		ok &= same_strv( "get_groups", name, g_strdupv( groups1 ), groups2 );
+		ok &= same_string( "get_start_group", name, g_key_file_get_start_group( key_file ), nadp_parser_get_start_group( parser ));
+
+		for( ig = 0 ; groups1[ig] ; ++ig ){
+			keys = g_key_file_get_keys( key_file, groups1[ig], NULL, NULL );
+			for( ik = 0 ; keys[ik] ; ++ik ){
+				ok &= check_key( key_file, parser, groups1[ig], keys[ik] );
+			}
+			ok &= check_key( key_file, parser, groups1[ig], "NotAKey" );
+			g_strfreev( keys );
+		}
+		ok &= check_key( key_file, parser, "Not A Group", "Name" );
+
+		g_strfreev( groups1 );
+	}
+
+	g_printf( "%s %s\n", ok ? "ok  " : "FAIL", name );
+
+	nadp_parser_free( parser );
+	g_key_file_free( key_file );
+
+	return( ok );
+}
+
+int
+main( int argc, char** argv )
+{
+	gboolean ok;
+	gint i;
+	gchar *name;
+	gchar *data;
+	gsize length;
+	GError *error;
+
+	g_printf( ".desktop parser differential test.\n\n" );
+
+	ok = TRUE;
+
+	for( i = 0 ; samples[i] ; ++i ){
+		name = g_strdup_printf( "sample #%d", i );
+		ok &= check_data( name, samples[i], strlen( samples[i] ));
+		g_free( name );
+	}
+
+	for( i = 1 ; i < argc ; ++i ){
+		error = NULL;
+		if( !g_file_get_contents( argv[i], &data, &length, &error )){
+			g_printf( "FAIL %s: %s\n", argv[i], error->message );
+			g_error_free( error );
+			ok = FALSE;
+
+		} else {
+			ok &= check_data( argv[i], data, length );
+			g_free( data );
+		}
+	}
+
+	return( ok ? EXIT_SUCCESS : EXIT_FAILURE );
+}
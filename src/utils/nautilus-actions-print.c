@@ -198,6 +198,7 @@ get_item( const gchar *id )
 
 	pivot = na_pivot_new();
 	na_pivot_set_loadable( pivot, PIVOT_LOAD_ALL );
+	na_pivot_set_read_only( pivot, TRUE );
 	na_pivot_load_items( pivot );
 
 	item = na_pivot_get_item( pivot, id );